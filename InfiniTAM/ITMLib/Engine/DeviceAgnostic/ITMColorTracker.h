@@ -5,11 +5,10 @@
 #include "../../Utils/ITMLibDefines.h"
 #include "../../Utils/ITMPixelUtils.h"
 
-_CPU_AND_GPU_CODE_ inline float getColorDifferenceSq(Vector4f *locations, Vector4f *colours, Vector4u *rgb, Vector2i imgSize, 
+_CPU_AND_GPU_CODE_ inline bool getColorDifference(Vector3f & colour_diff, Vector4f *locations, Vector4f *colours, Vector4u *rgb, Vector2i imgSize,
 	int locId_global, Vector4f projParams, Matrix4f M)
 {
 	Vector4f pt_model, pt_camera, colour_known, colour_obs;
-	Vector3f colour_diff;
 	Vector2f pt_image;
 
 	pt_model = locations[locId_global];
@@ -17,19 +16,29 @@ _CPU_AND_GPU_CODE_ inline float getColorDifferenceSq(Vector4f *locations, Vector
 
 	pt_camera = M * pt_model;
 
-	if (pt_camera.z <= 0) return -1.0f;
+	if (pt_camera.z <= 0) return false;
 
 	pt_image.x = projParams.x * pt_camera.x / pt_camera.z + projParams.z;
 	pt_image.y = projParams.y * pt_camera.y / pt_camera.z + projParams.w;
 
-	if (pt_image.x < 0 || pt_image.x > imgSize.x - 1 || pt_image.y < 0 || pt_image.y > imgSize.y - 1) return -1.0f;
+	if (pt_image.x < 0 || pt_image.x > imgSize.x - 1 || pt_image.y < 0 || pt_image.y > imgSize.y - 1) return false;
 
 	colour_obs = interpolateBilinear(rgb, pt_image, imgSize);
-	if (colour_obs.w < 254.0f) return -1.0f;
+	if (colour_obs.w < 254.0f) return false;
 
 	colour_diff.x = colour_obs.x - 255.0f * colour_known.x;
 	colour_diff.y = colour_obs.y - 255.0f * colour_known.y;
 	colour_diff.z = colour_obs.z - 255.0f * colour_known.z;
+
+	return true;
+}
+
+_CPU_AND_GPU_CODE_ inline float getColorDifferenceSq(Vector4f *locations, Vector4f *colours, Vector4u *rgb, Vector2i imgSize, 
+	int locId_global, Vector4f projParams, Matrix4f M)
+{
+	Vector3f colour_diff;
+
+	if (!getColorDifference(colour_diff, locations, colours, rgb, imgSize, locId_global, projParams, M)) return -1.0f;
 	
 	return colour_diff.x * colour_diff.x + colour_diff.y * colour_diff.y + colour_diff.z * colour_diff.z;
 }
@@ -93,3 +102,194 @@ _CPU_AND_GPU_CODE_ inline bool computePerPointGH_rt_Color(float *localGradient,
 
 	return true;
 }
+
+/** Derivatives of the observed colour of one point with respect to
+    the @p numPara pose parameters from @p startPara on, one row of
+    three colour channels per parameter. Returns false if the point
+    has no valid observation.
+*/
+_CPU_AND_GPU_CODE_ inline bool computePerPointJ_rt_Color(Vector3f *d, Vector4f *locations, Vector4u *rgb, Vector2i imgSize, int locId_global,
+	Vector4f projParams, Matrix4f M, Vector4s *gx, Vector4s *gy, int numPara, int startPara)
+{
+	Vector4f pt_model, pt_camera, colour_obs, gx_obs, gy_obs;
+	Vector3f d_pt_cam_dpi;
+	Vector2f pt_image, d_proj_dpi;
+
+	pt_model = locations[locId_global];
+
+	pt_camera = M * pt_model;
+
+	if (pt_camera.z <= 0) return false;
+
+	pt_image.x = projParams.x * pt_camera.x / pt_camera.z + projParams.z;
+	pt_image.y = projParams.y * pt_camera.y / pt_camera.z + projParams.w;
+
+	if (pt_image.x < 0 || pt_image.x > imgSize.x - 1 || pt_image.y < 0 || pt_image.y > imgSize.y - 1) return false;
+
+	colour_obs = interpolateBilinear(rgb, pt_image, imgSize);
+	if (colour_obs.w < 254.0f) return false;
+
+	gx_obs = interpolateBilinear(gx, pt_image, imgSize);
+	gy_obs = interpolateBilinear(gy, pt_image, imgSize);
+
+	for (int para = 0; para < numPara; para++)
+	{
+		switch (para + startPara)
+		{
+		case 0: d_pt_cam_dpi.x = pt_camera.w;  d_pt_cam_dpi.y = 0.0f;         d_pt_cam_dpi.z = 0.0f;         break;
+		case 1: d_pt_cam_dpi.x = 0.0f;         d_pt_cam_dpi.y = pt_camera.w;  d_pt_cam_dpi.z = 0.0f;         break;
+		case 2: d_pt_cam_dpi.x = 0.0f;         d_pt_cam_dpi.y = 0.0f;         d_pt_cam_dpi.z = pt_camera.w;  break;
+		case 3: d_pt_cam_dpi.x = 0.0f;         d_pt_cam_dpi.y = -pt_camera.z;  d_pt_cam_dpi.z = pt_camera.y;  break;
+		case 4: d_pt_cam_dpi.x = pt_camera.z;  d_pt_cam_dpi.y = 0.0f;         d_pt_cam_dpi.z = -pt_camera.x;  break;
+		default:
+		case 5: d_pt_cam_dpi.x = -pt_camera.y;  d_pt_cam_dpi.y = pt_camera.x;  d_pt_cam_dpi.z = 0.0f;         break;
+		};
+
+		d_proj_dpi.x = projParams.x * ((pt_camera.z * d_pt_cam_dpi.x - d_pt_cam_dpi.z * pt_camera.x) / (pt_camera.z * pt_camera.z));
+		d_proj_dpi.y = projParams.y * ((pt_camera.z * d_pt_cam_dpi.y - d_pt_cam_dpi.z * pt_camera.y) / (pt_camera.z * pt_camera.z));
+
+		d[para].x = d_proj_dpi.x * gx_obs.x + d_proj_dpi.y * gy_obs.x;
+		d[para].y = d_proj_dpi.x * gx_obs.y + d_proj_dpi.y * gy_obs.y;
+		d[para].z = d_proj_dpi.x * gx_obs.z + d_proj_dpi.y * gy_obs.z;
+	}
+
+	return true;
+}
+
+/** Gradient of the squared colour difference of one point from its
+    precomputed derivatives, stored as @p numPara x 3 arrays of
+    @p noMaxPoints entries each. Returns the squared colour
+    difference, or -1 if the point has no valid observation.
+*/
+_CPU_AND_GPU_CODE_ inline float computePerPointG_fixedJ_Color(float *localGradient, Vector4f *locations, Vector4f *colours, Vector4u *rgb,
+	Vector2i imgSize, int locId_global, Vector4f projParams, Matrix4f M, const float *jacobians, int noMaxPoints, int numPara)
+{
+	Vector3f colour_diff, colour_diff_d;
+
+	if (!getColorDifference(colour_diff, locations, colours, rgb, imgSize, locId_global, projParams, M)) return -1.0f;
+
+	colour_diff_d.x = 2.0f * colour_diff.x; colour_diff_d.y = 2.0f * colour_diff.y; colour_diff_d.z = 2.0f * colour_diff.z;
+
+	for (int para = 0; para < numPara; para++)
+	{
+		const float *d = jacobians + para * 3 * noMaxPoints + locId_global;
+		localGradient[para] = d[0] * colour_diff_d.x + d[noMaxPoints] * colour_diff_d.y + d[2 * noMaxPoints] * colour_diff_d.z;
+	}
+
+	return colour_diff.x * colour_diff.x + colour_diff.y * colour_diff.y + colour_diff.z * colour_diff.z;
+}
+
+/// Luminance of a colour of the point cloud, with components in [0, 1], on the scale of the intensity images.
+_CPU_AND_GPU_CODE_ inline float colourToIntensity(const Vector4f & colour)
+{
+	return (255.0f / 256.0f) * (77.0f * colour.x + 150.0f * colour.y + 29.0f * colour.z);
+}
+
+/** Derivatives of the observed intensity of a point at @p pt_camera
+    with respect to the @p numPara pose parameters from @p startPara
+    on, from the observed intensity gradient @p grad_obs.
+*/
+_CPU_AND_GPU_CODE_ inline void computeDerivatives_Intensity(float *d, const Vector4f & pt_camera, const Vector2f & grad_obs, Vector4f projParams,
+	int numPara, int startPara)
+{
+	Vector3f d_pt_cam_dpi;
+	Vector2f d_proj_dpi;
+
+	for (int para = 0; para < numPara; para++)
+	{
+		switch (para + startPara)
+		{
+		case 0: d_pt_cam_dpi.x = pt_camera.w;  d_pt_cam_dpi.y = 0.0f;         d_pt_cam_dpi.z = 0.0f;         break;
+		case 1: d_pt_cam_dpi.x = 0.0f;         d_pt_cam_dpi.y = pt_camera.w;  d_pt_cam_dpi.z = 0.0f;         break;
+		case 2: d_pt_cam_dpi.x = 0.0f;         d_pt_cam_dpi.y = 0.0f;         d_pt_cam_dpi.z = pt_camera.w;  break;
+		case 3: d_pt_cam_dpi.x = 0.0f;         d_pt_cam_dpi.y = -pt_camera.z;  d_pt_cam_dpi.z = pt_camera.y;  break;
+		case 4: d_pt_cam_dpi.x = pt_camera.z;  d_pt_cam_dpi.y = 0.0f;         d_pt_cam_dpi.z = -pt_camera.x;  break;
+		default:
+		case 5: d_pt_cam_dpi.x = -pt_camera.y;  d_pt_cam_dpi.y = pt_camera.x;  d_pt_cam_dpi.z = 0.0f;         break;
+		};
+
+		d_proj_dpi.x = projParams.x * ((pt_camera.z * d_pt_cam_dpi.x - d_pt_cam_dpi.z * pt_camera.x) / (pt_camera.z * pt_camera.z));
+		d_proj_dpi.y = projParams.y * ((pt_camera.z * d_pt_cam_dpi.y - d_pt_cam_dpi.z * pt_camera.y) / (pt_camera.z * pt_camera.z));
+
+		d[para] = d_proj_dpi.x * grad_obs.x + d_proj_dpi.y * grad_obs.y;
+	}
+}
+
+/// Projects a point into the intensity image, returns false if it is behind the camera or outside the image.
+_CPU_AND_GPU_CODE_ inline bool projectPoint_Intensity(Vector4f & pt_camera, Vector2f & pt_image, Vector4f *locations, Vector2i imgSize,
+	int locId_global, Vector4f projParams, Matrix4f M)
+{
+	pt_camera = M * locations[locId_global];
+
+	if (pt_camera.z <= 0) return false;
+
+	pt_image.x = projParams.x * pt_camera.x / pt_camera.z + projParams.z;
+	pt_image.y = projParams.y * pt_camera.y / pt_camera.z + projParams.w;
+
+	return !(pt_image.x < 0 || pt_image.x > imgSize.x - 1 || pt_image.y < 0 || pt_image.y > imgSize.y - 1);
+}
+
+/// Single channel version of getColorDifferenceSq, on the luminance of the observed image and of the point cloud.
+_CPU_AND_GPU_CODE_ inline float getIntensityDifferenceSq(Vector4f *locations, Vector4f *colours, uchar *intensity, Vector2i imgSize,
+	int locId_global, Vector4f projParams, Matrix4f M)
+{
+	Vector4f pt_camera; Vector2f pt_image;
+
+	if (!projectPoint_Intensity(pt_camera, pt_image, locations, imgSize, locId_global, projParams, M)) return -1.0f;
+
+	float intensity_diff = interpolateBilinear_single(intensity, pt_image, imgSize) - colourToIntensity(colours[locId_global]);
+
+	return intensity_diff * intensity_diff;
+}
+
+/// Single channel version of computePerPointGH_rt_Color.
+_CPU_AND_GPU_CODE_ inline bool computePerPointGH_rt_Intensity(float *localGradient, float *localHessian, Vector4f *locations, Vector4f *colours,
+	uchar *intensity, Vector2i imgSize, int locId_global, Vector4f projParams, Matrix4f M, Vector2s *gradients, int numPara, int startPara)
+{
+	Vector4f pt_camera; Vector2f pt_image;
+	float d[6];
+
+	if (!projectPoint_Intensity(pt_camera, pt_image, locations, imgSize, locId_global, projParams, M)) return false;
+
+	float intensity_diff_d = 2.0f * (interpolateBilinear_single(intensity, pt_image, imgSize) - colourToIntensity(colours[locId_global]));
+	Vector2f grad_obs = interpolateBilinear_Vector2(gradients, pt_image, imgSize);
+
+	computeDerivatives_Intensity(d, pt_camera, grad_obs, projParams, numPara, startPara);
+
+	for (int para = 0, counter = 0; para < numPara; para++)
+	{
+		localGradient[para] = d[para] * intensity_diff_d;
+		for (int col = 0; col <= para; col++) localHessian[counter++] = 2.0f * d[para] * d[col];
+	}
+
+	return true;
+}
+
+/// Single channel version of computePerPointJ_rt_Color, one derivative per parameter.
+_CPU_AND_GPU_CODE_ inline bool computePerPointJ_rt_Intensity(float *d, Vector4f *locations, Vector2i imgSize, int locId_global,
+	Vector4f projParams, Matrix4f M, Vector2s *gradients, int numPara, int startPara)
+{
+	Vector4f pt_camera; Vector2f pt_image;
+
+	if (!projectPoint_Intensity(pt_camera, pt_image, locations, imgSize, locId_global, projParams, M)) return false;
+
+	computeDerivatives_Intensity(d, pt_camera, interpolateBilinear_Vector2(gradients, pt_image, imgSize), projParams, numPara, startPara);
+
+	return true;
+}
+
+/// Single channel version of computePerPointG_fixedJ_Color, the derivatives are stored as @p numPara arrays of @p noMaxPoints entries.
+_CPU_AND_GPU_CODE_ inline float computePerPointG_fixedJ_Intensity(float *localGradient, Vector4f *locations, Vector4f *colours, uchar *intensity,
+	Vector2i imgSize, int locId_global, Vector4f projParams, Matrix4f M, const float *jacobians, int noMaxPoints, int numPara)
+{
+	Vector4f pt_camera; Vector2f pt_image;
+
+	if (!projectPoint_Intensity(pt_camera, pt_image, locations, imgSize, locId_global, projParams, M)) return -1.0f;
+
+	float intensity_diff = interpolateBilinear_single(intensity, pt_image, imgSize) - colourToIntensity(colours[locId_global]);
+	float intensity_diff_d = 2.0f * intensity_diff;
+
+	for (int para = 0; para < numPara; para++) localGradient[para] = jacobians[para * noMaxPoints + locId_global] * intensity_diff_d;
+
+	return intensity_diff * intensity_diff;
+}
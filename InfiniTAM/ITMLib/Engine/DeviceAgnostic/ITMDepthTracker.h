@@ -5,21 +5,18 @@
 #include "../../Utils/ITMLibDefines.h"
 #include "../../Utils/ITMPixelUtils.h"
 
-_CPU_AND_GPU_CODE_ inline bool computePerPointGH_Depth(float *localNabla, float *localHessian, int x, int y, float *depth, Vector2i viewImageSize, Vector4f viewIntrinsics,
-	Vector2i sceneImageSize, Vector4f sceneIntrinsics, Matrix4f approxInvPose, Matrix4f scenePose, Vector4f *pointsMap, Vector4f *normalsMap, float distThresh, 
-	bool rotationOnly, int noPara)
+/// Computes the contribution of the point @p tmp3Dpoint, back projected from the current depth image, to the ICP normal equations,
+/// for the 3 rotation parameters only or for all 6. The number of parameters is known at compile time, so that the accumulation
+/// loops can be unrolled.
+template<bool rotationOnly>
+_CPU_AND_GPU_CODE_ inline bool computePerPointGH_Depth(float *localNabla, float *localHessian, float &localF, Vector4f tmp3Dpoint,
+	Vector2i sceneImageSize, Vector4f sceneIntrinsics, Matrix4f approxInvPose, Matrix4f scenePose, Vector4f *pointsMap, Vector4f *normalsMap, float distThresh)
 {
-	float tmpD = depth[x + y * viewImageSize.x];
+	const int noPara = rotationOnly ? 3 : 6;
 
-	if (tmpD <= 1e-8f) return false; //check if valid -- != 0.0f
-
-	Vector4f tmp3Dpoint, tmp3Dpoint_reproj, curr3Dpoint, corr3Dnormal, ptDiff; Vector2f tmp2Dpoint;
+	Vector4f tmp3Dpoint_reproj, curr3Dpoint, corr3Dnormal, ptDiff; Vector2f tmp2Dpoint;
 	float A[6];
 
-	tmp3Dpoint.x = tmpD * ((float(x) - viewIntrinsics.z) / viewIntrinsics.x);
-	tmp3Dpoint.y = tmpD * ((float(y) - viewIntrinsics.w) / viewIntrinsics.y);
-	tmp3Dpoint.z = tmpD; tmp3Dpoint.w = 1.0f;
-
 	// transform to previous frame coordinates
 	tmp3Dpoint = approxInvPose * tmp3Dpoint;
 
@@ -52,6 +49,8 @@ _CPU_AND_GPU_CODE_ inline bool computePerPointGH_Depth(float *localNabla, float
 
 	float b = corr3Dnormal.x * ptDiff.x + corr3Dnormal.y * ptDiff.y + corr3Dnormal.z * ptDiff.z;
 
+	localF = b * b;
+
 	for (int r = 0, counter = 0; r < noPara; r++)
 	{
 		localNabla[r] = b * A[r];
@@ -60,3 +59,17 @@ _CPU_AND_GPU_CODE_ inline bool computePerPointGH_Depth(float *localNabla, float
 
 	return true;
 }
+
+/// Computes the contribution of pixel (x, y) to the ICP normal equations, see above. @p viewPoints are the back projected
+/// depths of the current view, with w = -1 where the depth is invalid.
+template<bool rotationOnly>
+_CPU_AND_GPU_CODE_ inline bool computePerPointGH_Depth(float *localNabla, float *localHessian, float &localF, int x, int y, Vector4f *viewPoints, Vector2i viewImageSize,
+	Vector2i sceneImageSize, Vector4f sceneIntrinsics, Matrix4f approxInvPose, Matrix4f scenePose, Vector4f *pointsMap, Vector4f *normalsMap, float distThresh)
+{
+	Vector4f tmp3Dpoint = viewPoints[x + y * viewImageSize.x];
+
+	if (tmp3Dpoint.w < 0.0f) return false;
+
+	return computePerPointGH_Depth<rotationOnly>(localNabla, localHessian, localF, tmp3Dpoint, sceneImageSize, sceneIntrinsics, approxInvPose, scenePose,
+		pointsMap, normalsMap, distThresh);
+}
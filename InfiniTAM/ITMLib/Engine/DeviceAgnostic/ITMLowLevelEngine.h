@@ -44,6 +44,16 @@ _CPU_AND_GPU_CODE_ inline void filterSubsample(Vector4u *imageData_out, int x, i
 	imageData_out[x + y * newDims.x] = pixel_out;
 }
 
+_CPU_AND_GPU_CODE_ inline void filterSubsample(uchar *imageData_out, int x, int y, Vector2i newDims, const uchar *imageData_in, Vector2i oldDims)
+{
+	int src_pos_x = x * 2, src_pos_y = y * 2;
+
+	int pixel_out = imageData_in[(src_pos_x + 0) + (src_pos_y + 0) * oldDims.x] + imageData_in[(src_pos_x + 1) + (src_pos_y + 0) * oldDims.x] +
+		imageData_in[(src_pos_x + 0) + (src_pos_y + 1) * oldDims.x] + imageData_in[(src_pos_x + 1) + (src_pos_y + 1) * oldDims.x];
+
+	imageData_out[x + y * newDims.x] = (uchar)(pixel_out / 4);
+}
+
 _CPU_AND_GPU_CODE_ inline void filterSubsampleWithHoles(float *imageData_out, int x, int y, Vector2i newDims, const float *imageData_in, Vector2i oldDims)
 {
 	int src_pos_x = x * 2, src_pos_y = y * 2;
@@ -89,6 +99,22 @@ _CPU_AND_GPU_CODE_ inline void filterSubsampleWithHoles(Vector4f *imageData_out,
 	imageData_out[x + y * newDims.x] = pixel_out;
 }
 
+_CPU_AND_GPU_CODE_ inline void filterSubsampleNormalsWithHoles(Vector4f *normals_out, int x, int y, Vector2i newDims, const Vector4f *normals_in, Vector2i oldDims)
+{
+	filterSubsampleWithHoles(normals_out, x, y, newDims, normals_in, oldDims);
+
+	Vector4f & normal = normals_out[x + y * newDims.x];
+	if (normal.w < 0) return;
+
+	float normSq = normal.x * normal.x + normal.y * normal.y + normal.z * normal.z;
+	if (normSq > 0.0f)
+	{
+		float normScale = 1.0f / sqrtf(normSq);
+		normal.x *= normScale; normal.y *= normScale; normal.z *= normScale;
+	}
+	else { normal.x = 0.0f; normal.y = 0.0f; normal.z = 0.0f; normal.w = -1.0f; }
+}
+
 _CPU_AND_GPU_CODE_ inline void gradientX(Vector4s *grad, int x, int y, const Vector4u *image, Vector2i imgSize)
 {
 	Vector4s d1, d2, d3, d_out;
@@ -140,3 +166,108 @@ _CPU_AND_GPU_CODE_ inline void gradientY(Vector4s *grad, int x, int y, const Vec
 
 	grad[x + y * imgSize.x] = d_out;
 }
+
+/// Luminance of a pixel with the integer ITU-R BT.601 weights 77, 150 and 29, which add up to 256.
+_CPU_AND_GPU_CODE_ inline void convertColourToIntensity(uchar *intensity, int x, int y, const Vector4u *rgb, Vector2i imgSize)
+{
+	int locId = x + y * imgSize.x;
+	Vector4u colour = rgb[locId];
+
+	intensity[locId] = (uchar)((77 * (int)colour.x + 150 * (int)colour.y + 29 * (int)colour.z + 128) >> 8);
+}
+
+/// Horizontal and vertical gradients of the luminance, with the same filters as gradientX and gradientY.
+_CPU_AND_GPU_CODE_ inline void gradient(Vector2s *grad, int x, int y, const uchar *image, Vector2i imgSize)
+{
+	int dx1, dx2, dx3, dy1, dy2, dy3;
+
+	dx1 = image[(x + 1) + (y - 1) * imgSize.x] - image[(x - 1) + (y - 1) * imgSize.x];
+	dx2 = image[(x + 1) + (y)* imgSize.x] - image[(x - 1) + (y)* imgSize.x];
+	dx3 = image[(x + 1) + (y + 1) * imgSize.x] - image[(x - 1) + (y + 1) * imgSize.x];
+
+	dy1 = image[(x - 1) + (y + 1) * imgSize.x] - image[(x - 1) + (y - 1) * imgSize.x];
+	dy2 = image[(x)+(y + 1) * imgSize.x] - image[(x)+(y - 1) * imgSize.x];
+	dy3 = image[(x + 1) + (y + 1) * imgSize.x] - image[(x + 1) + (y - 1) * imgSize.x];
+
+	Vector2s d_out;
+	d_out.x = (short)((dx1 + 2 * dx2 + dx3) / 8);
+	d_out.y = (short)((dy1 + 2 * dy2 + dy3) / 8);
+
+	grad[x + y * imgSize.x] = d_out;
+}
+
+/// Back projects the depth of a pixel to camera coordinates, with w = 1 if the depth is valid. Invalid
+/// depths are set to zero and give the point (0, 0, 0, -1). Returns whether the depth is valid.
+_CPU_AND_GPU_CODE_ inline bool unprojectDepthToCamera(Vector4f *points, int x, int y, float *depth, Vector2i imgSize, Vector4f intrinsics)
+{
+	int locId = x + y * imgSize.x;
+	float d = depth[locId];
+
+	Vector4f pt_camera;
+	if (d > 0.0f)
+	{
+		pt_camera.x = d * (((float)x - intrinsics.z) / intrinsics.x);
+		pt_camera.y = d * (((float)y - intrinsics.w) / intrinsics.y);
+		pt_camera.z = d; pt_camera.w = 1.0f;
+	}
+	else
+	{
+		depth[locId] = 0.0f;
+		pt_camera.x = 0.0f; pt_camera.y = 0.0f; pt_camera.z = 0.0f; pt_camera.w = -1.0f;
+	}
+
+	points[locId] = pt_camera;
+
+	return d > 0.0f;
+}
+
+/// Back projects a pixel of @p depth and transforms it to world coordinates
+/// with the camera-to-world transformation @p invM. Pixels without a valid
+/// depth are marked as missing.
+_CPU_AND_GPU_CODE_ inline void unprojectDepthToWorld(Vector4f *pointsMap, int x, int y, const float *depth, Vector2i imgSize, Vector4f intrinsics, const Matrix4f & invM)
+{
+	int locId = x + y * imgSize.x;
+	float d = depth[locId];
+
+	Vector4f pt_camera, outPoint4;
+	pt_camera.x = d * ((float)x - intrinsics.z) / intrinsics.x;
+	pt_camera.y = d * ((float)y - intrinsics.w) / intrinsics.y;
+	pt_camera.z = d; pt_camera.w = 1.0f;
+
+	outPoint4 = invM * pt_camera;
+	if (!(d > 0.0f)) { outPoint4.x = 0.0f; outPoint4.y = 0.0f; outPoint4.z = 0.0f; outPoint4.w = -1.0f; }
+
+	pointsMap[locId] = outPoint4;
+}
+
+/// Computes the normal of a pixel of the points map by central differences
+/// of its four neighbours. There are no early exits, so a loop over a row
+/// can be vectorised. The normal is invalid at the image border, if any of
+/// the neighbours is missing or if two of them are further apart than
+/// @p maxDist, i.e. across a depth discontinuity.
+_CPU_AND_GPU_CODE_ inline void computeNormalFromPointsMap(int x, int y, const Vector4f *pointsMap, Vector4f *normalsMap, const Vector2i & imgSize, float maxDist)
+{
+	int locId = x + y * imgSize.x;
+	bool inside = x > 0 && x < imgSize.x - 1 && y > 0 && y < imgSize.y - 1;
+
+	Vector4f xm1 = pointsMap[inside ? locId - 1 : locId], xp1 = pointsMap[inside ? locId + 1 : locId];
+	Vector4f ym1 = pointsMap[inside ? locId - imgSize.x : locId], yp1 = pointsMap[inside ? locId + imgSize.x : locId];
+
+	Vector3f diff_x(xp1.x - xm1.x, xp1.y - xm1.y, xp1.z - xm1.z);
+	Vector3f diff_y(yp1.x - ym1.x, yp1.y - ym1.y, yp1.z - ym1.z);
+
+	// pointing towards the camera, as the SDF gradient does
+	Vector3f outNormal = cross(diff_y, diff_x);
+	float normSq = dot(outNormal, outNormal);
+	float maxDistSq = maxDist * maxDist;
+
+	bool found = inside && pointsMap[locId].w > 0.0f && xm1.w > 0.0f && xp1.w > 0.0f && ym1.w > 0.0f && yp1.w > 0.0f &&
+		dot(diff_x, diff_x) <= maxDistSq && dot(diff_y, diff_y) <= maxDistSq && normSq > 0.0f;
+
+	float normScale = found ? 1.0f / sqrtf(normSq) : 0.0f;
+
+	Vector4f outNormal4;
+	outNormal4.x = outNormal.x * normScale; outNormal4.y = outNormal.y * normScale; outNormal4.z = outNormal.z * normScale;
+	outNormal4.w = found ? 0.0f : -1.0f;
+	normalsMap[locId] = outNormal4;
+}
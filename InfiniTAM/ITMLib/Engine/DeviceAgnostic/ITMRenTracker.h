@@ -10,31 +10,29 @@
 // sigma that controls the basin of attraction
 #define DTUNE 6.0f
 
-_CPU_AND_GPU_CODE_ inline void unprojectPtWithIntrinsic(const Vector4f &intrinsic, const Vector3f &inpt, Vector4f &outpt)
+/// Logistic energy of a point at (normalised) signed distance @p dt from the surface
+_CPU_AND_GPU_CODE_ inline float computeLogisticEnergy(float dt)
 {
-	outpt.x = intrinsic.x * inpt.x + intrinsic.z * inpt.z;
-	outpt.y = intrinsic.y * inpt.y + intrinsic.w * inpt.z;
-	outpt.z = inpt.z;
-	outpt.w = 1.0f;
+	float expdt = expf(-dt * DTUNE);
+	return 4.0f * expdt / ((expdt + 1.0f)*(expdt + 1.0f));
 }
 
 template<class TVoxel, class TIndex>
 _CPU_AND_GPU_CODE_ inline float computePerPixelEnergy(const Vector4f &inpt, const TVoxel *voxelBlocks, const typename TIndex::IndexData *index,
-	float oneOverVoxelSize, Matrix4f invM)
+	float oneOverVoxelSize, Matrix4f invM, typename TIndex::IndexCache & cache)
 {
 	Vector3f pt; bool dtIsFound;
 	pt = (invM * inpt * oneOverVoxelSize).toVector3();
-	float dt = readFromSDF_float_uninterpolated(voxelBlocks, index, pt, dtIsFound);
+	float dt = readFromSDF_float_uninterpolated(voxelBlocks, index, pt, dtIsFound, cache);
 
 	if (dt == 1.0f) return 0.0f;
 
-	float expdt = expf(-dt * DTUNE);
-	return 4.0f * expdt / ((expdt + 1.0f)*(expdt + 1.0f));
+	return computeLogisticEnergy(dt);
 }
 
 template<class TVoxel, class TIndex>
 _CPU_AND_GPU_CODE_ inline Vector3f computeDDT(const Vector3f &pt_f, const TVoxel *voxelBlocks, const typename TIndex::IndexData *index,
-	float oneOverVoxelSize, bool &ddtFound)
+	float oneOverVoxelSize, bool &ddtFound, typename TIndex::IndexCache & cache)
 {
 	Vector3f ddt;
 	
@@ -42,49 +40,51 @@ _CPU_AND_GPU_CODE_ inline Vector3f computeDDT(const Vector3f &pt_f, const TVoxel
 	
 	bool isFound; float dt1, dt2;	
 
-	dt1 = TVoxel::SDF_valueToFloat(readVoxel(voxelBlocks, index, pt + Vector3i(1, 0, 0), isFound).sdf);
+	dt1 = TVoxel::SDF_valueToFloat(readVoxel(voxelBlocks, index, pt + Vector3i(1, 0, 0), isFound, cache).sdf);
 	if (!isFound || dt1 == 1.0f) { ddtFound = false; return Vector3f(0.0f); }
-	dt2 = TVoxel::SDF_valueToFloat(readVoxel(voxelBlocks, index, pt + Vector3i(-1, 0, 0), isFound).sdf);
+	dt2 = TVoxel::SDF_valueToFloat(readVoxel(voxelBlocks, index, pt + Vector3i(-1, 0, 0), isFound, cache).sdf);
 	if (!isFound || dt2 == 1.0f) { ddtFound = false; return Vector3f(0.0f); }
 	ddt.x = (dt1 - dt2) * 0.5f;
 
-	dt1 = TVoxel::SDF_valueToFloat(readVoxel(voxelBlocks, index, pt + Vector3i(0, 1, 0), isFound).sdf);
+	dt1 = TVoxel::SDF_valueToFloat(readVoxel(voxelBlocks, index, pt + Vector3i(0, 1, 0), isFound, cache).sdf);
 	if (!isFound || dt1 == 1.0f) { ddtFound = false; return Vector3f(0.0f); }
-	dt2 = TVoxel::SDF_valueToFloat(readVoxel(voxelBlocks, index, pt + Vector3i(0, -1, 0), isFound).sdf);
+	dt2 = TVoxel::SDF_valueToFloat(readVoxel(voxelBlocks, index, pt + Vector3i(0, -1, 0), isFound, cache).sdf);
 	if (!isFound || dt2 == 1.0f) { ddtFound = false; return Vector3f(0.0f); }
 	ddt.y = (dt1 - dt2) * 0.5f;
 
-	dt1 = TVoxel::SDF_valueToFloat(readVoxel(voxelBlocks, index, pt + Vector3i(0, 0, 1), isFound).sdf);
+	dt1 = TVoxel::SDF_valueToFloat(readVoxel(voxelBlocks, index, pt + Vector3i(0, 0, 1), isFound, cache).sdf);
 	if (!isFound || dt1 == 1.0f) { ddtFound = false; return Vector3f(0.0f); }
-	dt2 = TVoxel::SDF_valueToFloat(readVoxel(voxelBlocks, index, pt + Vector3i(0, 0, -1), isFound).sdf);
+	dt2 = TVoxel::SDF_valueToFloat(readVoxel(voxelBlocks, index, pt + Vector3i(0, 0, -1), isFound, cache).sdf);
 	if (!isFound || dt2 == 1.0f) { ddtFound = false; return Vector3f(0.0f); }
 	ddt.z = (dt1 - dt2) * 0.5f;
 
 	ddtFound = true; return ddt;
 }
 
+/// Looks up the distance @p dt and its gradient @p dDt for the camera point
+/// @p inpt, which is returned in world coordinates as @p cPt. Returns false if
+/// either is not available.
 template<class TVoxel, class TIndex>
-_CPU_AND_GPU_CODE_ inline bool computePerPixelJacobian(float *jacobian, const Vector4f &inpt, const TVoxel *voxelBlocks, const typename TIndex::IndexData *index,
-	float oneOverVoxelSize, Matrix4f invM)
+_CPU_AND_GPU_CODE_ inline bool computePerPixelDT(float &dt, Vector3f &dDt, Vector3f &cPt, const Vector4f &inpt, const TVoxel *voxelBlocks,
+	const typename TIndex::IndexData *index, float oneOverVoxelSize, Matrix4f invM, typename TIndex::IndexCache & cache)
 {
-	float dt;
-
 	bool isFound;
 
-	Vector3f cPt, dDt, pt;
-
 	cPt = (invM * inpt).toVector3();
 
-	pt = cPt * oneOverVoxelSize;
+	Vector3f pt = cPt * oneOverVoxelSize;
 
-	dt = readFromSDF_float_uninterpolated(voxelBlocks, index, pt, isFound);
+	dt = readFromSDF_float_uninterpolated(voxelBlocks, index, pt, isFound, cache);
 
 	if (dt == 1.0f || !isFound) return false;
 
+	dDt = computeDDT<TVoxel, TIndex>(pt, voxelBlocks, index, oneOverVoxelSize, isFound, cache);
 
-	dDt = computeDDT<TVoxel, TIndex>(pt, voxelBlocks, index, oneOverVoxelSize, isFound);
-	if (!isFound) return false;
+	return isFound;
+}
 
+_CPU_AND_GPU_CODE_ inline void computeJacobianFromDT(float *jacobian, float dt, Vector3f dDt, const Vector3f &cPt)
+{
 	float expdt = expf(-dt * DTUNE);
 	float deto = expdt + 1;
 
@@ -97,6 +97,17 @@ _CPU_AND_GPU_CODE_ inline bool computePerPixelJacobian(float *jacobian, const Ve
 	jacobian[3] = 4.0f * (dDt.z * cPt.y - dDt.y * cPt.z);
 	jacobian[4] = 4.0f * (dDt.x * cPt.z - dDt.z * cPt.x);
 	jacobian[5] = 4.0f * (dDt.y * cPt.x - dDt.x * cPt.y);
+}
+
+template<class TVoxel, class TIndex>
+_CPU_AND_GPU_CODE_ inline bool computePerPixelJacobian(float *jacobian, const Vector4f &inpt, const TVoxel *voxelBlocks, const typename TIndex::IndexData *index,
+	float oneOverVoxelSize, Matrix4f invM, typename TIndex::IndexCache & cache)
+{
+	float dt; Vector3f dDt, cPt;
+
+	if (!computePerPixelDT<TVoxel, TIndex>(dt, dDt, cPt, inpt, voxelBlocks, index, oneOverVoxelSize, invM, cache)) return false;
+
+	computeJacobianFromDT(jacobian, dt, dDt, cPt);
 
 	return true;
 }
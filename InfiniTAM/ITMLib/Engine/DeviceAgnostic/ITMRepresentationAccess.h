@@ -147,14 +147,36 @@ _CPU_AND_GPU_CODE_ inline float readFromSDF_float_uninterpolated(const TVoxel *v
 	return TVoxel::SDF_valueToFloat(res.sdf);
 }
 
-// add read ID function
-template<class TVoxel, class TAccess>
-_CPU_AND_GPU_CODE_ inline unsigned int readID(const TVoxel *voxelData, const TAccess *voxelIndex, Vector3f point, bool &isFound)
+template<class TVoxel, class TAccess, class TCache>
+_CPU_AND_GPU_CODE_ inline float readFromSDF_float_uninterpolated(const TVoxel *voxelData, const TAccess *voxelIndex, Vector3f point, bool &isFound, TCache & cache)
 {
-	TVoxel res = readVoxel(voxelData, voxelIndex, point.toIntRound(), isFound);
-	return res.ID;
+	TVoxel res = readVoxel(voxelData, voxelIndex, point.toIntRound(), isFound, cache);
+	return TVoxel::SDF_valueToFloat(res.sdf);
 }
 
+/// Reads the object ID of the voxel nearest to @p point, using and updating
+/// the same index cache as the SDF reads. For voxel types without an ID this
+/// does not touch the volume at all.
+template<bool hasID, class TVoxel, class TIndex> struct VoxelIDReader;
+
+template<class TVoxel, class TIndex>
+struct VoxelIDReader<false,TVoxel,TIndex> {
+	template<class TCache>
+	_CPU_AND_GPU_CODE_ static unsigned int read(const TVoxel *voxelData, const TIndex *voxelIndex, const Vector3f & point, TCache & cache)
+	{ return 0; }
+};
+
+template<class TVoxel, class TIndex>
+struct VoxelIDReader<true,TVoxel,TIndex> {
+	template<class TCache>
+	_CPU_AND_GPU_CODE_ static unsigned int read(const TVoxel *voxelData, const TIndex *voxelIndex, const Vector3f & point, TCache & cache)
+	{
+		bool isFound;
+		TVoxel res = readVoxel(voxelData, voxelIndex, point.toIntRound(), isFound, cache);
+		return isFound ? res.ID : 0;
+	}
+};
+
 template<class TVoxel, class TIndex, class TCache>
 _CPU_AND_GPU_CODE_ inline float readFromSDF_float_maybe_interpolate(const TVoxel *voxelData, const TIndex *voxelIndex, Vector3f point, bool &isFound, TCache & cache)
 {
@@ -252,6 +274,47 @@ _CPU_AND_GPU_CODE_ inline float readFromSDF_float_interpolated(const TVoxel *vox
 	return TVoxel::SDF_valueToFloat(ret);
 }
 
+template<class TVoxel, class TIndex, class TCache>
+_CPU_AND_GPU_CODE_ inline float readFromSDF_float_interpolated(const TVoxel *voxelData, const TIndex *voxelIndex, Vector3f point, bool &isFound, TCache & cache)
+{
+	TVoxel resn; float ret = 0;
+	Vector3f coeff; Vector3i pos = point.toIntFloor(coeff);
+
+	resn = readVoxel(voxelData, voxelIndex, pos + Vector3i(0, 0, 0), isFound, cache);
+	if (!isFound) return TVoxel::SDF_valueToFloat(TVoxel::SDF_initialValue());
+	ret += (1.0f - coeff.x) * (1.0f - coeff.y) * (1.0f - coeff.z) * (float)resn.sdf;
+
+	resn = readVoxel(voxelData, voxelIndex, pos + Vector3i(1, 0, 0), isFound, cache);
+	if (!isFound) return TVoxel::SDF_valueToFloat(TVoxel::SDF_initialValue());
+	ret += (coeff.x) * (1.0f - coeff.y) * (1.0f - coeff.z) * (float)resn.sdf;
+
+	resn = readVoxel(voxelData, voxelIndex, pos + Vector3i(0, 1, 0), isFound, cache);
+	if (!isFound) return TVoxel::SDF_valueToFloat(TVoxel::SDF_initialValue());
+	ret += (1.0f - coeff.x) * (coeff.y) * (1.0f - coeff.z) * (float)resn.sdf;
+
+	resn = readVoxel(voxelData, voxelIndex, pos + Vector3i(1, 1, 0), isFound, cache);
+	if (!isFound) return TVoxel::SDF_valueToFloat(TVoxel::SDF_initialValue());
+	ret += (coeff.x) * (coeff.y) * (1.0f - coeff.z) * (float)resn.sdf;
+
+	resn = readVoxel(voxelData, voxelIndex, pos + Vector3i(0, 0, 1), isFound, cache);
+	if (!isFound) return TVoxel::SDF_valueToFloat(TVoxel::SDF_initialValue());
+	ret += (1.0f - coeff.x) * (1.0f - coeff.y) * coeff.z * (float)resn.sdf;
+
+	resn = readVoxel(voxelData, voxelIndex, pos + Vector3i(1, 0, 1), isFound, cache);
+	if (!isFound) return TVoxel::SDF_valueToFloat(TVoxel::SDF_initialValue());
+	ret += (coeff.x) * (1.0f - coeff.y) * coeff.z * (float)resn.sdf;
+
+	resn = readVoxel(voxelData, voxelIndex, pos + Vector3i(0, 1, 1), isFound, cache);
+	if (!isFound) return TVoxel::SDF_valueToFloat(TVoxel::SDF_initialValue());
+	ret += (1.0f - coeff.x) * (coeff.y) * coeff.z * (float)resn.sdf;
+
+	resn = readVoxel(voxelData, voxelIndex, pos + Vector3i(1, 1, 1), isFound, cache);
+	if (!isFound) return TVoxel::SDF_valueToFloat(TVoxel::SDF_initialValue());
+	ret += (coeff.x) * (coeff.y) * coeff.z * (float)resn.sdf;
+
+	return TVoxel::SDF_valueToFloat(ret);
+}
+
 template<class TVoxel, class TAccess>
 _CPU_AND_GPU_CODE_ inline Vector4f readFromSDF_color4u_interpolated(const TVoxel *voxelData, const TAccess *voxelIndex, const Vector3f & point)
 {
@@ -264,28 +264,27 @@ struct ComputeUpdatedVoxelInfo<true,TVoxel> {
 	}
 };
 
+/// @p points are the depths back projected to camera coordinates, with w = -1 where the depth is invalid
 _CPU_AND_GPU_CODE_ inline void buildHashAllocAndVisibleTypePP(uchar *entriesAllocType, uchar *entriesVisibleType, int x, int y, Vector3s *blockCoords,
-	const float *depth, Matrix4f invM_d, Vector4f projParams_d, float mu, Vector2i imgSize, float oneOverVoxelSize, ITMHashEntry *hashTable,
+	const Vector4f *points, Matrix4f invM_d, float mu, Vector2i imgSize, float oneOverVoxelSize, ITMHashEntry *hashTable,
 	float viewFrustum_min, float viewFrustum_max)
 {
 	ITMHashEntry hashEntry;
 	float depth_measure, direction_norm; unsigned int hashIdx; int noSteps, lastFreeInBucketIdx;
-	Vector3f pt_camera_f, pt_block_s, pt_block_e, pt_block, direction; Vector3s pt_block_a;
+	Vector3f pt_camera, pt_block_s, pt_block_e, pt_block, direction; Vector3s pt_block_a;
 
-	depth_measure = depth[x + y * imgSize.x];
-	if (depth_measure <= 0 || (depth_measure - mu) < 0 || (depth_measure - mu) < viewFrustum_min || (depth_measure + mu) > viewFrustum_max) return;
+	Vector4f pt_camera_in = points[x + y * imgSize.x];
+	depth_measure = pt_camera_in.z;
+	if (pt_camera_in.w < 0.0f || (depth_measure - mu) < 0 || (depth_measure - mu) < viewFrustum_min || (depth_measure + mu) > viewFrustum_max) return;
+
+	// the points on the ray through the pixel at depths depth_measure - mu and depth_measure + mu
+	pt_camera = pt_camera_in.toVector3();
 
 	//find block coords for start ray
-	pt_camera_f.z = depth_measure - mu;
-	pt_camera_f.x = pt_camera_f.z * ((float(x) - projParams_d.z) * projParams_d.x);
-	pt_camera_f.y = pt_camera_f.z * ((float(y) - projParams_d.w) * projParams_d.y);
-	pt_block_s = (invM_d * pt_camera_f) * oneOverVoxelSize;
+	pt_block_s = (invM_d * (pt_camera * ((depth_measure - mu) / depth_measure))) * oneOverVoxelSize;
 
 	//find block coords for end ray
-	pt_camera_f.z = depth_measure + mu;
-	pt_camera_f.x = pt_camera_f.z * ((float(x) - projParams_d.z) * projParams_d.x);
-	pt_camera_f.y = pt_camera_f.z * ((float(y) - projParams_d.w) * projParams_d.y);
-	pt_block_e = (invM_d * pt_camera_f) * oneOverVoxelSize;
+	pt_block_e = (invM_d * (pt_camera * ((depth_measure + mu) / depth_measure))) * oneOverVoxelSize;
 
 	direction = pt_block_e - pt_block_s;
 	direction_norm = 1.0f / sqrtf(direction.x * direction.x + direction.y * direction.y + direction.z * direction.z);
@@ -3,6 +3,7 @@
 #pragma once
 
 #include "../../Utils/ITMLibDefines.h"
+#include "ITMLowLevelEngine.h"
 #include <iostream>
 
 struct RenderingBlock {
@@ -74,6 +75,50 @@ _CPU_AND_GPU_CODE_ inline bool ProjectSingleBlock(const Vector3s & blockPos, con
 	return true;
 }
 
+/// Computes the four side planes and the near plane of the viewing frustum
+/// in world coordinates. A point p lies inside the frustum if
+/// p.x * plane.x + p.y * plane.y + p.z * plane.z + plane.w >= 0 for all planes.
+_CPU_AND_GPU_CODE_ inline void ComputeFrustumPlanes(Vector4f *planes, const Matrix4f & pose, const Vector4f & intrinsics, const Vector2i & imgSize)
+{
+	// plane normals in camera coordinates, all planes pass through the camera centre
+	Vector3f normals[5];
+	normals[0] = Vector3f(intrinsics.x, 0.0f, intrinsics.z);
+	normals[1] = Vector3f(-intrinsics.x, 0.0f, (float)imgSize.x - intrinsics.z);
+	normals[2] = Vector3f(0.0f, intrinsics.y, intrinsics.w);
+	normals[3] = Vector3f(0.0f, -intrinsics.y, (float)imgSize.y - intrinsics.w);
+	normals[4] = Vector3f(0.0f, 0.0f, 1.0f);
+
+	Vector3f axisX(pose.getColumn(0)), axisY(pose.getColumn(1)), axisZ(pose.getColumn(2)), translation(pose.getColumn(3));
+
+	for (int i = 0; i < 5; i++)
+	{
+		planes[i].x = dot(normals[i], axisX);
+		planes[i].y = dot(normals[i], axisY);
+		planes[i].z = dot(normals[i], axisZ);
+		planes[i].w = dot(normals[i], translation);
+	}
+}
+
+/// Conservative test whether a voxel block intersects the frustum given by
+/// ComputeFrustumPlanes. For each plane only the corner of the block lying
+/// furthest along the plane normal is checked.
+_CPU_AND_GPU_CODE_ inline bool IsBlockInFrustum(const Vector3s & blockPos, const Vector4f *planes, float blockSize)
+{
+	Vector3f blockMin = blockPos.toFloat() * blockSize;
+
+	for (int i = 0; i < 5; i++)
+	{
+		Vector3f pt = blockMin;
+		if (planes[i].x > 0.0f) pt.x += blockSize;
+		if (planes[i].y > 0.0f) pt.y += blockSize;
+		if (planes[i].z > 0.0f) pt.z += blockSize;
+
+		if (pt.x * planes[i].x + pt.y * planes[i].y + pt.z * planes[i].z + planes[i].w < 0.0f) return false;
+	}
+
+	return true;
+}
+
 _CPU_AND_GPU_CODE_ inline void CreateRenderingBlocks(RenderingBlock *renderingBlockList, int offset, const Vector2i & upperLeft, const Vector2i & lowerRight, const Vector2f & zRange)
 {
 	// split bounding box into 16x16 pixel rendering blocks
@@ -122,8 +167,6 @@ _CPU_AND_GPU_CODE_ inline bool castRay(Vector3f &pt_out, int x, int y, const TVo
 	enum { SEARCH_BLOCK_COARSE, SEARCH_BLOCK_FINE, SEARCH_SURFACE, BEHIND_SURFACE, WRONG_SIDE } state;
 
 	sdfValue = readFromSDF_float_uninterpolated(voxelData, voxelIndex, pt_result, hash_found);
-	// try add ID 
-	ID = readID(voxelData, voxelIndex, pt_result, hash_found);
 
 	if (!hash_found) state = SEARCH_BLOCK_COARSE;
 	else if (sdfValue <= 0.0f) state = WRONG_SIDE;
@@ -166,8 +209,6 @@ _CPU_AND_GPU_CODE_ inline bool castRay(Vector3f &pt_out, int x, int y, const TVo
 		if (totalLength > totalLengthMax) break;
 
 		sdfValue = readFromSDF_float_maybe_interpolate(voxelData, voxelIndex, pt_result, hash_found, cache);
-		// try add ID 
-		ID = readID(voxelData, voxelIndex, pt_result, hash_found);
 
 		if (sdfValue <= 0.0f) if (state == SEARCH_BLOCK_FINE) state = WRONG_SIDE; else state = BEHIND_SURFACE;
 		else if (state == WRONG_SIDE) state = SEARCH_SURFACE;
@@ -179,15 +220,17 @@ _CPU_AND_GPU_CODE_ inline bool castRay(Vector3f &pt_out, int x, int y, const TVo
 
 		pt_result += stepLength * rayDirection;
 
-		sdfValue = readFromSDF_float_interpolated(voxelData, voxelIndex, pt_result, hash_found);
-		// try add ID 
-		ID = readID(voxelData, voxelIndex, pt_result, hash_found);
+		sdfValue = readFromSDF_float_interpolated(voxelData, voxelIndex, pt_result, hash_found, cache);
 
 		stepLength = sdfValue * stepScale;
 
 		pt_result += stepLength * rayDirection;
 		pt_found = true;
+
+		// the object ID is only needed at the surface, the cache usually already holds its block
+		ID = VoxelIDReader<TVoxel::hasIDInformation,TVoxel,typename TIndex::IndexData>::read(voxelData, voxelIndex, pt_result, cache);
 	}
+	else ID = 0;
 
 	pt_out = pt_result;
 	return pt_found;
@@ -332,6 +375,140 @@ class RaycastRenderer_ICPMaps {
 	}
 };
 
+/// Projects a point of the previous ICP maps into the image seen from pose
+/// @p M. Returns the index of the pixel it falls on and its depth, or -1 if
+/// it is not in the image.
+_CPU_AND_GPU_CODE_ inline int forwardProjectPoint(float & depth, const Vector4f & point, const Matrix4f & M, const Vector4f & projParams, const Vector2i & imgSize)
+{
+	Vector4f pt_camera = M * point;
+	if (pt_camera.z <= 0.0f) return -1;
+
+	int x = (int)floorf(projParams.x * pt_camera.x / pt_camera.z + projParams.z + 0.5f);
+	int y = (int)floorf(projParams.y * pt_camera.y / pt_camera.z + projParams.w + 0.5f);
+	if (x < 0 || x > imgSize.x - 1 || y < 0 || y > imgSize.y - 1) return -1;
+
+	depth = pt_camera.z;
+	return x + y * imgSize.x;
+}
+
+/// A forward projected pixel has to be raycast again if no point was projected
+/// onto it, or if its point lies clearly behind one of its neighbours, i.e. the
+/// background is seen through a gap in the projected foreground surface.
+_CPU_AND_GPU_CODE_ inline bool forwardProjectionMissing(int x, int y, const Vector4f *pointsMap, const float *depthMap, const Vector2i & imgSize, float depthTolerance)
+{
+	int locId = x + y * imgSize.x;
+	if (pointsMap[locId].w <= 0.0f) return true;
+
+	float depth = depthMap[locId] - depthTolerance;
+	if (x > 0 && depthMap[locId - 1] < depth) return true;
+	if (x < imgSize.x - 1 && depthMap[locId + 1] < depth) return true;
+	if (y > 0 && depthMap[locId - imgSize.x] < depth) return true;
+	if (y < imgSize.y - 1 && depthMap[locId + imgSize.x] < depth) return true;
+
+	return false;
+}
+
+/// Shades a pixel of the ICP maps whose point and normal are already known,
+/// e.g. from forward projection, and invalidates it if the surface faces away
+/// from the camera or has no valid normal.
+template<class TVoxel, class TIndex>
+_CPU_AND_GPU_CODE_ inline void shadeForwardProjectedPixel(int locId, Vector4f *pointsMap, Vector4f *normalsMap, Vector4u *outRendering,
+	const TVoxel *voxelData, const typename TIndex::IndexData *voxelIndex, float oneOverVoxelSize, const Vector3f & lightSource)
+{
+	Vector4f normal = normalsMap[locId];
+	float angle = normal.x * lightSource.x + normal.y * lightSource.y + normal.z * lightSource.z;
+	bool foundPoint = angle > 0.0f;
+	unsigned int ID = 0;
+
+	if (foundPoint)
+	{
+		typename TIndex::IndexCache cache;
+		ID = VoxelIDReader<TVoxel::hasIDInformation,TVoxel,typename TIndex::IndexData>::read(voxelData, voxelIndex, pointsMap[locId].toVector3() * oneOverVoxelSize, cache);
+	}
+	else
+	{
+		Vector4f out4;
+		out4.x = 0.0f; out4.y = 0.0f; out4.z = 0.0f; out4.w = -1.0f;
+
+		pointsMap[locId] = out4;
+		normalsMap[locId] = out4;
+	}
+
+	drawRendering(foundPoint, angle, outRendering[locId], ID);
+}
+
+/// Fills a pixel of the ICP maps that lies between the samples of a grid
+/// with spacing @p subsample by bilinear interpolation of the surrounding
+/// samples, or marks it as missing if none of them hit a surface. Returns
+/// false if only some samples are missing or the samples do not lie on one
+/// smooth surface, i.e. more than @p maxPlaneDist off the tangent plane of
+/// the first sample or with normals deviating more than given by
+/// @p minNormalDot. The pixel then has to be raycast.
+_CPU_AND_GPU_CODE_ inline bool interpolateICPMapsPixel(int x, int y, Vector4f *pointsMap, Vector4f *normalsMap, const Vector2i & imgSize, int subsample,
+	float maxPlaneDist, float minNormalDot)
+{
+	int x0 = x - x % subsample, y0 = y - y % subsample;
+	int x1 = x0 == x ? x0 : x0 + subsample, y1 = y0 == y ? y0 : y0 + subsample;
+	if (x1 > imgSize.x - 1 || y1 > imgSize.y - 1) return false;
+
+	int locIds[4] = { x0 + y0 * imgSize.x, x1 + y0 * imgSize.x, x0 + y1 * imgSize.x, x1 + y1 * imgSize.x };
+	float fx = (float)(x - x0) / (float)subsample, fy = (float)(y - y0) / (float)subsample;
+	float weights[4] = { (1.0f - fx) * (1.0f - fy), fx * (1.0f - fy), (1.0f - fx) * fy, fx * fy };
+
+	int locId = x + y * imgSize.x;
+
+	if (pointsMap[locIds[0]].w <= 0.0f && pointsMap[locIds[1]].w <= 0.0f && pointsMap[locIds[2]].w <= 0.0f && pointsMap[locIds[3]].w <= 0.0f)
+	{
+		Vector4f out4;
+		out4.x = 0.0f; out4.y = 0.0f; out4.z = 0.0f; out4.w = -1.0f;
+
+		pointsMap[locId] = out4;
+		normalsMap[locId] = out4;
+		return true;
+	}
+
+	Vector3f refPoint = pointsMap[locIds[0]].toVector3(), refNormal = normalsMap[locIds[0]].toVector3();
+	Vector3f outPoint(0.0f, 0.0f, 0.0f), outNormal(0.0f, 0.0f, 0.0f);
+
+	for (int i = 0; i < 4; i++)
+	{
+		Vector4f point = pointsMap[locIds[i]], normal = normalsMap[locIds[i]];
+		if (point.w <= 0.0f || normal.w < 0.0f) return false;
+
+		Vector3f diff = point.toVector3() - refPoint;
+		if (fabsf(dot(refNormal, diff)) > maxPlaneDist) return false;
+		if (dot(refNormal, normal.toVector3()) < minNormalDot) return false;
+
+		outPoint += point.toVector3() * weights[i];
+		outNormal += normal.toVector3() * weights[i];
+	}
+
+	outNormal *= 1.0f / sqrtf(dot(outNormal, outNormal));
+
+	pointsMap[locId] = Vector4f(outPoint, 1.0f);
+	normalsMap[locId] = Vector4f(outNormal, 0.0f);
+
+	return true;
+}
+
+/// Raycasts a single pixel of the points map without computing its normal.
+template<class TVoxel, class TIndex>
+_CPU_AND_GPU_CODE_ inline void genericRaycastPoint(int x, int y, Vector4f *pointsMap, const TVoxel *voxelData, const typename TIndex::IndexData *voxelIndex,
+	Vector2i imgSize, Matrix4f invM, Vector4f projParams, float voxelSize, float oneOverVoxelSize, const Vector2f *minmaxdata, float mu)
+{
+	Vector3f pt_ray;
+	unsigned int ID;
+
+	int locId = x + y * imgSize.x;
+
+	bool foundPoint = castRay<TVoxel,TIndex>(pt_ray, x, y, voxelData, voxelIndex, invM, projParams, oneOverVoxelSize, mu, minmaxdata[locId].x, minmaxdata[locId].y, ID);
+
+	Vector4f outPoint4;
+	outPoint4.x = foundPoint ? pt_ray.x * voxelSize : 0.0f; outPoint4.y = foundPoint ? pt_ray.y * voxelSize : 0.0f;
+	outPoint4.z = foundPoint ? pt_ray.z * voxelSize : 0.0f; outPoint4.w = foundPoint ? 1.0f : -1.0f;
+	pointsMap[locId] = outPoint4;
+}
+
 template<class TVoxel, class TIndex, class TRaycastRenderer>
 _CPU_AND_GPU_CODE_ inline void genericRaycastAndRender(int x, int y, TRaycastRenderer & renderer,
 	const TVoxel *voxelData, const typename TIndex::IndexData *voxelIndex, Vector2i imgSize, Matrix4f invM, Vector4f projParams,
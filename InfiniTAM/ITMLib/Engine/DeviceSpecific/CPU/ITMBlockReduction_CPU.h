@@ -0,0 +1,30 @@
+// Copyright 2014 Isis Innovation Limited and the authors of InfiniTAM
+
+#pragma once
+
+/** Deterministic reductions of the CPU trackers.
+
+    The trackers sum per point energies, gradients and Hessians over
+    whole images. Floating point addition is not associative, so these
+    sums are not split by thread. Instead the points are cut into fixed
+    blocks, such as runs of points or bands of image rows, and each block
+    gets its own slot of partial sums in a buffer that the tracker
+    allocates once. The blocks are evaluated in parallel. Their partial
+    sums are then added up serially in block order. Within a block, the
+    AVX2 paths keep eight lanes of partial sums that sumLanes_AVX2()
+    folds in a fixed order.
+
+    The results therefore depend neither on the number of threads nor on
+    their scheduling, and a run can be reproduced exactly.
+*/
+
+#ifdef __AVX2__
+#include <immintrin.h>
+
+/// Adds the eight lanes of @p src, always in the same order.
+static inline float sumLanes_AVX2(__m256 src)
+{
+	float lanes[8]; _mm256_storeu_ps(lanes, src);
+	return ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) + ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]));
+}
+#endif
@@ -3,13 +3,482 @@
 #include "ITMColorTracker_CPU.h"
 #include "../../DeviceAgnostic/ITMColorTracker.h"
 #include "../../../Utils/ITMPixelUtils.h"
+#include "ITMBlockReduction_CPU.h"
 
 using namespace ITMLib::Engine;
 
-ITMColorTracker_CPU::ITMColorTracker_CPU(Vector2i imgSize, int noHierarchyLevels, int noRotationOnlyLevels, ITMLowLevelEngine *lowLevelEngine) 
-	: ITMColorTracker(imgSize, noHierarchyLevels, noRotationOnlyLevels, lowLevelEngine, false) {  }
+// blocks of points reduced deterministically, see ITMBlockReduction_CPU.h
+static const int noPointsPerBlock = 1024, blockSumSize = 6 + 6 + 5 + 4 + 3 + 2 + 1;
 
-ITMColorTracker_CPU::~ITMColorTracker_CPU(void) { }
+ITMColorTracker_CPU::ITMColorTracker_CPU(Vector2i imgSize, int noHierarchyLevels, int noRotationOnlyLevels, ITMLowLevelEngine *lowLevelEngine,
+	bool useFixedJacobians, bool useLuminance)
+	: ITMColorTracker(imgSize, noHierarchyLevels, noRotationOnlyLevels, lowLevelEngine, useFixedJacobians, useLuminance, false)
+{
+	int noMaxBlocks = (imgSize.x * imgSize.y + noPointsPerBlock - 1) / noPointsPerBlock;
+
+	blockSums = new float[noMaxBlocks * blockSumSize];
+	blockNoValidPoints = new int[noMaxBlocks];
+
+	noMaxPoints = imgSize.x * imgSize.y;
+	jacobians = useFixedJacobians ? new float[6 * (useLuminance ? 1 : 3) * noMaxPoints] : NULL;
+}
+
+ITMColorTracker_CPU::~ITMColorTracker_CPU(void)
+{
+	delete[] blockSums;
+	delete[] blockNoValidPoints;
+	delete[] jacobians;
+}
+
+#ifdef __AVX2__
+/// Transforms the eight points starting at @p locId with @p M and projects them into the image.
+/// Returns the mask of the points in front of the camera that project inside the image.
+static inline __m256 projectPoints_AVX2(__m256 *pt_camera, __m256 &u, __m256 &v, const Vector4f *locations, int locId,
+	const Matrix4f & M, Vector4f projParams, Vector2i imgSize)
+{
+	const float *base = (const float*)(locations + locId);
+	const __m256i idx = _mm256_setr_epi32(0, 4, 8, 12, 16, 20, 24, 28);
+	const __m256 zero = _mm256_setzero_ps();
+
+	__m256 pt_model[4];
+	for (int i = 0; i < 4; i++) pt_model[i] = _mm256_i32gather_ps(base + i, idx, 4);
+
+	const float *m = M.m;
+	for (int i = 0; i < 4; i++)
+	{
+		pt_camera[i] = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(m[i]), pt_model[0]), _mm256_mul_ps(_mm256_set1_ps(m[4 + i]), pt_model[1])),
+			_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(m[8 + i]), pt_model[2]), _mm256_mul_ps(_mm256_set1_ps(m[12 + i]), pt_model[3])));
+	}
+
+	__m256 valid = _mm256_cmp_ps(pt_camera[2], zero, _CMP_GT_OQ);
+
+	u = _mm256_add_ps(_mm256_div_ps(_mm256_mul_ps(_mm256_set1_ps(projParams.x), pt_camera[0]), pt_camera[2]), _mm256_set1_ps(projParams.z));
+	v = _mm256_add_ps(_mm256_div_ps(_mm256_mul_ps(_mm256_set1_ps(projParams.y), pt_camera[1]), pt_camera[2]), _mm256_set1_ps(projParams.w));
+
+	valid = _mm256_and_ps(valid, _mm256_cmp_ps(u, zero, _CMP_GE_OQ));
+	valid = _mm256_and_ps(valid, _mm256_cmp_ps(u, _mm256_set1_ps((float)(imgSize.x - 1)), _CMP_LE_OQ));
+	valid = _mm256_and_ps(valid, _mm256_cmp_ps(v, zero, _CMP_GE_OQ));
+	valid = _mm256_and_ps(valid, _mm256_cmp_ps(v, _mm256_set1_ps((float)(imgSize.y - 1)), _CMP_LE_OQ));
+
+	// invalid points read the first pixel instead
+	u = _mm256_and_ps(u, valid); v = _mm256_and_ps(v, valid);
+
+	return valid;
+}
+
+/// Pixel indices, read masks and weights of the four neighbours for bilinear interpolation at eight
+/// positions. As in interpolateBilinear, neighbours with zero weight are not read.
+static inline void bilinearSetup_AVX2(__m256i *idx, __m256i *mask, __m256 *weight, __m256 u, __m256 v, int width)
+{
+	const __m256 zero = _mm256_setzero_ps(), one = _mm256_set1_ps(1.0f);
+
+	__m256 floorU = _mm256_floor_ps(u), floorV = _mm256_floor_ps(v);
+	__m256 deltaX = _mm256_sub_ps(u, floorU), deltaY = _mm256_sub_ps(v, floorV);
+	__m256 invDeltaX = _mm256_sub_ps(one, deltaX), invDeltaY = _mm256_sub_ps(one, deltaY);
+
+	idx[0] = _mm256_add_epi32(_mm256_cvttps_epi32(floorU), _mm256_mullo_epi32(_mm256_cvttps_epi32(floorV), _mm256_set1_epi32(width)));
+	idx[1] = _mm256_add_epi32(idx[0], _mm256_set1_epi32(1));
+	idx[2] = _mm256_add_epi32(idx[0], _mm256_set1_epi32(width));
+	idx[3] = _mm256_add_epi32(idx[2], _mm256_set1_epi32(1));
+
+	__m256i hasDeltaX = _mm256_castps_si256(_mm256_cmp_ps(deltaX, zero, _CMP_NEQ_OQ));
+	__m256i hasDeltaY = _mm256_castps_si256(_mm256_cmp_ps(deltaY, zero, _CMP_NEQ_OQ));
+	mask[0] = _mm256_set1_epi32(-1); mask[1] = hasDeltaX; mask[2] = hasDeltaY; mask[3] = _mm256_and_si256(hasDeltaX, hasDeltaY);
+
+	weight[0] = _mm256_mul_ps(invDeltaX, invDeltaY); weight[1] = _mm256_mul_ps(deltaX, invDeltaY);
+	weight[2] = _mm256_mul_ps(invDeltaX, deltaY); weight[3] = _mm256_mul_ps(deltaX, deltaY);
+}
+
+/// Gathers word @p offset of the four neighbouring pixels of an image with @p wordsPerPixel 32 bit
+/// words per pixel, masked neighbours read as zero.
+static inline void gatherNeighbours_AVX2(__m256i *words, const void *source, int wordsPerPixel, int offset, const __m256i *idx, const __m256i *mask)
+{
+	const int *base = (const int*)source + offset;
+	for (int n = 0; n < 4; n++)
+	{
+		__m256i wordIdx = _mm256_mullo_epi32(idx[n], _mm256_set1_epi32(wordsPerPixel));
+		words[n] = _mm256_mask_i32gather_epi32(_mm256_setzero_si256(), base, wordIdx, mask[n], 4);
+	}
+}
+
+static inline __m256 weightedSum_AVX2(const __m256 *value, const __m256 *weight)
+{
+	return _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(value[0], weight[0]), _mm256_mul_ps(value[1], weight[1])),
+		_mm256_add_ps(_mm256_mul_ps(value[2], weight[2]), _mm256_mul_ps(value[3], weight[3])));
+}
+
+/// Interpolates all four channels of the Vector4u image @p rgb.
+static inline void interpolateBilinear_rgb_AVX2(__m256 *result, const Vector4u *rgb, const __m256i *idx, const __m256i *mask, const __m256 *weight)
+{
+	__m256i words[4]; __m256 channel[4];
+	gatherNeighbours_AVX2(words, rgb, 1, 0, idx, mask);
+
+	for (int c = 0; c < 4; c++)
+	{
+		for (int n = 0; n < 4; n++) channel[n] = _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(words[n], 8 * c), _mm256_set1_epi32(0xff)));
+		result[c] = weightedSum_AVX2(channel, weight);
+	}
+}
+
+/// Interpolates the first three channels of the Vector4s image @p grad.
+static inline void interpolateBilinear_gradient_AVX2(__m256 *result, const Vector4s *grad, const __m256i *idx, const __m256i *mask, const __m256 *weight)
+{
+	__m256i wordsXY[4], wordsZW[4]; __m256 channel[4];
+	gatherNeighbours_AVX2(wordsXY, grad, 2, 0, idx, mask);
+	gatherNeighbours_AVX2(wordsZW, grad, 2, 1, idx, mask);
+
+	for (int n = 0; n < 4; n++) channel[n] = _mm256_cvtepi32_ps(_mm256_srai_epi32(_mm256_slli_epi32(wordsXY[n], 16), 16));
+	result[0] = weightedSum_AVX2(channel, weight);
+	for (int n = 0; n < 4; n++) channel[n] = _mm256_cvtepi32_ps(_mm256_srai_epi32(wordsXY[n], 16));
+	result[1] = weightedSum_AVX2(channel, weight);
+	for (int n = 0; n < 4; n++) channel[n] = _mm256_cvtepi32_ps(_mm256_srai_epi32(_mm256_slli_epi32(wordsZW[n], 16), 16));
+	result[2] = weightedSum_AVX2(channel, weight);
+}
+
+/// Observed minus known colour of the eight points, zero for invalid points. Also removes the points
+/// with an invalid observation from @p valid.
+static inline void colourDifference_AVX2(__m256 *colour_diff, __m256 &valid, const Vector4f *colours, int locId, const __m256 *colour_obs)
+{
+	const float *base = (const float*)(colours + locId);
+	const __m256i idx = _mm256_setr_epi32(0, 4, 8, 12, 16, 20, 24, 28);
+
+	valid = _mm256_and_ps(valid, _mm256_cmp_ps(colour_obs[3], _mm256_set1_ps(254.0f), _CMP_GE_OQ));
+
+	for (int c = 0; c < 3; c++)
+	{
+		__m256 colour_known = _mm256_i32gather_ps(base + c, idx, 4);
+		colour_diff[c] = _mm256_and_ps(_mm256_sub_ps(colour_obs[c], _mm256_mul_ps(_mm256_set1_ps(255.0f), colour_known)), valid);
+	}
+}
+
+/// Eight point version of getColorDifferenceSq for the points starting at @p locId. The squared
+/// differences of the valid points are added to the lanes of @p sumF, their number is returned.
+static inline int getColorDifferenceSq_AVX2(__m256 &sumF, const Vector4f *locations, const Vector4f *colours, const Vector4u *rgb, Vector2i imgSize,
+	int locId, Vector4f projParams, const Matrix4f & M)
+{
+	__m256 pt_camera[4], u, v;
+	__m256 valid = projectPoints_AVX2(pt_camera, u, v, locations, locId, M, projParams, imgSize);
+	if (_mm256_movemask_ps(valid) == 0) return 0;
+
+	__m256i idx[4], mask[4]; __m256 weight[4];
+	bilinearSetup_AVX2(idx, mask, weight, u, v, imgSize.x);
+
+	__m256 colour_obs[4], colour_diff[3];
+	interpolateBilinear_rgb_AVX2(colour_obs, rgb, idx, mask, weight);
+	colourDifference_AVX2(colour_diff, valid, colours, locId, colour_obs);
+
+	sumF = _mm256_add_ps(sumF, _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(colour_diff[0], colour_diff[0]), _mm256_mul_ps(colour_diff[1], colour_diff[1])),
+		_mm256_mul_ps(colour_diff[2], colour_diff[2])));
+
+	return _mm_popcnt_u32(_mm256_movemask_ps(valid));
+}
+
+/// Eight point version of computePerPointGH_rt_Color for the points starting at @p locId. The
+/// contributions of the valid points are added to the lanes of @p sumGradient and @p sumHessian.
+static inline void computePerPointGH_rt_Color_AVX2(__m256 *sumGradient, __m256 *sumHessian, const Vector4f *locations, const Vector4f *colours,
+	const Vector4u *rgb, Vector2i imgSize, int locId, Vector4f projParams, const Matrix4f & M, const Vector4s *gx, const Vector4s *gy,
+	int numPara, int startPara)
+{
+	const __m256 zero = _mm256_setzero_ps(), two = _mm256_set1_ps(2.0f);
+
+	__m256 pt_camera[4], u, v;
+	__m256 valid = projectPoints_AVX2(pt_camera, u, v, locations, locId, M, projParams, imgSize);
+	if (_mm256_movemask_ps(valid) == 0) return;
+
+	__m256i idx[4], mask[4]; __m256 weight[4];
+	bilinearSetup_AVX2(idx, mask, weight, u, v, imgSize.x);
+
+	__m256 colour_obs[4], colour_diff_d[3], gx_obs[3], gy_obs[3];
+	interpolateBilinear_rgb_AVX2(colour_obs, rgb, idx, mask, weight);
+	colourDifference_AVX2(colour_diff_d, valid, colours, locId, colour_obs);
+	if (_mm256_movemask_ps(valid) == 0) return;
+
+	interpolateBilinear_gradient_AVX2(gx_obs, gx, idx, mask, weight);
+	interpolateBilinear_gradient_AVX2(gy_obs, gy, idx, mask, weight);
+
+	for (int c = 0; c < 3; c++) colour_diff_d[c] = _mm256_mul_ps(two, colour_diff_d[c]);
+
+	// invalid points may have z == 0, clearing 1 / z^2 keeps their derivatives at zero
+	__m256 x = pt_camera[0], y = pt_camera[1], z = pt_camera[2], w = pt_camera[3];
+	__m256 negX = _mm256_sub_ps(zero, x), negY = _mm256_sub_ps(zero, y), negZ = _mm256_sub_ps(zero, z);
+	__m256 invZSq = _mm256_and_ps(_mm256_div_ps(_mm256_set1_ps(1.0f), _mm256_mul_ps(z, z)), valid);
+	__m256 fx = _mm256_set1_ps(projParams.x), fy = _mm256_set1_ps(projParams.y);
+
+	const __m256 d_pt_cam_dpi[6][3] = {
+		{ w, zero, zero }, { zero, w, zero }, { zero, zero, w },
+		{ zero, negZ, y }, { z, zero, negX }, { negY, x, zero } };
+
+	__m256 d[6][3];
+	for (int para = 0, counter = 0; para < numPara; para++)
+	{
+		const __m256 *dpi = d_pt_cam_dpi[para + startPara];
+
+		__m256 d_proj_dpi_x = _mm256_mul_ps(fx, _mm256_mul_ps(_mm256_sub_ps(_mm256_mul_ps(z, dpi[0]), _mm256_mul_ps(dpi[2], x)), invZSq));
+		__m256 d_proj_dpi_y = _mm256_mul_ps(fy, _mm256_mul_ps(_mm256_sub_ps(_mm256_mul_ps(z, dpi[1]), _mm256_mul_ps(dpi[2], y)), invZSq));
+
+		for (int c = 0; c < 3; c++) d[para][c] = _mm256_add_ps(_mm256_mul_ps(d_proj_dpi_x, gx_obs[c]), _mm256_mul_ps(d_proj_dpi_y, gy_obs[c]));
+
+		sumGradient[para] = _mm256_add_ps(sumGradient[para], _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(d[para][0], colour_diff_d[0]),
+			_mm256_mul_ps(d[para][1], colour_diff_d[1])), _mm256_mul_ps(d[para][2], colour_diff_d[2])));
+
+		for (int col = 0; col <= para; col++, counter++)
+		{
+			__m256 dot = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(d[para][0], d[col][0]), _mm256_mul_ps(d[para][1], d[col][1])), _mm256_mul_ps(d[para][2], d[col][2]));
+			sumHessian[counter] = _mm256_add_ps(sumHessian[counter], _mm256_mul_ps(two, dot));
+		}
+	}
+}
+
+/// Eight point version of computePerPointJ_rt_Color for the points starting at @p locId. The derivatives are
+/// stored in @p jacobians, zero for invalid points, and their products are added to the lanes of @p sumHessian.
+/// Returns the number of valid points.
+static inline int computePerPointJ_rt_Color_AVX2(__m256 *sumHessian, float *jacobians, int noMaxPoints, const Vector4f *locations,
+	const Vector4u *rgb, Vector2i imgSize, int locId, Vector4f projParams, const Matrix4f & M, const Vector4s *gx, const Vector4s *gy,
+	int numPara, int startPara)
+{
+	const __m256 zero = _mm256_setzero_ps(), two = _mm256_set1_ps(2.0f);
+
+	__m256 pt_camera[4], u, v;
+	__m256 valid = projectPoints_AVX2(pt_camera, u, v, locations, locId, M, projParams, imgSize);
+
+	__m256i idx[4], mask[4]; __m256 weight[4];
+	bilinearSetup_AVX2(idx, mask, weight, u, v, imgSize.x);
+
+	__m256 colour_obs[4], gx_obs[3], gy_obs[3];
+	interpolateBilinear_rgb_AVX2(colour_obs, rgb, idx, mask, weight);
+	valid = _mm256_and_ps(valid, _mm256_cmp_ps(colour_obs[3], _mm256_set1_ps(254.0f), _CMP_GE_OQ));
+
+	interpolateBilinear_gradient_AVX2(gx_obs, gx, idx, mask, weight);
+	interpolateBilinear_gradient_AVX2(gy_obs, gy, idx, mask, weight);
+
+	// as in computePerPointGH_rt_Color_AVX2, clearing 1 / z^2 of invalid points keeps their derivatives at zero
+	__m256 x = pt_camera[0], y = pt_camera[1], z = pt_camera[2], w = pt_camera[3];
+	__m256 negX = _mm256_sub_ps(zero, x), negY = _mm256_sub_ps(zero, y), negZ = _mm256_sub_ps(zero, z);
+	__m256 invZSq = _mm256_and_ps(_mm256_div_ps(_mm256_set1_ps(1.0f), _mm256_mul_ps(z, z)), valid);
+	__m256 fx = _mm256_set1_ps(projParams.x), fy = _mm256_set1_ps(projParams.y);
+
+	const __m256 d_pt_cam_dpi[6][3] = {
+		{ w, zero, zero }, { zero, w, zero }, { zero, zero, w },
+		{ zero, negZ, y }, { z, zero, negX }, { negY, x, zero } };
+
+	__m256 d[6][3];
+	for (int para = 0, counter = 0; para < numPara; para++)
+	{
+		const __m256 *dpi = d_pt_cam_dpi[para + startPara];
+
+		__m256 d_proj_dpi_x = _mm256_mul_ps(fx, _mm256_mul_ps(_mm256_sub_ps(_mm256_mul_ps(z, dpi[0]), _mm256_mul_ps(dpi[2], x)), invZSq));
+		__m256 d_proj_dpi_y = _mm256_mul_ps(fy, _mm256_mul_ps(_mm256_sub_ps(_mm256_mul_ps(z, dpi[1]), _mm256_mul_ps(dpi[2], y)), invZSq));
+
+		for (int c = 0; c < 3; c++)
+		{
+			d[para][c] = _mm256_add_ps(_mm256_mul_ps(d_proj_dpi_x, gx_obs[c]), _mm256_mul_ps(d_proj_dpi_y, gy_obs[c]));
+			_mm256_storeu_ps(jacobians + (para * 3 + c) * noMaxPoints + locId, d[para][c]);
+		}
+
+		for (int col = 0; col <= para; col++, counter++)
+		{
+			__m256 dot = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(d[para][0], d[col][0]), _mm256_mul_ps(d[para][1], d[col][1])), _mm256_mul_ps(d[para][2], d[col][2]));
+			sumHessian[counter] = _mm256_add_ps(sumHessian[counter], _mm256_mul_ps(two, dot));
+		}
+	}
+
+	return _mm_popcnt_u32(_mm256_movemask_ps(valid));
+}
+
+/// Eight point version of computePerPointG_fixedJ_Color for the points starting at @p locId. The squared differences
+/// and gradients of the valid points are added to the lanes of @p sumF and @p sumGradient, their number is returned.
+static inline int computePerPointG_fixedJ_Color_AVX2(__m256 &sumF, __m256 *sumGradient, const Vector4f *locations, const Vector4f *colours,
+	const Vector4u *rgb, Vector2i imgSize, int locId, Vector4f projParams, const Matrix4f & M, const float *jacobians, int noMaxPoints, int numPara)
+{
+	const __m256 two = _mm256_set1_ps(2.0f);
+
+	__m256 pt_camera[4], u, v;
+	__m256 valid = projectPoints_AVX2(pt_camera, u, v, locations, locId, M, projParams, imgSize);
+	if (_mm256_movemask_ps(valid) == 0) return 0;
+
+	__m256i idx[4], mask[4]; __m256 weight[4];
+	bilinearSetup_AVX2(idx, mask, weight, u, v, imgSize.x);
+
+	__m256 colour_obs[4], colour_diff[3], colour_diff_d[3];
+	interpolateBilinear_rgb_AVX2(colour_obs, rgb, idx, mask, weight);
+	colourDifference_AVX2(colour_diff, valid, colours, locId, colour_obs);
+
+	sumF = _mm256_add_ps(sumF, _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(colour_diff[0], colour_diff[0]), _mm256_mul_ps(colour_diff[1], colour_diff[1])),
+		_mm256_mul_ps(colour_diff[2], colour_diff[2])));
+
+	for (int c = 0; c < 3; c++) colour_diff_d[c] = _mm256_mul_ps(two, colour_diff[c]);
+
+	for (int para = 0; para < numPara; para++)
+	{
+		const float *d = jacobians + para * 3 * noMaxPoints + locId;
+		sumGradient[para] = _mm256_add_ps(sumGradient[para], _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(d), colour_diff_d[0]),
+			_mm256_mul_ps(_mm256_loadu_ps(d + noMaxPoints), colour_diff_d[1])), _mm256_mul_ps(_mm256_loadu_ps(d + 2 * noMaxPoints), colour_diff_d[2])));
+	}
+
+	return _mm_popcnt_u32(_mm256_movemask_ps(valid));
+}
+
+/// Interpolates the single channel image @p intensity. The bytes are gathered as the 32 bit word that ends
+/// at the pixel, or starts at it within the first three bytes, so that no read leaves the image.
+static inline __m256 interpolateBilinear_intensity_AVX2(const uchar *intensity, const __m256i *idx, const __m256i *mask, const __m256 *weight)
+{
+	__m256 channel[4];
+
+	for (int n = 0; n < 4; n++)
+	{
+		__m256i byteOffset = _mm256_min_epi32(idx[n], _mm256_set1_epi32(3));
+		__m256i word = _mm256_mask_i32gather_epi32(_mm256_setzero_si256(), (const int*)intensity, _mm256_sub_epi32(idx[n], byteOffset), mask[n], 1);
+		channel[n] = _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srlv_epi32(word, _mm256_slli_epi32(byteOffset, 3)), _mm256_set1_epi32(0xff)));
+	}
+
+	return weightedSum_AVX2(channel, weight);
+}
+
+/// Interpolates both channels of the Vector2s image @p grad.
+static inline void interpolateBilinear_gradients_AVX2(__m256 *result, const Vector2s *grad, const __m256i *idx, const __m256i *mask, const __m256 *weight)
+{
+	__m256i words[4]; __m256 channel[4];
+	gatherNeighbours_AVX2(words, grad, 1, 0, idx, mask);
+
+	for (int n = 0; n < 4; n++) channel[n] = _mm256_cvtepi32_ps(_mm256_srai_epi32(_mm256_slli_epi32(words[n], 16), 16));
+	result[0] = weightedSum_AVX2(channel, weight);
+	for (int n = 0; n < 4; n++) channel[n] = _mm256_cvtepi32_ps(_mm256_srai_epi32(words[n], 16));
+	result[1] = weightedSum_AVX2(channel, weight);
+}
+
+/// Observed minus known intensity of the eight points starting at @p locId, zero for invalid points.
+static inline __m256 intensityDifference_AVX2(__m256 valid, const Vector4f *colours, int locId, __m256 intensity_obs)
+{
+	const float *base = (const float*)(colours + locId);
+	const __m256i idx = _mm256_setr_epi32(0, 4, 8, 12, 16, 20, 24, 28);
+
+	__m256 r = _mm256_i32gather_ps(base, idx, 4), g = _mm256_i32gather_ps(base + 1, idx, 4), b = _mm256_i32gather_ps(base + 2, idx, 4);
+	__m256 intensity_known = _mm256_mul_ps(_mm256_set1_ps(255.0f / 256.0f), _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(77.0f), r),
+		_mm256_mul_ps(_mm256_set1_ps(150.0f), g)), _mm256_mul_ps(_mm256_set1_ps(29.0f), b)));
+
+	return _mm256_and_ps(_mm256_sub_ps(intensity_obs, intensity_known), valid);
+}
+
+/// Eight point version of computeDerivatives_Intensity, zero for invalid points.
+static inline void computeDerivatives_Intensity_AVX2(__m256 *d, const __m256 *pt_camera, __m256 valid, const __m256 *grad_obs, Vector4f projParams,
+	int numPara, int startPara)
+{
+	const __m256 zero = _mm256_setzero_ps();
+
+	// invalid points may have z == 0, clearing 1 / z^2 keeps their derivatives at zero
+	__m256 x = pt_camera[0], y = pt_camera[1], z = pt_camera[2], w = pt_camera[3];
+	__m256 negX = _mm256_sub_ps(zero, x), negY = _mm256_sub_ps(zero, y), negZ = _mm256_sub_ps(zero, z);
+	__m256 invZSq = _mm256_and_ps(_mm256_div_ps(_mm256_set1_ps(1.0f), _mm256_mul_ps(z, z)), valid);
+	__m256 fx = _mm256_set1_ps(projParams.x), fy = _mm256_set1_ps(projParams.y);
+
+	const __m256 d_pt_cam_dpi[6][3] = {
+		{ w, zero, zero }, { zero, w, zero }, { zero, zero, w },
+		{ zero, negZ, y }, { z, zero, negX }, { negY, x, zero } };
+
+	for (int para = 0; para < numPara; para++)
+	{
+		const __m256 *dpi = d_pt_cam_dpi[para + startPara];
+
+		__m256 d_proj_dpi_x = _mm256_mul_ps(fx, _mm256_mul_ps(_mm256_sub_ps(_mm256_mul_ps(z, dpi[0]), _mm256_mul_ps(dpi[2], x)), invZSq));
+		__m256 d_proj_dpi_y = _mm256_mul_ps(fy, _mm256_mul_ps(_mm256_sub_ps(_mm256_mul_ps(z, dpi[1]), _mm256_mul_ps(dpi[2], y)), invZSq));
+
+		d[para] = _mm256_add_ps(_mm256_mul_ps(d_proj_dpi_x, grad_obs[0]), _mm256_mul_ps(d_proj_dpi_y, grad_obs[1]));
+	}
+}
+
+/// Eight point version of getIntensityDifferenceSq, as getColorDifferenceSq_AVX2.
+static inline int getIntensityDifferenceSq_AVX2(__m256 &sumF, const Vector4f *locations, const Vector4f *colours, const uchar *intensity, Vector2i imgSize,
+	int locId, Vector4f projParams, const Matrix4f & M)
+{
+	__m256 pt_camera[4], u, v;
+	__m256 valid = projectPoints_AVX2(pt_camera, u, v, locations, locId, M, projParams, imgSize);
+	if (_mm256_movemask_ps(valid) == 0) return 0;
+
+	__m256i idx[4], mask[4]; __m256 weight[4];
+	bilinearSetup_AVX2(idx, mask, weight, u, v, imgSize.x);
+
+	__m256 intensity_diff = intensityDifference_AVX2(valid, colours, locId, interpolateBilinear_intensity_AVX2(intensity, idx, mask, weight));
+	sumF = _mm256_add_ps(sumF, _mm256_mul_ps(intensity_diff, intensity_diff));
+
+	return _mm_popcnt_u32(_mm256_movemask_ps(valid));
+}
+
+/// Eight point version of computePerPointGH_rt_Intensity, as computePerPointGH_rt_Color_AVX2.
+static inline void computePerPointGH_rt_Intensity_AVX2(__m256 *sumGradient, __m256 *sumHessian, const Vector4f *locations, const Vector4f *colours,
+	const uchar *intensity, Vector2i imgSize, int locId, Vector4f projParams, const Matrix4f & M, const Vector2s *gradients, int numPara, int startPara)
+{
+	const __m256 two = _mm256_set1_ps(2.0f);
+
+	__m256 pt_camera[4], u, v;
+	__m256 valid = projectPoints_AVX2(pt_camera, u, v, locations, locId, M, projParams, imgSize);
+	if (_mm256_movemask_ps(valid) == 0) return;
+
+	__m256i idx[4], mask[4]; __m256 weight[4];
+	bilinearSetup_AVX2(idx, mask, weight, u, v, imgSize.x);
+
+	__m256 intensity_diff = intensityDifference_AVX2(valid, colours, locId, interpolateBilinear_intensity_AVX2(intensity, idx, mask, weight));
+	__m256 intensity_diff_d = _mm256_mul_ps(two, intensity_diff);
+
+	__m256 grad_obs[2], d[6];
+	interpolateBilinear_gradients_AVX2(grad_obs, gradients, idx, mask, weight);
+	computeDerivatives_Intensity_AVX2(d, pt_camera, valid, grad_obs, projParams, numPara, startPara);
+
+	for (int para = 0, counter = 0; para < numPara; para++)
+	{
+		sumGradient[para] = _mm256_add_ps(sumGradient[para], _mm256_mul_ps(d[para], intensity_diff_d));
+		for (int col = 0; col <= para; col++, counter++)
+			sumHessian[counter] = _mm256_add_ps(sumHessian[counter], _mm256_mul_ps(_mm256_mul_ps(two, d[para]), d[col]));
+	}
+}
+
+/// Eight point version of computePerPointJ_rt_Intensity, as computePerPointJ_rt_Color_AVX2.
+static inline int computePerPointJ_rt_Intensity_AVX2(__m256 *sumHessian, float *jacobians, int noMaxPoints, const Vector4f *locations,
+	Vector2i imgSize, int locId, Vector4f projParams, const Matrix4f & M, const Vector2s *gradients, int numPara, int startPara)
+{
+	const __m256 two = _mm256_set1_ps(2.0f);
+
+	__m256 pt_camera[4], u, v;
+	__m256 valid = projectPoints_AVX2(pt_camera, u, v, locations, locId, M, projParams, imgSize);
+
+	__m256i idx[4], mask[4]; __m256 weight[4];
+	bilinearSetup_AVX2(idx, mask, weight, u, v, imgSize.x);
+
+	__m256 grad_obs[2], d[6];
+	interpolateBilinear_gradients_AVX2(grad_obs, gradients, idx, mask, weight);
+	computeDerivatives_Intensity_AVX2(d, pt_camera, valid, grad_obs, projParams, numPara, startPara);
+
+	for (int para = 0, counter = 0; para < numPara; para++)
+	{
+		_mm256_storeu_ps(jacobians + para * noMaxPoints + locId, d[para]);
+		for (int col = 0; col <= para; col++, counter++)
+			sumHessian[counter] = _mm256_add_ps(sumHessian[counter], _mm256_mul_ps(_mm256_mul_ps(two, d[para]), d[col]));
+	}
+
+	return _mm_popcnt_u32(_mm256_movemask_ps(valid));
+}
+
+/// Eight point version of computePerPointG_fixedJ_Intensity, as computePerPointG_fixedJ_Color_AVX2.
+static inline int computePerPointG_fixedJ_Intensity_AVX2(__m256 &sumF, __m256 *sumGradient, const Vector4f *locations, const Vector4f *colours,
+	const uchar *intensity, Vector2i imgSize, int locId, Vector4f projParams, const Matrix4f & M, const float *jacobians, int noMaxPoints, int numPara)
+{
+	__m256 pt_camera[4], u, v;
+	__m256 valid = projectPoints_AVX2(pt_camera, u, v, locations, locId, M, projParams, imgSize);
+	if (_mm256_movemask_ps(valid) == 0) return 0;
+
+	__m256i idx[4], mask[4]; __m256 weight[4];
+	bilinearSetup_AVX2(idx, mask, weight, u, v, imgSize.x);
+
+	__m256 intensity_diff = intensityDifference_AVX2(valid, colours, locId, interpolateBilinear_intensity_AVX2(intensity, idx, mask, weight));
+	__m256 intensity_diff_d = _mm256_mul_ps(_mm256_set1_ps(2.0f), intensity_diff);
+
+	sumF = _mm256_add_ps(sumF, _mm256_mul_ps(intensity_diff, intensity_diff));
+
+	for (int para = 0; para < numPara; para++)
+		sumGradient[para] = _mm256_add_ps(sumGradient[para], _mm256_mul_ps(_mm256_loadu_ps(jacobians + para * noMaxPoints + locId), intensity_diff_d));
+
+	return _mm_popcnt_u32(_mm256_movemask_ps(valid));
+}
+#endif
 
 void ITMColorTracker_CPU::F_oneLevel(float *f, ITMPose *pose)
 {
@@ -21,19 +490,56 @@ void ITMColorTracker_CPU::F_oneLevel(float *f, ITMPose *pose)
 
 	Matrix4f M = pose->M;
 
-	Vector2i imgSize = viewHierarchy->levels[levelId]->rgb->noDims;
+	Vector2i imgSize = useLuminance ? intensityHierarchy->levels[levelId]->intensity->noDims : viewHierarchy->levels[levelId]->rgb->noDims;
 
 	float scaleForOcclusions, final_f;
 
 	Vector4f *locations = trackingState->pointCloud->locations->GetData(false);
 	Vector4f *colours = trackingState->pointCloud->colours->GetData(false);
-	Vector4u *rgb = viewHierarchy->levels[levelId]->rgb->GetData(false);
+	Vector4u *rgb = useLuminance ? NULL : viewHierarchy->levels[levelId]->rgb->GetData(false);
+	uchar *intensity = useLuminance ? intensityHierarchy->levels[levelId]->intensity->GetData(false) : NULL;
+
+	int noBlocks = (noTotalPoints + noPointsPerBlock - 1) / noPointsPerBlock;
+
+#ifdef WITH_OPENMP
+	#pragma omp parallel for schedule(dynamic)
+#endif
+	for (int blockId = 0; blockId < noBlocks; blockId++)
+	{
+		float blockF = 0.0f; int blockValidPoints = 0;
+		int locId = blockId * noPointsPerBlock, locIdEnd = MIN(locId + noPointsPerBlock, noTotalPoints);
+
+#ifdef __AVX2__
+		__m256 sumF_AVX2 = _mm256_setzero_ps();
+		if (useLuminance)
+		{
+			for (; locId + 8 <= locIdEnd; locId += 8)
+				blockValidPoints += getIntensityDifferenceSq_AVX2(sumF_AVX2, locations, colours, intensity, imgSize, locId, projParams, M);
+		}
+		else
+		{
+			for (; locId + 8 <= locIdEnd; locId += 8)
+				blockValidPoints += getColorDifferenceSq_AVX2(sumF_AVX2, locations, colours, rgb, imgSize, locId, projParams, M);
+		}
+		blockF += sumLanes_AVX2(sumF_AVX2);
+#endif
+
+		for (; locId < locIdEnd; locId++)
+		{
+			float colorDiffSq = useLuminance ? getIntensityDifferenceSq(locations, colours, intensity, imgSize, locId, projParams, M) :
+				getColorDifferenceSq(locations, colours, rgb, imgSize, locId, projParams, M);
+			if (colorDiffSq >= 0) { blockF += colorDiffSq; blockValidPoints++; }
+		}
+
+		blockSums[blockId * blockSumSize] = blockF;
+		blockNoValidPoints[blockId] = blockValidPoints;
+	}
 
 	final_f = 0; countedPoints_valid = 0;
-	for (int locId = 0; locId < noTotalPoints; locId++)
+	for (int blockId = 0; blockId < noBlocks; blockId++)
 	{
-		float colorDiffSq = getColorDifferenceSq(locations, colours, rgb, imgSize, locId, projParams, M);
-		if (colorDiffSq >= 0) { final_f += colorDiffSq; countedPoints_valid++; }
+		final_f += blockSums[blockId * blockSumSize];
+		countedPoints_valid += blockNoValidPoints[blockId];
 	}
 
 	if (countedPoints_valid == 0) { final_f = MY_INF; scaleForOcclusions = 1.0; }
@@ -52,7 +558,7 @@ void ITMColorTracker_CPU::G_oneLevel(float *gradient, float *hessian, ITMPose *p
 
 	Matrix4f M = pose->M;
 
-	Vector2i imgSize = viewHierarchy->levels[levelId]->rgb->noDims;
+	Vector2i imgSize = useLuminance ? intensityHierarchy->levels[levelId]->intensity->noDims : viewHierarchy->levels[levelId]->rgb->noDims;
 
 	float scaleForOcclusions;
 
@@ -64,24 +570,66 @@ void ITMColorTracker_CPU::G_oneLevel(float *gradient, float *hessian, ITMPose *p
 
 	Vector4f *locations = trackingState->pointCloud->locations->GetData(false);
 	Vector4f *colours = trackingState->pointCloud->colours->GetData(false);
-	Vector4u *rgb = viewHierarchy->levels[levelId]->rgb->GetData(false);
-	Vector4s *gx = viewHierarchy->levels[levelId]->gradientX_rgb->GetData(false);
-	Vector4s *gy = viewHierarchy->levels[levelId]->gradientY_rgb->GetData(false);
+	Vector4u *rgb = useLuminance ? NULL : viewHierarchy->levels[levelId]->rgb->GetData(false);
+	uchar *intensity = useLuminance ? intensityHierarchy->levels[levelId]->intensity->GetData(false) : NULL;
+	Vector4s *gx = useLuminance ? NULL : viewHierarchy->levels[levelId]->gradientX_rgb->GetData(false);
+	Vector4s *gy = useLuminance ? NULL : viewHierarchy->levels[levelId]->gradientY_rgb->GetData(false);
+	Vector2s *gradients = useLuminance ? intensityHierarchy->levels[levelId]->gradients->GetData(false) : NULL;
+
+	int noBlocks = (noTotalPoints + noPointsPerBlock - 1) / noPointsPerBlock;
 
-	for (int locId = 0; locId < noTotalPoints; locId++)
+#ifdef WITH_OPENMP
+	#pragma omp parallel for schedule(dynamic)
+#endif
+	for (int blockId = 0; blockId < noBlocks; blockId++)
 	{
-		float localGradient[6], localHessian[21];
+		float *sumGradient = blockSums + blockId * blockSumSize, *sumHessian = sumGradient + 6;
+		for (int i = 0; i < numPara; i++) sumGradient[i] = 0.0f;
+		for (int i = 0; i < numParaSQ; i++) sumHessian[i] = 0.0f;
+
+		int locId = blockId * noPointsPerBlock, locIdEnd = MIN(locId + noPointsPerBlock, noTotalPoints);
+
+#ifdef __AVX2__
+		__m256 sumGradient_AVX2[6], sumHessian_AVX2[6 + 5 + 4 + 3 + 2 + 1];
+		for (int i = 0; i < numPara; i++) sumGradient_AVX2[i] = _mm256_setzero_ps();
+		for (int i = 0; i < numParaSQ; i++) sumHessian_AVX2[i] = _mm256_setzero_ps();
 
-		bool isValidPoint = computePerPointGH_rt_Color(localGradient, localHessian, locations, colours, rgb, imgSize, locId,
-			projParams, M, gx, gy, numPara, startPara);
+		for (; locId + 8 <= locIdEnd; locId += 8)
+		{
+			if (useLuminance) computePerPointGH_rt_Intensity_AVX2(sumGradient_AVX2, sumHessian_AVX2, locations, colours, intensity, imgSize, locId,
+				projParams, M, gradients, numPara, startPara);
+			else computePerPointGH_rt_Color_AVX2(sumGradient_AVX2, sumHessian_AVX2, locations, colours, rgb, imgSize, locId,
+				projParams, M, gx, gy, numPara, startPara);
+		}
+
+		for (int i = 0; i < numPara; i++) sumGradient[i] += sumLanes_AVX2(sumGradient_AVX2[i]);
+		for (int i = 0; i < numParaSQ; i++) sumHessian[i] += sumLanes_AVX2(sumHessian_AVX2[i]);
+#endif
 
-		if (isValidPoint)
+		for (; locId < locIdEnd; locId++)
 		{
-			for (int i = 0; i < numPara; i++) globalGradient[i] += localGradient[i];
-			for (int i = 0; i < numParaSQ; i++) globalHessian[i] += localHessian[i];
+			float localGradient[6], localHessian[21];
+
+			bool isValidPoint = useLuminance ?
+				computePerPointGH_rt_Intensity(localGradient, localHessian, locations, colours, intensity, imgSize, locId, projParams, M, gradients, numPara, startPara) :
+				computePerPointGH_rt_Color(localGradient, localHessian, locations, colours, rgb, imgSize, locId, projParams, M, gx, gy, numPara, startPara);
+
+			if (isValidPoint)
+			{
+				for (int i = 0; i < numPara; i++) sumGradient[i] += localGradient[i];
+				for (int i = 0; i < numParaSQ; i++) sumHessian[i] += localHessian[i];
+			}
 		}
 	}
 
+	for (int blockId = 0; blockId < noBlocks; blockId++)
+	{
+		const float *sumGradient = blockSums + blockId * blockSumSize, *sumHessian = sumGradient + 6;
+
+		for (int i = 0; i < numPara; i++) globalGradient[i] += sumGradient[i];
+		for (int i = 0; i < numParaSQ; i++) globalHessian[i] += sumHessian[i];
+	}
+
 	scaleForOcclusions = (float)noTotalPoints / countedPoints_valid;
 	if (countedPoints_valid == 0) { scaleForOcclusions = 1.0f; }
 
@@ -95,3 +643,211 @@ void ITMColorTracker_CPU::G_oneLevel(float *gradient, float *hessian, ITMPose *p
 		for (int col = row + 1; col < numPara; col++) hessian[row + col * numPara] = hessian[col + row * numPara];
 	}
 }
+
+void ITMColorTracker_CPU::J_oneLevel(float *hessian, ITMPose *pose)
+{
+	int noTotalPoints = trackingState->pointCloud->noTotalPoints;
+
+	Vector4f projParams = view->calib->intrinsics_rgb.projectionParamsSimple.all;
+	projParams.x /= 1 << levelId; projParams.y /= 1 << levelId;
+	projParams.z /= 1 << levelId; projParams.w /= 1 << levelId;
+
+	Matrix4f M = pose->M;
+
+	Vector2i imgSize = useLuminance ? intensityHierarchy->levels[levelId]->intensity->noDims : viewHierarchy->levels[levelId]->rgb->noDims;
+
+	float scaleForOcclusions;
+
+	int numPara = rotationOnly ? 3 : 6, startPara = rotationOnly ? 3 : 0, numParaSQ = rotationOnly ? 3 + 2 + 1 : 6 + 5 + 4 + 3 + 2 + 1;
+
+	float globalHessian[21];
+	for (int i = 0; i < numParaSQ; i++) globalHessian[i] = 0.0f;
+
+	Vector4f *locations = trackingState->pointCloud->locations->GetData(false);
+	Vector4u *rgb = useLuminance ? NULL : viewHierarchy->levels[levelId]->rgb->GetData(false);
+	Vector4s *gx = useLuminance ? NULL : viewHierarchy->levels[levelId]->gradientX_rgb->GetData(false);
+	Vector4s *gy = useLuminance ? NULL : viewHierarchy->levels[levelId]->gradientY_rgb->GetData(false);
+	Vector2s *gradients = useLuminance ? intensityHierarchy->levels[levelId]->gradients->GetData(false) : NULL;
+
+	int noBlocks = (noTotalPoints + noPointsPerBlock - 1) / noPointsPerBlock;
+
+#ifdef WITH_OPENMP
+	#pragma omp parallel for schedule(dynamic)
+#endif
+	for (int blockId = 0; blockId < noBlocks; blockId++)
+	{
+		float *sumHessian = blockSums + blockId * blockSumSize;
+		for (int i = 0; i < numParaSQ; i++) sumHessian[i] = 0.0f;
+
+		int blockValidPoints = 0;
+		int locId = blockId * noPointsPerBlock, locIdEnd = MIN(locId + noPointsPerBlock, noTotalPoints);
+
+#ifdef __AVX2__
+		__m256 sumHessian_AVX2[6 + 5 + 4 + 3 + 2 + 1];
+		for (int i = 0; i < numParaSQ; i++) sumHessian_AVX2[i] = _mm256_setzero_ps();
+
+		for (; locId + 8 <= locIdEnd; locId += 8)
+		{
+			if (useLuminance) blockValidPoints += computePerPointJ_rt_Intensity_AVX2(sumHessian_AVX2, jacobians, noMaxPoints, locations, imgSize, locId,
+				projParams, M, gradients, numPara, startPara);
+			else blockValidPoints += computePerPointJ_rt_Color_AVX2(sumHessian_AVX2, jacobians, noMaxPoints, locations, rgb, imgSize, locId,
+				projParams, M, gx, gy, numPara, startPara);
+		}
+
+		for (int i = 0; i < numParaSQ; i++) sumHessian[i] += sumLanes_AVX2(sumHessian_AVX2[i]);
+#endif
+
+		for (; locId < locIdEnd; locId++)
+		{
+			bool isValidPoint;
+
+			if (useLuminance)
+			{
+				float d[6];
+
+				isValidPoint = computePerPointJ_rt_Intensity(d, locations, imgSize, locId, projParams, M, gradients, numPara, startPara);
+
+				for (int para = 0, counter = 0; para < numPara; para++)
+				{
+					if (!isValidPoint) d[para] = 0.0f;
+
+					jacobians[para * noMaxPoints + locId] = d[para];
+
+					for (int col = 0; col <= para; col++, counter++) sumHessian[counter] += 2.0f * d[para] * d[col];
+				}
+			}
+			else
+			{
+				Vector3f d[6];
+
+				isValidPoint = computePerPointJ_rt_Color(d, locations, rgb, imgSize, locId, projParams, M, gx, gy, numPara, startPara);
+
+				for (int para = 0, counter = 0; para < numPara; para++)
+				{
+					if (!isValidPoint) d[para] = Vector3f(0.0f);
+
+					jacobians[(para * 3 + 0) * noMaxPoints + locId] = d[para].x;
+					jacobians[(para * 3 + 1) * noMaxPoints + locId] = d[para].y;
+					jacobians[(para * 3 + 2) * noMaxPoints + locId] = d[para].z;
+
+					for (int col = 0; col <= para; col++, counter++)
+						sumHessian[counter] += 2.0f * (d[para].x * d[col].x + d[para].y * d[col].y + d[para].z * d[col].z);
+				}
+			}
+
+			if (isValidPoint) blockValidPoints++;
+		}
+
+		blockNoValidPoints[blockId] = blockValidPoints;
+	}
+
+	countedPoints_valid = 0;
+	for (int blockId = 0; blockId < noBlocks; blockId++)
+	{
+		const float *sumHessian = blockSums + blockId * blockSumSize;
+
+		for (int i = 0; i < numParaSQ; i++) globalHessian[i] += sumHessian[i];
+		countedPoints_valid += blockNoValidPoints[blockId];
+	}
+
+	scaleForOcclusions = (float)noTotalPoints / countedPoints_valid;
+	if (countedPoints_valid == 0) { scaleForOcclusions = 1.0f; }
+
+	for (int para = 0, counter = 0; para < numPara; para++)
+	{
+		for (int col = 0; col <= para; col++, counter++) hessian[para + col * numPara] = globalHessian[counter] * scaleForOcclusions;
+	}
+	for (int row = 0; row < numPara; row++)
+	{
+		for (int col = row + 1; col < numPara; col++) hessian[row + col * numPara] = hessian[col + row * numPara];
+	}
+}
+
+void ITMColorTracker_CPU::FJ_oneLevel(float *f, float *gradient, ITMPose *pose)
+{
+	int noTotalPoints = trackingState->pointCloud->noTotalPoints;
+
+	Vector4f projParams = view->calib->intrinsics_rgb.projectionParamsSimple.all;
+	projParams.x /= 1 << levelId; projParams.y /= 1 << levelId;
+	projParams.z /= 1 << levelId; projParams.w /= 1 << levelId;
+
+	Matrix4f M = pose->M;
+
+	Vector2i imgSize = useLuminance ? intensityHierarchy->levels[levelId]->intensity->noDims : viewHierarchy->levels[levelId]->rgb->noDims;
+
+	float scaleForOcclusions, final_f;
+
+	int numPara = rotationOnly ? 3 : 6;
+
+	float globalGradient[6];
+	for (int i = 0; i < numPara; i++) globalGradient[i] = 0.0f;
+
+	Vector4f *locations = trackingState->pointCloud->locations->GetData(false);
+	Vector4f *colours = trackingState->pointCloud->colours->GetData(false);
+	Vector4u *rgb = useLuminance ? NULL : viewHierarchy->levels[levelId]->rgb->GetData(false);
+	uchar *intensity = useLuminance ? intensityHierarchy->levels[levelId]->intensity->GetData(false) : NULL;
+
+	int noBlocks = (noTotalPoints + noPointsPerBlock - 1) / noPointsPerBlock;
+
+#ifdef WITH_OPENMP
+	#pragma omp parallel for schedule(dynamic)
+#endif
+	for (int blockId = 0; blockId < noBlocks; blockId++)
+	{
+		float *sumF = blockSums + blockId * blockSumSize, *sumGradient = sumF + 1;
+		sumF[0] = 0.0f;
+		for (int i = 0; i < numPara; i++) sumGradient[i] = 0.0f;
+
+		int blockValidPoints = 0;
+		int locId = blockId * noPointsPerBlock, locIdEnd = MIN(locId + noPointsPerBlock, noTotalPoints);
+
+#ifdef __AVX2__
+		__m256 sumF_AVX2 = _mm256_setzero_ps(), sumGradient_AVX2[6];
+		for (int i = 0; i < numPara; i++) sumGradient_AVX2[i] = _mm256_setzero_ps();
+
+		for (; locId + 8 <= locIdEnd; locId += 8)
+		{
+			if (useLuminance) blockValidPoints += computePerPointG_fixedJ_Intensity_AVX2(sumF_AVX2, sumGradient_AVX2, locations, colours, intensity, imgSize,
+				locId, projParams, M, jacobians, noMaxPoints, numPara);
+			else blockValidPoints += computePerPointG_fixedJ_Color_AVX2(sumF_AVX2, sumGradient_AVX2, locations, colours, rgb, imgSize, locId,
+				projParams, M, jacobians, noMaxPoints, numPara);
+		}
+
+		sumF[0] += sumLanes_AVX2(sumF_AVX2);
+		for (int i = 0; i < numPara; i++) sumGradient[i] += sumLanes_AVX2(sumGradient_AVX2[i]);
+#endif
+
+		for (; locId < locIdEnd; locId++)
+		{
+			float localGradient[6];
+
+			float colorDiffSq = useLuminance ?
+				computePerPointG_fixedJ_Intensity(localGradient, locations, colours, intensity, imgSize, locId, projParams, M, jacobians, noMaxPoints, numPara) :
+				computePerPointG_fixedJ_Color(localGradient, locations, colours, rgb, imgSize, locId, projParams, M, jacobians, noMaxPoints, numPara);
+
+			if (colorDiffSq >= 0)
+			{
+				sumF[0] += colorDiffSq; blockValidPoints++;
+				for (int i = 0; i < numPara; i++) sumGradient[i] += localGradient[i];
+			}
+		}
+
+		blockNoValidPoints[blockId] = blockValidPoints;
+	}
+
+	final_f = 0; countedPoints_valid = 0;
+	for (int blockId = 0; blockId < noBlocks; blockId++)
+	{
+		const float *sumF = blockSums + blockId * blockSumSize, *sumGradient = sumF + 1;
+
+		final_f += sumF[0];
+		for (int i = 0; i < numPara; i++) globalGradient[i] += sumGradient[i];
+		countedPoints_valid += blockNoValidPoints[blockId];
+	}
+
+	if (countedPoints_valid == 0) { final_f = MY_INF; scaleForOcclusions = 1.0; }
+	else { scaleForOcclusions = (float)noTotalPoints / countedPoints_valid; }
+
+	f[0] = final_f * scaleForOcclusions;
+	for (int para = 0; para < numPara; para++) gradient[para] = globalGradient[para] * scaleForOcclusions;
+}
@@ -10,12 +10,25 @@ namespace ITMLib
 	{
 		class ITMColorTracker_CPU : public ITMColorTracker
 		{
+		private:
+			/// Partial sums and numbers of valid points of the blocks of points evaluated in parallel.
+			/// Scratch space only, so mutable: the const G_oneLevel() of the interface fills them too.
+			mutable float *blockSums;
+			mutable int *blockNoValidPoints;
+
+			/// For the fixed Jacobians variant: derivatives of the colours of the points, stored as numPara x 3
+			/// arrays of noMaxPoints entries, or numPara for the luminance, so that eight consecutive points can be loaded at once
+			float *jacobians;
+			int noMaxPoints;
+
 		public:
 			void F_oneLevel(float *f, ITMPose *pose);
 			void G_oneLevel(float *gradient, float *hessian, ITMPose *pose) const;
+			void J_oneLevel(float *hessian, ITMPose *pose);
+			void FJ_oneLevel(float *f, float *gradient, ITMPose *pose);
 
 			ITMColorTracker_CPU(Vector2i imgSize, int noHierarchyLevels, int noRotationOnlyLevels,
-				ITMLowLevelEngine *lowLevelEngine);
+				ITMLowLevelEngine *lowLevelEngine, bool useFixedJacobians, bool useLuminance);
 			~ITMColorTracker_CPU(void);
 		};
 	}
@@ -2,24 +2,324 @@
 
 #include "ITMDepthTracker_CPU.h"
 #include "../../DeviceAgnostic/ITMDepthTracker.h"
+#include "ITMBlockReduction_CPU.h"
 
 using namespace ITMLib::Engine;
 
-ITMDepthTracker_CPU::ITMDepthTracker_CPU(Vector2i imgSize, int noHierarchyLevels, int noRotationOnlyLevels, int noICPRunTillLevel, float distThresh, ITMLowLevelEngine *lowLevelEngine)
-	:ITMDepthTracker(imgSize, noHierarchyLevels, noRotationOnlyLevels, noICPRunTillLevel, distThresh, lowLevelEngine, false) { }
+// number of bins along the x and y components of the normals used by the point selection
+static const int noNormalBinsPerAxis = 8, noNormalBins = noNormalBinsPerAxis * noNormalBinsPerAxis;
 
-ITMDepthTracker_CPU::~ITMDepthTracker_CPU(void) { }
+// blocks of points reduced deterministically, see ITMBlockReduction_CPU.h
+static const int noPointsPerBlock = 4096, blockSumSize = 6 + 6 + 5 + 4 + 3 + 2 + 1 + 1;
 
-void ITMDepthTracker_CPU::ChangeIgnorePixelToZero(ITMFloatImage *image)
+ITMDepthTracker_CPU::ITMDepthTracker_CPU(Vector2i imgSize, int noHierarchyLevels, int noRotationOnlyLevels, int noICPRunTillLevel, float distThresh,
+	const int *noIterationsPerLevel, float stepThreshold, float residualThreshold, int minNoInliers, ITMLowLevelEngine *lowLevelEngine, int pointBudget)
+	:ITMDepthTracker(imgSize, noHierarchyLevels, noRotationOnlyLevels, noICPRunTillLevel, distThresh,
+		noIterationsPerLevel, stepThreshold, residualThreshold, minNoInliers, lowLevelEngine, false)
 {
-	Vector2i dims = image->noDims;
-	float *imageData = image->GetData(false);
+	this->pointBudget = pointBudget;
+	noSelectedPixels = 0;
 
-	for (int i = 0; i < dims.x * dims.y; i++) if (imageData[i] < 0.0f) imageData[i] = 0.0f;
+	int noPixels = imgSize.x * imgSize.y;
+
+	selectedPixels = new int[noPixels];
+	selectedPointsX = new float[noPixels];
+	selectedPointsY = new float[noPixels];
+	selectedPointsZ = new float[noPixels];
+	pixelBins = pointBudget > 0 ? new unsigned char[noPixels] : NULL;
+
+	int noMaxBlocks = (noPixels + noPointsPerBlock - 1) / noPointsPerBlock;
+
+	blockSums = new float[noMaxBlocks * blockSumSize];
+	blockNoValidPoints = new int[noMaxBlocks];
 }
 
-int ITMDepthTracker_CPU::ComputeGandH(ITMSceneHierarchyLevel *sceneHierarchyLevel, ITMTemplatedHierarchyLevel<ITMFloatImage> *viewHierarchyLevel,
-	Matrix4f approxInvPose, Matrix4f scenePose, bool rotationOnly)
+ITMDepthTracker_CPU::~ITMDepthTracker_CPU(void)
+{
+	delete[] selectedPixels;
+	delete[] selectedPointsX;
+	delete[] selectedPointsY;
+	delete[] selectedPointsZ;
+	if (pixelBins != NULL) delete[] pixelBins;
+	delete[] blockSums;
+	delete[] blockNoValidPoints;
+}
+
+int ITMDepthTracker_CPU::SelectPoints(const ITMDepthPyramidLevel *viewLevel)
+{
+	Vector2i imgSize = viewLevel->depth->noDims;
+	const float *depth = viewLevel->depth->GetData(false);
+	const Vector4f *points = viewLevel->points->GetData(false);
+	int noPixels = imgSize.x * imgSize.y;
+
+	// without a selection, all pixels with a valid depth are visited
+	if (pointBudget <= 0 || noPixels <= pointBudget || !SelectPixelsByNormal(depth, imgSize, viewLevel->intrinsics))
+	{
+		noSelectedPixels = 0;
+		for (int locId = 0; locId < noPixels; locId++) if (points[locId].w > 0.0f) selectedPixels[noSelectedPixels++] = locId;
+	}
+
+	// the points are back projected already, the iterations read them from compact arrays
+#ifdef WITH_OPENMP
+	#pragma omp parallel for
+#endif
+	for (int selId = 0; selId < noSelectedPixels; selId++)
+	{
+		const Vector4f &pt = points[selectedPixels[selId]];
+
+		selectedPointsX[selId] = pt.x;
+		selectedPointsY[selId] = pt.y;
+		selectedPointsZ[selId] = pt.z;
+	}
+
+	return noSelectedPixels;
+}
+
+bool ITMDepthTracker_CPU::SelectPixelsByNormal(const float *depth, Vector2i imgSize, Vector4f intrinsics)
+{
+	int noPixels = imgSize.x * imgSize.y;
+	float maxDepthDiff = 2.0f * sqrtf(distThresh);
+
+	// bin the pixels by the direction of their normal, pixels without a normal go to no bin
+#ifdef WITH_OPENMP
+	#pragma omp parallel for
+#endif
+	for (int y = 0; y < imgSize.y; y++)
+	{
+		unsigned char *rowBins = pixelBins + y * imgSize.x;
+		rowBins[0] = rowBins[imgSize.x - 1] = noNormalBins;
+
+		if (y == 0 || y == imgSize.y - 1) { memset(rowBins, noNormalBins, imgSize.x); continue; }
+
+		const float *row = depth + y * imgSize.x, *rowAbove = row - imgSize.x, *rowBelow = row + imgSize.x;
+		int x = 1;
+
+#ifdef __AVX2__
+		const __m256 zero = _mm256_setzero_ps(), half = _mm256_set1_ps(0.5f), signMask = _mm256_set1_ps(-0.0f), maxDiff = _mm256_set1_ps(maxDepthDiff);
+		const __m256 halfNoBins = _mm256_set1_ps(0.5f * noNormalBinsPerAxis), minNorm = _mm256_set1_ps(1e-12f);
+		const __m256 yc = _mm256_set1_ps((float)y - intrinsics.w);
+		const __m256i maxBin = _mm256_set1_epi32(noNormalBinsPerAxis - 1), noBin = _mm256_set1_epi32(noNormalBins);
+
+		for (; x + 8 <= imgSize.x - 1; x += 8)
+		{
+			__m256 z = _mm256_loadu_ps(row + x), zLeft = _mm256_loadu_ps(row + x - 1), zRight = _mm256_loadu_ps(row + x + 1);
+			__m256 zAbove = _mm256_loadu_ps(rowAbove + x), zBelow = _mm256_loadu_ps(rowBelow + x);
+			__m256 dzdx = _mm256_mul_ps(half, _mm256_sub_ps(zRight, zLeft)), dzdy = _mm256_mul_ps(half, _mm256_sub_ps(zBelow, zAbove));
+
+			__m256 isValid = _mm256_and_ps(_mm256_cmp_ps(z, zero, _CMP_GT_OQ), _mm256_cmp_ps(zLeft, zero, _CMP_GT_OQ));
+			isValid = _mm256_and_ps(isValid, _mm256_and_ps(_mm256_cmp_ps(zRight, zero, _CMP_GT_OQ), _mm256_cmp_ps(zAbove, zero, _CMP_GT_OQ)));
+			isValid = _mm256_and_ps(isValid, _mm256_cmp_ps(zBelow, zero, _CMP_GT_OQ));
+			isValid = _mm256_and_ps(isValid, _mm256_cmp_ps(_mm256_andnot_ps(signMask, dzdx), maxDiff, _CMP_LE_OQ));
+			isValid = _mm256_and_ps(isValid, _mm256_cmp_ps(_mm256_andnot_ps(signMask, dzdy), maxDiff, _CMP_LE_OQ));
+
+			__m256 xc = _mm256_add_ps(_mm256_set1_ps((float)x), _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f));
+			xc = _mm256_sub_ps(xc, _mm256_set1_ps(intrinsics.z));
+
+			__m256 nx = _mm256_mul_ps(_mm256_xor_ps(dzdx, signMask), _mm256_set1_ps(intrinsics.x));
+			__m256 ny = _mm256_mul_ps(_mm256_xor_ps(dzdy, signMask), _mm256_set1_ps(intrinsics.y));
+			__m256 nz = _mm256_add_ps(_mm256_add_ps(z, _mm256_mul_ps(xc, dzdx)), _mm256_mul_ps(yc, dzdy));
+
+			__m256 norm = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(nx, nx), _mm256_mul_ps(ny, ny)), _mm256_mul_ps(nz, nz));
+			__m256 binScale = _mm256_div_ps(halfNoBins, _mm256_sqrt_ps(_mm256_add_ps(norm, minNorm)));
+
+			__m256i binX = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(nx, binScale), halfNoBins));
+			__m256i binY = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(ny, binScale), halfNoBins));
+			binX = _mm256_max_epi32(_mm256_min_epi32(binX, maxBin), _mm256_setzero_si256());
+			binY = _mm256_max_epi32(_mm256_min_epi32(binY, maxBin), _mm256_setzero_si256());
+
+			__m256i bins = _mm256_add_epi32(binX, _mm256_mullo_epi32(binY, _mm256_set1_epi32(noNormalBinsPerAxis)));
+			bins = _mm256_blendv_epi8(noBin, bins, _mm256_castps_si256(isValid));
+
+			int laneBins[8];
+			_mm256_storeu_si256((__m256i*)laneBins, bins);
+			for (int i = 0; i < 8; i++) rowBins[x + i] = (unsigned char)laneBins[i];
+		}
+#endif
+
+		for (; x < imgSize.x - 1; x++)
+		{
+			float z = row[x], dzdx = 0.5f * (row[x + 1] - row[x - 1]), dzdy = 0.5f * (rowBelow[x] - rowAbove[x]);
+
+			// neighbours further apart than the ICP distance threshold lie across a discontinuity
+			bool isValid = z > 0.0f && row[x - 1] > 0.0f && row[x + 1] > 0.0f && rowAbove[x] > 0.0f && rowBelow[x] > 0.0f &&
+				fabsf(dzdx) <= maxDepthDiff && fabsf(dzdy) <= maxDepthDiff;
+
+			// the cross product of the derivatives of the back projected point along x and y, up to a positive factor
+			float nx = -dzdx * intrinsics.x, ny = -dzdy * intrinsics.y;
+			float nz = z + ((float)x - intrinsics.z) * dzdx + ((float)y - intrinsics.w) * dzdy;
+			float norm = nx * nx + ny * ny + nz * nz;
+			float binScale = 0.5f * noNormalBinsPerAxis / sqrtf(norm + 1e-12f);
+
+			int binX = MAX(MIN((int)(nx * binScale + 0.5f * noNormalBinsPerAxis), noNormalBinsPerAxis - 1), 0);
+			int binY = MAX(MIN((int)(ny * binScale + 0.5f * noNormalBinsPerAxis), noNormalBinsPerAxis - 1), 0);
+
+			rowBins[x] = isValid ? (unsigned char)(binX + binY * noNormalBinsPerAxis) : (unsigned char)noNormalBins;
+		}
+	}
+
+	int binSize[noNormalBins + 1], binQuota[noNormalBins + 1], binOrder[noNormalBins], binError[noNormalBins + 1];
+	memset(binSize, 0, sizeof(binSize));
+	for (int locId = 0; locId < noPixels; locId++) binSize[pixelBins[locId]]++;
+
+	if (noPixels - binSize[noNormalBins] <= pointBudget) return false;
+
+	// share the budget evenly between the bins, bins smaller than their share pass the rest on to the larger ones
+	for (int binId = 0; binId < noNormalBins; binId++) binOrder[binId] = binId;
+	for (int i = 1; i < noNormalBins; i++)
+		for (int j = i; j > 0 && binSize[binOrder[j]] < binSize[binOrder[j - 1]]; j--)
+		{ int tmp = binOrder[j]; binOrder[j] = binOrder[j - 1]; binOrder[j - 1] = tmp; }
+
+	int remainingBudget = pointBudget;
+	for (int i = 0; i < noNormalBins; i++)
+	{
+		int binId = binOrder[i];
+		binQuota[binId] = MIN(binSize[binId], remainingBudget / (noNormalBins - i));
+		remainingBudget -= binQuota[binId];
+	}
+	binQuota[noNormalBins] = 0;
+
+	// spread the picks of each bin evenly over its pixels in raster order, each pixel adds the quota of its bin
+	// to the error of the bin and is picked whenever the error reaches the size of the bin
+	memset(binError, 0, sizeof(binError));
+	binSize[noNormalBins] = 1;
+
+	noSelectedPixels = 0;
+	for (int locId = 0; locId < noPixels; locId++)
+	{
+		int binId = pixelBins[locId];
+		binError[binId] += binQuota[binId];
+		if (binError[binId] >= binSize[binId]) { binError[binId] -= binSize[binId]; selectedPixels[noSelectedPixels++] = locId; }
+	}
+
+	return true;
+}
+
+#ifdef __AVX2__
+/// Eight pixel version of interpolateBilinear_withHoles for the pixels at
+/// @p idx, reading the maps as they are (array of structures) with gathers.
+/// Returns the mask of the lanes with a hole among the required neighbours.
+static inline __m256 interpolateBilinear_withHoles_AVX2(__m256 *result, const Vector4f *source, __m256i idx, __m256 deltaX, __m256 deltaY, int width)
+{
+	const float *base = (const float*)source;
+	const __m256 zero = _mm256_setzero_ps(), one = _mm256_set1_ps(1.0f);
+
+	__m256i idxA = _mm256_slli_epi32(idx, 2);
+	__m256i idxB = _mm256_add_epi32(idxA, _mm256_set1_epi32(4));
+	__m256i idxC = _mm256_add_epi32(idxA, _mm256_set1_epi32(4 * width));
+	__m256i idxD = _mm256_add_epi32(idxC, _mm256_set1_epi32(4));
+
+	__m256 invDeltaX = _mm256_sub_ps(one, deltaX), invDeltaY = _mm256_sub_ps(one, deltaY);
+	__m256 weightA = _mm256_mul_ps(invDeltaX, invDeltaY), weightB = _mm256_mul_ps(deltaX, invDeltaY);
+	__m256 weightC = _mm256_mul_ps(invDeltaX, deltaY), weightD = _mm256_mul_ps(deltaX, deltaY);
+
+	__m256 hole = zero;
+	for (int i = 0; i < 4; i++)
+	{
+		__m256 a = _mm256_i32gather_ps(base + i, idxA, 4), b = _mm256_i32gather_ps(base + i, idxB, 4);
+		__m256 c = _mm256_i32gather_ps(base + i, idxC, 4), d = _mm256_i32gather_ps(base + i, idxD, 4);
+
+		result[i] = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(a, weightA), _mm256_mul_ps(b, weightB)),
+			_mm256_add_ps(_mm256_mul_ps(c, weightC), _mm256_mul_ps(d, weightD)));
+
+		if (i == 3)
+		{
+			// as in the scalar version, neighbours with zero weight are not checked
+			__m256 hasDeltaX = _mm256_cmp_ps(deltaX, zero, _CMP_NEQ_OQ), hasDeltaY = _mm256_cmp_ps(deltaY, zero, _CMP_NEQ_OQ);
+			hole = _mm256_cmp_ps(a, zero, _CMP_LT_OQ);
+			hole = _mm256_or_ps(hole, _mm256_and_ps(_mm256_cmp_ps(b, zero, _CMP_LT_OQ), hasDeltaX));
+			hole = _mm256_or_ps(hole, _mm256_and_ps(_mm256_cmp_ps(c, zero, _CMP_LT_OQ), hasDeltaY));
+			hole = _mm256_or_ps(hole, _mm256_and_ps(_mm256_cmp_ps(d, zero, _CMP_LT_OQ), _mm256_and_ps(hasDeltaX, hasDeltaY)));
+		}
+	}
+
+	return hole;
+}
+
+/// Eight point version of computePerPointGH_Depth for the back projected
+/// points @p px, @p py and @p pz. The contributions of the valid points are
+/// added to the lanes of @p sumNabla, @p sumHessian and @p sumF, the number
+/// of valid points is returned.
+template<bool rotationOnly>
+static inline int computePerPointGH_Depth_AVX2(__m256 *sumNabla, __m256 *sumHessian, __m256 &sumF, __m256 px, __m256 py, __m256 pz,
+	Vector2i sceneImageSize, Vector4f sceneIntrinsics, const Matrix4f & approxInvPose, const Matrix4f & scenePose, const Vector4f *pointsMap, const Vector4f *normalsMap,
+	float distThresh)
+{
+	const int noPara = rotationOnly ? 3 : 6;
+	const __m256 zero = _mm256_setzero_ps();
+
+	// transform to previous frame coordinates
+	const float *m = approxInvPose.m;
+	__m256 qx = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(m[0]), px), _mm256_mul_ps(_mm256_set1_ps(m[4]), py)),
+		_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(m[8]), pz), _mm256_set1_ps(m[12])));
+	__m256 qy = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(m[1]), px), _mm256_mul_ps(_mm256_set1_ps(m[5]), py)),
+		_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(m[9]), pz), _mm256_set1_ps(m[13])));
+	__m256 qz = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(m[2]), px), _mm256_mul_ps(_mm256_set1_ps(m[6]), py)),
+		_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(m[10]), pz), _mm256_set1_ps(m[14])));
+
+	// project into previous rendered image
+	m = scenePose.m;
+	__m256 rx = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(m[0]), qx), _mm256_mul_ps(_mm256_set1_ps(m[4]), qy)),
+		_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(m[8]), qz), _mm256_set1_ps(m[12])));
+	__m256 ry = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(m[1]), qx), _mm256_mul_ps(_mm256_set1_ps(m[5]), qy)),
+		_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(m[9]), qz), _mm256_set1_ps(m[13])));
+	__m256 rz = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(m[2]), qx), _mm256_mul_ps(_mm256_set1_ps(m[6]), qy)),
+		_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(m[10]), qz), _mm256_set1_ps(m[14])));
+	__m256 valid = _mm256_cmp_ps(rz, zero, _CMP_GT_OQ);
+
+	__m256 u = _mm256_add_ps(_mm256_div_ps(_mm256_mul_ps(_mm256_set1_ps(sceneIntrinsics.x), rx), rz), _mm256_set1_ps(sceneIntrinsics.z));
+	__m256 v = _mm256_add_ps(_mm256_div_ps(_mm256_mul_ps(_mm256_set1_ps(sceneIntrinsics.y), ry), rz), _mm256_set1_ps(sceneIntrinsics.w));
+
+	valid = _mm256_and_ps(valid, _mm256_cmp_ps(u, zero, _CMP_GE_OQ));
+	valid = _mm256_and_ps(valid, _mm256_cmp_ps(u, _mm256_set1_ps((float)(sceneImageSize.x - 2)), _CMP_LE_OQ));
+	valid = _mm256_and_ps(valid, _mm256_cmp_ps(v, zero, _CMP_GE_OQ));
+	valid = _mm256_and_ps(valid, _mm256_cmp_ps(v, _mm256_set1_ps((float)(sceneImageSize.y - 2)), _CMP_LE_OQ));
+	if (_mm256_movemask_ps(valid) == 0) return 0;
+
+	// invalid lanes read the first pixel instead
+	u = _mm256_and_ps(u, valid); v = _mm256_and_ps(v, valid);
+	__m256 floorU = _mm256_floor_ps(u), floorV = _mm256_floor_ps(v);
+	__m256 deltaX = _mm256_sub_ps(u, floorU), deltaY = _mm256_sub_ps(v, floorV);
+	__m256i idx = _mm256_add_epi32(_mm256_cvttps_epi32(floorU), _mm256_mullo_epi32(_mm256_cvttps_epi32(floorV), _mm256_set1_epi32(sceneImageSize.x)));
+
+	__m256 curr3Dpoint[4], corr3Dnormal[4];
+	__m256 hole = interpolateBilinear_withHoles_AVX2(curr3Dpoint, pointsMap, idx, deltaX, deltaY, sceneImageSize.x);
+	valid = _mm256_andnot_ps(hole, valid);
+
+	__m256 diffX = _mm256_sub_ps(curr3Dpoint[0], qx), diffY = _mm256_sub_ps(curr3Dpoint[1], qy), diffZ = _mm256_sub_ps(curr3Dpoint[2], qz);
+	__m256 dist = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(diffX, diffX), _mm256_mul_ps(diffY, diffY)), _mm256_mul_ps(diffZ, diffZ));
+	valid = _mm256_and_ps(valid, _mm256_cmp_ps(dist, _mm256_set1_ps(distThresh), _CMP_LE_OQ));
+	if (_mm256_movemask_ps(valid) == 0) return 0;
+
+	hole = interpolateBilinear_withHoles_AVX2(corr3Dnormal, normalsMap, idx, deltaX, deltaY, sceneImageSize.x);
+	valid = _mm256_andnot_ps(hole, valid);
+
+	__m256 nx = _mm256_and_ps(corr3Dnormal[0], valid), ny = _mm256_and_ps(corr3Dnormal[1], valid), nz = _mm256_and_ps(corr3Dnormal[2], valid);
+	qx = _mm256_and_ps(qx, valid); qy = _mm256_and_ps(qy, valid); qz = _mm256_and_ps(qz, valid);
+
+	__m256 A[6];
+	A[0] = _mm256_sub_ps(_mm256_mul_ps(qz, ny), _mm256_mul_ps(qy, nz));
+	A[1] = _mm256_sub_ps(_mm256_mul_ps(qx, nz), _mm256_mul_ps(qz, nx));
+	A[2] = _mm256_sub_ps(_mm256_mul_ps(qy, nx), _mm256_mul_ps(qx, ny));
+	if (!rotationOnly) { A[3] = nx; A[4] = ny; A[5] = nz; }
+
+	__m256 b = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(nx, diffX), _mm256_mul_ps(ny, diffY)), _mm256_mul_ps(nz, diffZ));
+
+	sumF = _mm256_add_ps(sumF, _mm256_mul_ps(b, b));
+
+	for (int r = 0, counter = 0; r < noPara; r++)
+	{
+		sumNabla[r] = _mm256_add_ps(sumNabla[r], _mm256_mul_ps(b, A[r]));
+		for (int c = 0; c <= r; c++, counter++) sumHessian[counter] = _mm256_add_ps(sumHessian[counter], _mm256_mul_ps(A[r], A[c]));
+	}
+
+	return _mm_popcnt_u32(_mm256_movemask_ps(valid));
+}
+#endif
+
+template<bool rotationOnly>
+static int ComputeGandH_common(float *ATA_host, float *ATb_host, float &f_host, ITMSceneHierarchyLevel *sceneHierarchyLevel,
+	Matrix4f approxInvPose, Matrix4f scenePose, float distThresh, const float *pointsX, const float *pointsY, const float *pointsZ, int noPoints,
+	float *blockSums, int *blockNoValidPoints)
 {
 	int noValidPoints;
 
@@ -28,29 +328,70 @@ int ITMDepthTracker_CPU::ComputeGandH(ITMSceneHierarchyLevel *sceneHierarchyLeve
 	Vector4f sceneIntrinsics = sceneHierarchyLevel->intrinsics;
 	Vector2i sceneImageSize = sceneHierarchyLevel->pointsMap->noDims;
 
-	float *depth = viewHierarchyLevel->depth->GetData(false);
-	Vector4f viewIntrinsics = viewHierarchyLevel->intrinsics;
-	Vector2i viewImageSize = viewHierarchyLevel->depth->noDims;
-
 	float packedATA[6 * 6];
-	int noPara = rotationOnly ? 3 : 6, noParaSQ = rotationOnly ? 3 + 2 + 1 : 6 + 5 + 4 + 3 + 2 + 1;
+	const int noPara = rotationOnly ? 3 : 6, noParaSQ = rotationOnly ? 3 + 2 + 1 : 6 + 5 + 4 + 3 + 2 + 1;
 
-	noValidPoints = 0; memset(ATA_host, 0, sizeof(float) * 6 * 6); memset(ATb_host, 0, sizeof(float) * 6);
+	noValidPoints = 0; f_host = 0.0f; memset(ATA_host, 0, sizeof(float) * 6 * 6); memset(ATb_host, 0, sizeof(float) * 6);
 	memset(packedATA, 0, sizeof(float) * noParaSQ);
 
-	for (int y = 0; y < viewImageSize.y; y++) for (int x = 0; x < viewImageSize.x; x++)
+	int noBlocks = (noPoints + noPointsPerBlock - 1) / noPointsPerBlock;
+
+#ifdef WITH_OPENMP
+	#pragma omp parallel for schedule(dynamic)
+#endif
+	for (int blockId = 0; blockId < noBlocks; blockId++)
 	{
-		float localHessian[6 + 5 + 4 + 3 + 2 + 1], localNabla[6];
+		float *sumNabla = blockSums + blockId * blockSumSize, *sumHessian = sumNabla + 6, *sumF = sumHessian + 6 + 5 + 4 + 3 + 2 + 1;
+		int blockValidPoints = 0;
+
+		memset(sumNabla, 0, sizeof(float) * blockSumSize);
+
+		int pointId = blockId * noPointsPerBlock, pointEnd = MIN(pointId + noPointsPerBlock, noPoints);
+
+#ifdef __AVX2__
+		__m256 sumNabla_AVX2[6], sumHessian_AVX2[6 + 5 + 4 + 3 + 2 + 1], sumF_AVX2 = _mm256_setzero_ps();
+		for (int i = 0; i < noPara; i++) sumNabla_AVX2[i] = _mm256_setzero_ps();
+		for (int i = 0; i < noParaSQ; i++) sumHessian_AVX2[i] = _mm256_setzero_ps();
 
-		for (int i = 0; i < noPara; i++) localNabla[i] = 0.0f;
-		for (int i = 0; i < noParaSQ; i++) localHessian[i] = 0.0f;
+		for (; pointId + 8 <= pointEnd; pointId += 8)
+		{
+			blockValidPoints += computePerPointGH_Depth_AVX2<rotationOnly>(sumNabla_AVX2, sumHessian_AVX2, sumF_AVX2,
+				_mm256_loadu_ps(pointsX + pointId), _mm256_loadu_ps(pointsY + pointId), _mm256_loadu_ps(pointsZ + pointId),
+				sceneImageSize, sceneIntrinsics, approxInvPose, scenePose, pointsMap, normalsMap, distThresh);
+		}
+#endif
 
-		bool isValidPoint = computePerPointGH_Depth(localNabla, localHessian, x, y, depth, viewImageSize, viewIntrinsics, sceneImageSize, sceneIntrinsics,
-			approxInvPose, scenePose, pointsMap, normalsMap, distThresh, rotationOnly, noPara);
+		for (; pointId < pointEnd; pointId++)
+		{
+			float localHessian[6 + 5 + 4 + 3 + 2 + 1], localNabla[6], localF;
 
-		noValidPoints += (int)isValidPoint;
-		for (int i = 0; i < noPara; i++) ATb_host[i] += localNabla[i];
-		for (int i = 0; i < noParaSQ; i++) packedATA[i] += localHessian[i];
+			bool isValidPoint = computePerPointGH_Depth<rotationOnly>(localNabla, localHessian, localF, Vector4f(pointsX[pointId], pointsY[pointId], pointsZ[pointId], 1.0f),
+				sceneImageSize, sceneIntrinsics, approxInvPose, scenePose, pointsMap, normalsMap, distThresh);
+
+			if (!isValidPoint) continue;
+
+			blockValidPoints++;
+			for (int i = 0; i < noPara; i++) sumNabla[i] += localNabla[i];
+			for (int i = 0; i < noParaSQ; i++) sumHessian[i] += localHessian[i];
+			sumF[0] += localF;
+		}
+
+#ifdef __AVX2__
+		for (int i = 0; i < noPara; i++) sumNabla[i] += sumLanes_AVX2(sumNabla_AVX2[i]);
+		for (int i = 0; i < noParaSQ; i++) sumHessian[i] += sumLanes_AVX2(sumHessian_AVX2[i]);
+		sumF[0] += sumLanes_AVX2(sumF_AVX2);
+#endif
+
+		blockNoValidPoints[blockId] = blockValidPoints;
+	}
+
+	for (int blockId = 0; blockId < noBlocks; blockId++)
+	{
+		const float *sumNabla = blockSums + blockId * blockSumSize, *sumHessian = sumNabla + 6, *sumF = sumHessian + 6 + 5 + 4 + 3 + 2 + 1;
+
+		noValidPoints += blockNoValidPoints[blockId]; f_host += sumF[0];
+		for (int i = 0; i < noPara; i++) ATb_host[i] += sumNabla[i];
+		for (int i = 0; i < noParaSQ; i++) packedATA[i] += sumHessian[i];
 	}
 
 	for (int r = 0, counter = 0; r < noPara; r++) for (int c = 0; c <= r; c++, counter++) ATA_host[r + c * 6] = packedATA[counter];
@@ -58,3 +399,12 @@ int ITMDepthTracker_CPU::ComputeGandH(ITMSceneHierarchyLevel *sceneHierarchyLeve
 
 	return noValidPoints;
 }
+
+int ITMDepthTracker_CPU::ComputeGandH(ITMSceneHierarchyLevel *sceneHierarchyLevel, const ITMDepthPyramidLevel *viewLevel,
+	Matrix4f approxInvPose, Matrix4f scenePose, bool rotationOnly)
+{
+	if (rotationOnly) return ComputeGandH_common<true>(ATA_host, ATb_host, f_host, sceneHierarchyLevel, approxInvPose, scenePose, distThresh,
+		selectedPointsX, selectedPointsY, selectedPointsZ, noSelectedPixels, blockSums, blockNoValidPoints);
+	else return ComputeGandH_common<false>(ATA_host, ATb_host, f_host, sceneHierarchyLevel, approxInvPose, scenePose, distThresh,
+		selectedPointsX, selectedPointsY, selectedPointsZ, noSelectedPixels, blockSums, blockNoValidPoints);
+}
@@ -10,14 +10,45 @@ namespace ITMLib
 	{
 		class ITMDepthTracker_CPU : public ITMDepthTracker
 		{
+		private:
+			/// Maximum number of pixels selected on each level, 0 uses all pixels.
+			int pointBudget;
+
+			/// Pixels of the current level visited by ComputeGandH(), in raster order: all pixels with a
+			/// valid depth, or those picked by the point selection.
+			int *selectedPixels, noSelectedPixels;
+			/// Points back projected from the depths of the selected pixels, one array per coordinate.
+			float *selectedPointsX, *selectedPointsY, *selectedPointsZ;
+			/// Normal direction bin of each pixel of the current level.
+			unsigned char *pixelBins;
+
+			/// Partial sums and numbers of valid points of the blocks of points evaluated in parallel
+			float *blockSums;
+			int *blockNoValidPoints;
+
+			/// Picks pointBudget pixels spread over the normal directions into selectedPixels, returns false if there are not more candidates than that.
+			bool SelectPixelsByNormal(const float *depth, Vector2i imgSize, Vector4f intrinsics);
+
 		protected:
-			void ChangeIgnorePixelToZero(ITMFloatImage *image);
-			int ComputeGandH(ITMSceneHierarchyLevel *sceneHierarchyLevel, ITMTemplatedHierarchyLevel<ITMFloatImage> *viewHierarchyLevel,
+			int SelectPoints(const ITMDepthPyramidLevel *viewLevel);
+			int ComputeGandH(ITMSceneHierarchyLevel *sceneHierarchyLevel, const ITMDepthPyramidLevel *viewLevel,
 				Matrix4f approxInvPose, Matrix4f imagePose, bool rotationOnly);
 
 		public:
-			ITMDepthTracker_CPU(Vector2i imgSize, int noHierarchyLevels, int noRotationOnlyLevels, int noICPRunTillLevel, float distThresh, ITMLowLevelEngine *lowLevelEngine);
+			/** @p pointBudget limits the number of pixels used
+			    on each level. If more pixels have a valid normal,
+			    they are picked evenly from bins of similar normal
+			    direction, so that all directions of motion stay
+			    constrained.
+			*/
+			ITMDepthTracker_CPU(Vector2i imgSize, int noHierarchyLevels, int noRotationOnlyLevels, int noICPRunTillLevel, float distThresh,
+				const int *noIterationsPerLevel, float stepThreshold, float residualThreshold, int minNoInliers, ITMLowLevelEngine *lowLevelEngine,
+				int pointBudget = 0);
 			~ITMDepthTracker_CPU(void);
+
+			// Suppress the default copy constructor and assignment operator
+			ITMDepthTracker_CPU(const ITMDepthTracker_CPU&);
+			ITMDepthTracker_CPU& operator=(const ITMDepthTracker_CPU&);
 		};
 	}
 }
\ No newline at end of file
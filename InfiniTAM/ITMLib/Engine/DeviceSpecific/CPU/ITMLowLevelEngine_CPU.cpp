@@ -4,9 +4,362 @@
 
 #include "../../DeviceAgnostic/ITMLowLevelEngine.h"
 
+#include <algorithm>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
 using namespace ITMLib::Engine;
 
-ITMLowLevelEngine_CPU::ITMLowLevelEngine_CPU(void) { }
+// All kernels below process the image row by row. The AVX2 versions handle as many pixels of a row
+// as fit into full vectors and return the first pixel they did not process, the rest of the row is
+// left to the device agnostic functions. Both give exactly the same results.
+
+#ifdef __AVX2__
+/// Integer division by 8 of 16 bit values, rounding towards zero as in C.
+static inline __m256i divideBy8_AVX2(__m256i v)
+{
+	return _mm256_srai_epi16(_mm256_add_epi16(v, _mm256_and_si256(_mm256_srai_epi16(v, 15), _mm256_set1_epi16(7))), 3);
+}
+
+static inline __m256i loadUChar16_AVX2(const uchar *data)
+{
+	return _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)data));
+}
+
+static inline __m256i loadUChar4x4_AVX2(const Vector4u *data)
+{
+	return _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)data));
+}
+
+static inline int filterSubsampleRow_AVX2(Vector4u *row_out, const Vector4u *row_in0, const Vector4u *row_in1, int width_out)
+{
+	int x = 0;
+
+	for (; x + 4 <= width_out; x += 4)
+	{
+		__m256i a = _mm256_loadu_si256((const __m256i*)(row_in0 + 2 * x)), b = _mm256_loadu_si256((const __m256i*)(row_in1 + 2 * x));
+
+		// vertical sums of the pixels 0-3 and 4-7, each pixel a quadword of four 16 bit channels
+		__m256i s0 = _mm256_add_epi16(_mm256_cvtepu8_epi16(_mm256_castsi256_si128(a)), _mm256_cvtepu8_epi16(_mm256_castsi256_si128(b)));
+		__m256i s1 = _mm256_add_epi16(_mm256_cvtepu8_epi16(_mm256_extracti128_si256(a, 1)), _mm256_cvtepu8_epi16(_mm256_extracti128_si256(b, 1)));
+
+		// horizontal sums of neighbouring pixels, in the order 0+1, 4+5, 2+3, 6+7
+		__m256i sum = _mm256_add_epi16(_mm256_unpacklo_epi64(s0, s1), _mm256_unpackhi_epi64(s0, s1));
+		sum = _mm256_permute4x64_epi64(_mm256_srli_epi16(sum, 2), _MM_SHUFFLE(3, 1, 2, 0));
+
+		_mm_storeu_si128((__m128i*)(row_out + x), _mm_packus_epi16(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1)));
+	}
+
+	return x;
+}
+
+static inline int filterSubsampleRow_AVX2(uchar *row_out, const uchar *row_in0, const uchar *row_in1, int width_out)
+{
+	const __m256i ones = _mm256_set1_epi8(1);
+	int x = 0;
+
+	for (; x + 16 <= width_out; x += 16)
+	{
+		__m256i a = _mm256_loadu_si256((const __m256i*)(row_in0 + 2 * x)), b = _mm256_loadu_si256((const __m256i*)(row_in1 + 2 * x));
+
+		__m256i sum = _mm256_add_epi16(_mm256_maddubs_epi16(a, ones), _mm256_maddubs_epi16(b, ones));
+		sum = _mm256_srli_epi16(sum, 2);
+		sum = _mm256_permute4x64_epi64(_mm256_packus_epi16(sum, sum), _MM_SHUFFLE(3, 1, 2, 0));
+
+		_mm_storeu_si128((__m128i*)(row_out + x), _mm256_castsi256_si128(sum));
+	}
+
+	return x;
+}
+
+/// Splits 16 consecutive floats into those at even and at odd positions.
+static inline void deinterleave_AVX2(__m256 &even, __m256 &odd, const float *data)
+{
+	__m256 a = _mm256_loadu_ps(data), b = _mm256_loadu_ps(data + 8);
+
+	even = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0))), _MM_SHUFFLE(3, 1, 2, 0)));
+	odd = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1))), _MM_SHUFFLE(3, 1, 2, 0)));
+}
+
+static inline int filterSubsampleWithHolesRow_AVX2(float *row_out, const float *row_in0, const float *row_in1, int width_out)
+{
+	const __m256 zero = _mm256_setzero_ps(), one = _mm256_set1_ps(1.0f);
+	int x = 0;
+
+	for (; x + 8 <= width_out; x += 8)
+	{
+		__m256 pixels_in[4];
+		deinterleave_AVX2(pixels_in[0], pixels_in[1], row_in0 + 2 * x);
+		deinterleave_AVX2(pixels_in[2], pixels_in[3], row_in1 + 2 * x);
+
+		// invalid pixels add zero, in the same order as the device agnostic version
+		__m256 pixel_out = zero, no_good_pixels = zero;
+		for (int i = 0; i < 4; i++)
+		{
+			__m256 isGood = _mm256_cmp_ps(pixels_in[i], zero, _CMP_GT_OQ);
+			pixel_out = _mm256_add_ps(pixel_out, _mm256_and_ps(pixels_in[i], isGood));
+			no_good_pixels = _mm256_add_ps(no_good_pixels, _mm256_and_ps(one, isGood));
+		}
+
+		pixel_out = _mm256_blendv_ps(pixel_out, _mm256_div_ps(pixel_out, no_good_pixels), _mm256_cmp_ps(no_good_pixels, zero, _CMP_GT_OQ));
+
+		_mm256_storeu_ps(row_out + x, pixel_out);
+	}
+
+	return x;
+}
+
+static inline int filterSubsampleWithHolesRow_AVX2(Vector4f *row_out, const Vector4f *row_in0, const Vector4f *row_in1, int width_out)
+{
+	const __m256 zero = _mm256_setzero_ps(), one = _mm256_set1_ps(1.0f), invalid = _mm256_setr_ps(0.0f, 0.0f, 0.0f, -1.0f, 0.0f, 0.0f, 0.0f, -1.0f);
+	int x = 0;
+
+	for (; x + 2 <= width_out; x += 2)
+	{
+		__m256 a0 = _mm256_loadu_ps((const float*)(row_in0 + 2 * x)), a1 = _mm256_loadu_ps((const float*)(row_in0 + 2 * x + 2));
+		__m256 b0 = _mm256_loadu_ps((const float*)(row_in1 + 2 * x)), b1 = _mm256_loadu_ps((const float*)(row_in1 + 2 * x + 2));
+
+		// one output pixel per 128 bit lane
+		__m256 pixels_in[4];
+		pixels_in[0] = _mm256_permute2f128_ps(a0, a1, 0x20); pixels_in[1] = _mm256_permute2f128_ps(a0, a1, 0x31);
+		pixels_in[2] = _mm256_permute2f128_ps(b0, b1, 0x20); pixels_in[3] = _mm256_permute2f128_ps(b0, b1, 0x31);
+
+		__m256 pixel_out = zero, no_good_pixels = zero;
+		for (int i = 0; i < 4; i++)
+		{
+			__m256 isGood = _mm256_permute_ps(_mm256_cmp_ps(pixels_in[i], zero, _CMP_GE_OQ), _MM_SHUFFLE(3, 3, 3, 3));
+			pixel_out = _mm256_add_ps(pixel_out, _mm256_and_ps(pixels_in[i], isGood));
+			no_good_pixels = _mm256_add_ps(no_good_pixels, _mm256_and_ps(one, isGood));
+		}
+
+		pixel_out = _mm256_blendv_ps(invalid, _mm256_div_ps(pixel_out, no_good_pixels), _mm256_cmp_ps(no_good_pixels, zero, _CMP_GT_OQ));
+
+		_mm256_storeu_ps((float*)(row_out + x), pixel_out);
+	}
+
+	return x;
+}
+
+static inline int gradientXRow_AVX2(Vector4s *grad_row, const Vector4u *rowAbove, const Vector4u *row, const Vector4u *rowBelow, int x, int xEnd)
+{
+	const __m256i w = _mm256_set1_epi16(255);
+
+	for (; x + 4 <= xEnd; x += 4)
+	{
+		__m256i d1 = _mm256_sub_epi16(loadUChar4x4_AVX2(rowAbove + x + 1), loadUChar4x4_AVX2(rowAbove + x - 1));
+		__m256i d2 = _mm256_sub_epi16(loadUChar4x4_AVX2(row + x + 1), loadUChar4x4_AVX2(row + x - 1));
+		__m256i d3 = _mm256_sub_epi16(loadUChar4x4_AVX2(rowBelow + x + 1), loadUChar4x4_AVX2(rowBelow + x - 1));
+
+		__m256i d_out = divideBy8_AVX2(_mm256_add_epi16(_mm256_add_epi16(d1, _mm256_slli_epi16(d2, 1)), d3));
+
+		// the w channel of the device agnostic version is always (2 * 255 * 4) / 8
+		_mm256_storeu_si256((__m256i*)(grad_row + x), _mm256_blend_epi16(d_out, w, 0x88));
+	}
+
+	return x;
+}
+
+static inline int gradientYRow_AVX2(Vector4s *grad_row, const Vector4u *rowAbove, const Vector4u *rowBelow, int x, int xEnd)
+{
+	const __m256i w = _mm256_set1_epi16(255);
+
+	for (; x + 4 <= xEnd; x += 4)
+	{
+		__m256i d1 = _mm256_sub_epi16(loadUChar4x4_AVX2(rowBelow + x - 1), loadUChar4x4_AVX2(rowAbove + x - 1));
+		__m256i d2 = _mm256_sub_epi16(loadUChar4x4_AVX2(rowBelow + x), loadUChar4x4_AVX2(rowAbove + x));
+		__m256i d3 = _mm256_sub_epi16(loadUChar4x4_AVX2(rowBelow + x + 1), loadUChar4x4_AVX2(rowAbove + x + 1));
+
+		__m256i d_out = divideBy8_AVX2(_mm256_add_epi16(_mm256_add_epi16(d1, _mm256_slli_epi16(d2, 1)), d3));
+
+		_mm256_storeu_si256((__m256i*)(grad_row + x), _mm256_blend_epi16(d_out, w, 0x88));
+	}
+
+	return x;
+}
+
+static inline int gradientRow_AVX2(Vector2s *grad_row, const uchar *rowAbove, const uchar *row, const uchar *rowBelow, int x, int xEnd)
+{
+	for (; x + 16 <= xEnd; x += 16)
+	{
+		__m256i aboveLeft = loadUChar16_AVX2(rowAbove + x - 1), above = loadUChar16_AVX2(rowAbove + x), aboveRight = loadUChar16_AVX2(rowAbove + x + 1);
+		__m256i belowLeft = loadUChar16_AVX2(rowBelow + x - 1), below = loadUChar16_AVX2(rowBelow + x), belowRight = loadUChar16_AVX2(rowBelow + x + 1);
+		__m256i left = loadUChar16_AVX2(row + x - 1), right = loadUChar16_AVX2(row + x + 1);
+
+		__m256i dx = _mm256_add_epi16(_mm256_add_epi16(_mm256_sub_epi16(aboveRight, aboveLeft), _mm256_slli_epi16(_mm256_sub_epi16(right, left), 1)),
+			_mm256_sub_epi16(belowRight, belowLeft));
+		__m256i dy = _mm256_add_epi16(_mm256_add_epi16(_mm256_sub_epi16(belowLeft, aboveLeft), _mm256_slli_epi16(_mm256_sub_epi16(below, above), 1)),
+			_mm256_sub_epi16(belowRight, aboveRight));
+
+		dx = divideBy8_AVX2(dx); dy = divideBy8_AVX2(dy);
+
+		// interleaved as Vector2s, the unpacks give the pixels 0-3 and 8-11, and 4-7 and 12-15
+		__m256i lo = _mm256_unpacklo_epi16(dx, dy), hi = _mm256_unpackhi_epi16(dx, dy);
+		_mm256_storeu_si256((__m256i*)(grad_row + x), _mm256_permute2x128_si256(lo, hi, 0x20));
+		_mm256_storeu_si256((__m256i*)(grad_row + x + 8), _mm256_permute2x128_si256(lo, hi, 0x31));
+	}
+
+	return x;
+}
+
+/// Luminance of eight pixels as 32 bit integers, see convertColourToIntensity.
+static inline __m256i colourToIntensity8_AVX2(__m256i rgb)
+{
+	const __m256i lowBytes = _mm256_set1_epi32(0x00ff00ff);
+	const __m256i weights_rb = _mm256_set1_epi32((29 << 16) | 77), weights_ga = _mm256_set1_epi32(150), half = _mm256_set1_epi32(128);
+
+	__m256i sum = _mm256_add_epi32(_mm256_madd_epi16(_mm256_and_si256(rgb, lowBytes), weights_rb), _mm256_madd_epi16(_mm256_srli_epi16(rgb, 8), weights_ga));
+
+	return _mm256_srli_epi32(_mm256_add_epi32(sum, half), 8);
+}
+
+static inline int convertColourToIntensityRow_AVX2(uchar *intensity, const Vector4u *rgb, int width)
+{
+	int x = 0;
+
+	for (; x + 16 <= width; x += 16)
+	{
+		__m256i a = colourToIntensity8_AVX2(_mm256_loadu_si256((const __m256i*)(rgb + x)));
+		__m256i b = colourToIntensity8_AVX2(_mm256_loadu_si256((const __m256i*)(rgb + x + 8)));
+
+		__m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi32(a, b), _MM_SHUFFLE(3, 1, 2, 0));
+		_mm_storeu_si128((__m128i*)(intensity + x), _mm_packus_epi16(_mm256_castsi256_si128(packed), _mm256_extracti128_si256(packed, 1)));
+	}
+
+	return x;
+}
+
+static inline int convertDisparityToDepthRow_AVX2(float *d_out, const short *d_in, Vector2f disparityCalibParams, float fx_depth, int width)
+{
+	const __m256 zero = _mm256_setzero_ps(), invalid = _mm256_set1_ps(-1.0f), offset = _mm256_set1_ps(disparityCalibParams.x);
+	const __m256 scale = _mm256_set1_ps(8.0f * disparityCalibParams.y * fx_depth);
+	int x = 0;
+
+	for (; x + 8 <= width; x += 8)
+	{
+		__m256 disparity = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)(d_in + x))));
+		__m256 disparity_tmp = _mm256_sub_ps(offset, disparity);
+		__m256 depth = _mm256_div_ps(scale, disparity_tmp);
+
+		__m256 isValid = _mm256_and_ps(_mm256_cmp_ps(disparity_tmp, zero, _CMP_NEQ_OQ), _mm256_cmp_ps(depth, zero, _CMP_GT_OQ));
+		_mm256_storeu_ps(d_out + x, _mm256_blendv_ps(invalid, depth, isValid));
+	}
+
+	return x;
+}
+
+static inline int convertDepthMMToFloatRow_AVX2(float *d_out, const short *d_in, int width)
+{
+	const __m256 invalid = _mm256_set1_ps(-1.0f), mmToMetres = _mm256_set1_ps(1000.0f);
+	const __m256i zero = _mm256_setzero_si256(), maxDepth = _mm256_set1_epi32(32001);
+	int x = 0;
+
+	for (; x + 8 <= width; x += 8)
+	{
+		__m256i depth_in = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)(d_in + x)));
+		__m256i isValid = _mm256_and_si256(_mm256_cmpgt_epi32(depth_in, zero), _mm256_cmpgt_epi32(maxDepth, depth_in));
+
+		__m256 depth = _mm256_div_ps(_mm256_cvtepi32_ps(depth_in), mmToMetres);
+		_mm256_storeu_ps(d_out + x, _mm256_blendv_ps(invalid, depth, _mm256_castsi256_ps(isValid)));
+	}
+
+	return x;
+}
+
+static inline int unprojectDepthRow_AVX2(Vector4f *points_row, float *depth_row, int y, int width, Vector4f intrinsics, int &noValidDepths)
+{
+	const __m256 zero = _mm256_setzero_ps(), one = _mm256_set1_ps(1.0f), invalid = _mm256_set1_ps(-1.0f);
+	const __m256 cx = _mm256_set1_ps(intrinsics.z), fx = _mm256_set1_ps(intrinsics.x);
+	const __m256 yScale = _mm256_set1_ps(((float)y - intrinsics.w) / intrinsics.y);
+	int x = 0;
+
+	for (; x + 8 <= width; x += 8)
+	{
+		__m256 d = _mm256_loadu_ps(depth_row + x);
+		__m256 isValid = _mm256_cmp_ps(d, zero, _CMP_GT_OQ);
+
+		__m256 xs = _mm256_add_ps(_mm256_set1_ps((float)x), _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f));
+		__m256 px = _mm256_and_ps(_mm256_mul_ps(d, _mm256_div_ps(_mm256_sub_ps(xs, cx), fx)), isValid);
+		__m256 py = _mm256_and_ps(_mm256_mul_ps(d, yScale), isValid);
+		__m256 pz = _mm256_and_ps(d, isValid);
+		__m256 pw = _mm256_blendv_ps(invalid, one, isValid);
+
+		_mm256_storeu_ps(depth_row + x, pz);
+		noValidDepths += _mm_popcnt_u32(_mm256_movemask_ps(isValid));
+
+		// transposed to one Vector4f per pixel, the lanes hold the pixels 0 and 4, 1 and 5 and so on
+		__m256 xy_lo = _mm256_unpacklo_ps(px, py), xy_hi = _mm256_unpackhi_ps(px, py);
+		__m256 zw_lo = _mm256_unpacklo_ps(pz, pw), zw_hi = _mm256_unpackhi_ps(pz, pw);
+		__m256 p04 = _mm256_shuffle_ps(xy_lo, zw_lo, _MM_SHUFFLE(1, 0, 1, 0)), p15 = _mm256_shuffle_ps(xy_lo, zw_lo, _MM_SHUFFLE(3, 2, 3, 2));
+		__m256 p26 = _mm256_shuffle_ps(xy_hi, zw_hi, _MM_SHUFFLE(1, 0, 1, 0)), p37 = _mm256_shuffle_ps(xy_hi, zw_hi, _MM_SHUFFLE(3, 2, 3, 2));
+
+		float *out = (float*)(points_row + x);
+		_mm256_storeu_ps(out, _mm256_permute2f128_ps(p04, p15, 0x20));
+		_mm256_storeu_ps(out + 8, _mm256_permute2f128_ps(p26, p37, 0x20));
+		_mm256_storeu_ps(out + 16, _mm256_permute2f128_ps(p04, p15, 0x31));
+		_mm256_storeu_ps(out + 24, _mm256_permute2f128_ps(p26, p37, 0x31));
+	}
+
+	return x;
+}
+#endif
+
+static void filterSubsampleWithHolesRow(float *imageData_out, int y, Vector2i newDims, const float *imageData_in, Vector2i oldDims)
+{
+	int x = 0;
+#ifdef __AVX2__
+	x = filterSubsampleWithHolesRow_AVX2(imageData_out + y * newDims.x, imageData_in + 2 * y * oldDims.x, imageData_in + (2 * y + 1) * oldDims.x, newDims.x);
+#endif
+	for (; x < newDims.x; x++) filterSubsampleWithHoles(imageData_out, x, y, newDims, imageData_in, oldDims);
+}
+
+static void convertDisparityToDepthRow(float *d_out, int y, const short *d_in, Vector2f disparityCalibParams, float fx_depth, Vector2i imgSize)
+{
+	int x = 0;
+#ifdef __AVX2__
+	x = convertDisparityToDepthRow_AVX2(d_out + y * imgSize.x, d_in + y * imgSize.x, disparityCalibParams, fx_depth, imgSize.x);
+#endif
+	for (; x < imgSize.x; x++) convertDisparityToDepth(d_out, x, y, d_in, disparityCalibParams, fx_depth, imgSize);
+}
+
+static void convertDepthMMToFloatRow(float *d_out, int y, const short *d_in, Vector2i imgSize)
+{
+	int x = 0;
+#ifdef __AVX2__
+	x = convertDepthMMToFloatRow_AVX2(d_out + y * imgSize.x, d_in + y * imgSize.x, imgSize.x);
+#endif
+	for (; x < imgSize.x; x++) convertDepthMMToFloat(d_out, x, y, d_in, imgSize);
+}
+
+/// Back projects one row of @p depth as unprojectDepthToCamera does and returns the number of valid depths in it.
+static int unprojectDepthRow(Vector4f *points, int y, float *depth, Vector2i imgSize, Vector4f intrinsics)
+{
+	int x = 0, noValidDepths = 0;
+#ifdef __AVX2__
+	x = unprojectDepthRow_AVX2(points + y * imgSize.x, depth + y * imgSize.x, y, imgSize.x, intrinsics, noValidDepths);
+#endif
+	for (; x < imgSize.x; x++) noValidDepths += unprojectDepthToCamera(points, x, y, depth, imgSize, intrinsics);
+
+	return noValidDepths;
+}
+
+/// Sets the pixels in the first and last row and column to @p zero, where the gradients are not computed.
+template<class T> static void clearBorder(T *image, Vector2i imgSize, const T &zero)
+{
+	if (imgSize.y <= 0) return;
+
+	std::fill(image, image + imgSize.x, zero);
+	std::fill(image + (imgSize.y - 1) * imgSize.x, image + imgSize.y * imgSize.x, zero);
+
+	for (int y = 1; y < imgSize.y - 1; y++)
+	{
+		image[y * imgSize.x] = zero;
+		image[y * imgSize.x + imgSize.x - 1] = zero;
+	}
+}
+
+ITMLowLevelEngine_CPU::ITMLowLevelEngine_CPU(void) : ITMLowLevelEngine(false) { }
 ITMLowLevelEngine_CPU::~ITMLowLevelEngine_CPU(void) { }
 
 void ITMLowLevelEngine_CPU::CopyImage(ITMUChar4Image *image_out, const ITMUChar4Image *image_in)
@@ -43,8 +396,40 @@ void ITMLowLevelEngine_CPU::FilterSubsample(ITMUChar4Image *image_out, const ITM
 	const Vector4u *imageData_in = image_in->GetData(false);
 	Vector4u *imageData_out = image_out->GetData(false);
 
-	for (int y = 0; y < newDims.y; y++) for (int x = 0; x < newDims.x; x++)
-		filterSubsample(imageData_out, x, y, newDims, imageData_in, oldDims);
+#ifdef WITH_OPENMP
+	#pragma omp parallel for
+#endif
+	for (int y = 0; y < newDims.y; y++)
+	{
+		int x = 0;
+#ifdef __AVX2__
+		x = filterSubsampleRow_AVX2(imageData_out + y * newDims.x, imageData_in + 2 * y * oldDims.x, imageData_in + (2 * y + 1) * oldDims.x, newDims.x);
+#endif
+		for (; x < newDims.x; x++) filterSubsample(imageData_out, x, y, newDims, imageData_in, oldDims);
+	}
+}
+
+void ITMLowLevelEngine_CPU::FilterSubsample(ITMUCharImage *image_out, const ITMUCharImage *image_in)
+{
+	Vector2i oldDims = image_in->noDims;
+	Vector2i newDims; newDims.x = image_in->noDims.x / 2; newDims.y = image_in->noDims.y / 2;
+
+	image_out->ChangeDims(newDims);
+
+	const uchar *imageData_in = image_in->GetData(false);
+	uchar *imageData_out = image_out->GetData(false);
+
+#ifdef WITH_OPENMP
+	#pragma omp parallel for
+#endif
+	for (int y = 0; y < newDims.y; y++)
+	{
+		int x = 0;
+#ifdef __AVX2__
+		x = filterSubsampleRow_AVX2(imageData_out + y * newDims.x, imageData_in + 2 * y * oldDims.x, imageData_in + (2 * y + 1) * oldDims.x, newDims.x);
+#endif
+		for (; x < newDims.x; x++) filterSubsample(imageData_out, x, y, newDims, imageData_in, oldDims);
+	}
 }
 
 void ITMLowLevelEngine_CPU::FilterSubsampleWithHoles(ITMFloatImage *image_out, const ITMFloatImage *image_in)
@@ -57,8 +442,10 @@ void ITMLowLevelEngine_CPU::FilterSubsampleWithHoles(ITMFloatImage *image_out, c
 	const float *imageData_in = image_in->GetData(false);
 	float *imageData_out = image_out->GetData(false);
 
-	for (int y = 0; y < newDims.y; y++) for (int x = 0; x < newDims.x; x++)
-		filterSubsampleWithHoles(imageData_out, x, y, newDims, imageData_in, oldDims);
+#ifdef WITH_OPENMP
+	#pragma omp parallel for
+#endif
+	for (int y = 0; y < newDims.y; y++) filterSubsampleWithHolesRow(imageData_out, y, newDims, imageData_in, oldDims);
 }
 
 void ITMLowLevelEngine_CPU::FilterSubsampleWithHoles(ITMFloat4Image *image_out, const ITMFloat4Image *image_in)
@@ -71,8 +458,34 @@ void ITMLowLevelEngine_CPU::FilterSubsampleWithHoles(ITMFloat4Image *image_out,
 	const Vector4f *imageData_in = image_in->GetData(false);
 	Vector4f *imageData_out = image_out->GetData(false);
 
+#ifdef WITH_OPENMP
+	#pragma omp parallel for
+#endif
+	for (int y = 0; y < newDims.y; y++)
+	{
+		int x = 0;
+#ifdef __AVX2__
+		x = filterSubsampleWithHolesRow_AVX2(imageData_out + y * newDims.x, imageData_in + 2 * y * oldDims.x, imageData_in + (2 * y + 1) * oldDims.x, newDims.x);
+#endif
+		for (; x < newDims.x; x++) filterSubsampleWithHoles(imageData_out, x, y, newDims, imageData_in, oldDims);
+	}
+}
+
+void ITMLowLevelEngine_CPU::FilterSubsampleNormalsWithHoles(ITMFloat4Image *normals_out, const ITMFloat4Image *normals_in)
+{
+	Vector2i oldDims = normals_in->noDims;
+	Vector2i newDims; newDims.x = normals_in->noDims.x / 2; newDims.y = normals_in->noDims.y / 2;
+
+	normals_out->ChangeDims(newDims);
+
+	const Vector4f *imageData_in = normals_in->GetData(false);
+	Vector4f *imageData_out = normals_out->GetData(false);
+
+#ifdef WITH_OPENMP
+	#pragma omp parallel for
+#endif
 	for (int y = 0; y < newDims.y; y++) for (int x = 0; x < newDims.x; x++)
-		filterSubsampleWithHoles(imageData_out, x, y, newDims, imageData_in, oldDims);
+		filterSubsampleNormalsWithHoles(imageData_out, x, y, newDims, imageData_in, oldDims);
 }
 
 void ITMLowLevelEngine_CPU::GradientX(ITMShort4Image *grad_out, const ITMUChar4Image *image_in)
@@ -83,10 +496,20 @@ void ITMLowLevelEngine_CPU::GradientX(ITMShort4Image *grad_out, const ITMUChar4I
 	Vector4s *grad = grad_out->GetData(false); 
 	const Vector4u *image = image_in->GetData(false);
 
-	memset(grad, 0, imgSize.x * imgSize.y * sizeof(Vector3s));
-
-	for (int y = 1; y < imgSize.y - 1; y++) for (int x = 1; x < imgSize.x - 1; x++)
-		gradientX(grad, x, y, image, imgSize);
+	clearBorder(grad, imgSize, Vector4s((short)0));
+
+#ifdef WITH_OPENMP
+	#pragma omp parallel for
+#endif
+	for (int y = 1; y < imgSize.y - 1; y++)
+	{
+		int x = 1;
+#ifdef __AVX2__
+		const Vector4u *row = image + y * imgSize.x;
+		x = gradientXRow_AVX2(grad + y * imgSize.x, row - imgSize.x, row, row + imgSize.x, x, imgSize.x - 1);
+#endif
+		for (; x < imgSize.x - 1; x++) gradientX(grad, x, y, image, imgSize);
+	}
 }
 
 void ITMLowLevelEngine_CPU::GradientY(ITMShort4Image *grad_out, const ITMUChar4Image *image_in)
@@ -97,10 +520,65 @@ void ITMLowLevelEngine_CPU::GradientY(ITMShort4Image *grad_out, const ITMUChar4I
 	Vector4s *grad = grad_out->GetData(false);
 	const Vector4u *image = image_in->GetData(false);
 
-	memset(grad, 0, imgSize.x * imgSize.y * sizeof(Vector3s));
+	clearBorder(grad, imgSize, Vector4s((short)0));
+
+#ifdef WITH_OPENMP
+	#pragma omp parallel for
+#endif
+	for (int y = 1; y < imgSize.y - 1; y++)
+	{
+		int x = 1;
+#ifdef __AVX2__
+		const Vector4u *row = image + y * imgSize.x;
+		x = gradientYRow_AVX2(grad + y * imgSize.x, row - imgSize.x, row + imgSize.x, x, imgSize.x - 1);
+#endif
+		for (; x < imgSize.x - 1; x++) gradientY(grad, x, y, image, imgSize);
+	}
+}
+
+void ITMLowLevelEngine_CPU::Gradient(ITMShort2Image *grad_out, const ITMUCharImage *image_in)
+{
+	grad_out->ChangeDims(image_in->noDims);
+	Vector2i imgSize = image_in->noDims;
+
+	Vector2s *grad = grad_out->GetData(false);
+	const uchar *image = image_in->GetData(false);
+
+	clearBorder(grad, imgSize, Vector2s((short)0));
+
+#ifdef WITH_OPENMP
+	#pragma omp parallel for
+#endif
+	for (int y = 1; y < imgSize.y - 1; y++)
+	{
+		int x = 1;
+#ifdef __AVX2__
+		const uchar *row = image + y * imgSize.x;
+		x = gradientRow_AVX2(grad + y * imgSize.x, row - imgSize.x, row, row + imgSize.x, x, imgSize.x - 1);
+#endif
+		for (; x < imgSize.x - 1; x++) gradient(grad, x, y, image, imgSize);
+	}
+}
 
-	for (int y = 1; y < imgSize.y - 1; y++) for (int x = 1; x < imgSize.x - 1; x++)
-		gradientY(grad, x, y, image, imgSize);
+void ITMLowLevelEngine_CPU::ConvertColourToIntensity(ITMUCharImage *image_out, const ITMUChar4Image *image_in)
+{
+	image_out->ChangeDims(image_in->noDims);
+	Vector2i imgSize = image_in->noDims;
+
+	uchar *intensity = image_out->GetData(false);
+	const Vector4u *rgb = image_in->GetData(false);
+
+#ifdef WITH_OPENMP
+	#pragma omp parallel for
+#endif
+	for (int y = 0; y < imgSize.y; y++)
+	{
+		int x = 0;
+#ifdef __AVX2__
+		x = convertColourToIntensityRow_AVX2(intensity + y * imgSize.x, rgb + y * imgSize.x, imgSize.x);
+#endif
+		for (; x < imgSize.x; x++) convertColourToIntensity(intensity, x, y, rgb, imgSize);
+	}
 }
 
 void ITMLowLevelEngine_CPU::ConvertDisparityToDepth(ITMFloatImage *depth_out, const ITMShortImage *depth_in, const ITMIntrinsics *depthIntrinsics,
@@ -116,8 +594,10 @@ void ITMLowLevelEngine_CPU::ConvertDisparityToDepth(ITMFloatImage *depth_out, co
 	disparityCalibParams.y = disparityCalib->params.y;
 	fx_depth = depthIntrinsics->projectionParamsSimple.fx;
 
-	for (int y = 0; y < imgSize.y; y++) for (int x = 0; x < imgSize.x; x++)
-		convertDisparityToDepth(d_out, x, y, d_in, disparityCalibParams, fx_depth, imgSize);
+#ifdef WITH_OPENMP
+	#pragma omp parallel for
+#endif
+	for (int y = 0; y < imgSize.y; y++) convertDisparityToDepthRow(d_out, y, d_in, disparityCalibParams, fx_depth, imgSize);
 }
 
 void ITMLowLevelEngine_CPU::ConvertDepthMMToFloat(ITMFloatImage *depth_out, const ITMShortImage *depth_in)
@@ -127,6 +607,122 @@ void ITMLowLevelEngine_CPU::ConvertDepthMMToFloat(ITMFloatImage *depth_out, cons
 	const short *d_in = depth_in->GetData(false);
 	float *d_out = depth_out->GetData(false);
 
+#ifdef WITH_OPENMP
+	#pragma omp parallel for
+#endif
+	for (int y = 0; y < imgSize.y; y++) convertDepthMMToFloatRow(d_out, y, d_in, imgSize);
+}
+
+void ITMLowLevelEngine_CPU::CreateICPMapsFromDepth(ITMFloat4Image *pointsMap, ITMFloat4Image *normalsMap, const ITMFloatImage *depth, Vector4f intrinsics,
+	const Matrix4f & invM, float maxNormalDist)
+{
+	Vector2i imgSize = depth->noDims;
+
+	const float *d_in = depth->GetData(false);
+	Vector4f *points = pointsMap->GetData(false);
+	Vector4f *normals = normalsMap->GetData(false);
+
+#ifdef WITH_OPENMP
+	#pragma omp parallel for
+#endif
 	for (int y = 0; y < imgSize.y; y++) for (int x = 0; x < imgSize.x; x++)
-		convertDepthMMToFloat(d_out, x, y, d_in, imgSize);
+		unprojectDepthToWorld(points, x, y, d_in, imgSize, intrinsics, invM);
+
+#ifdef WITH_OPENMP
+	#pragma omp parallel for
+#endif
+	for (int y = 0; y < imgSize.y; y++) for (int x = 0; x < imgSize.x; x++)
+		computeNormalFromPointsMap(x, y, points, normals, imgSize, maxNormalDist);
+}
+
+int ITMLowLevelEngine_CPU::UnprojectDepth(ITMFloat4Image *points, ITMFloatImage *depth, Vector4f intrinsics)
+{
+	Vector2i imgSize = depth->noDims;
+
+	points->ChangeDims(imgSize);
+
+	float *d_in = depth->GetData(false);
+	Vector4f *pts_out = points->GetData(false);
+
+	int noValidDepths = 0;
+
+#ifdef WITH_OPENMP
+	#pragma omp parallel for reduction(+:noValidDepths)
+#endif
+	for (int y = 0; y < imgSize.y; y++) noValidDepths += unprojectDepthRow(pts_out, y, d_in, imgSize, intrinsics);
+
+	return noValidDepths;
+}
+
+/// Converts and back projects one row of the finest level of the pyramid, or subsamples and back projects one row of a coarser level.
+static int convertDepthToPyramidRow(int levelId, int y, float *d_out, const short *d_in, const ITMDisparityCalib *disparityCalib, float fx_depth,
+	ITMDepthPyramid *pyramid)
+{
+	ITMDepthPyramidLevel *level = pyramid->levels[levelId];
+	Vector2i imgSize = level->depth->noDims;
+	float *depth = level->depth->GetData(false);
+
+	if (levelId == 0)
+	{
+		if (disparityCalib != NULL) convertDisparityToDepthRow(d_out, y, d_in, Vector2f(disparityCalib->params.x, disparityCalib->params.y), fx_depth, imgSize);
+		else convertDepthMMToFloatRow(d_out, y, d_in, imgSize);
+
+		// the depth of the pyramid is set to zero where invalid, the converted one keeps its -1
+		memcpy(depth + y * imgSize.x, d_out + y * imgSize.x, imgSize.x * sizeof(float));
+	}
+	else
+	{
+		ITMDepthPyramidLevel *previousLevel = pyramid->levels[levelId - 1];
+		filterSubsampleWithHolesRow(depth, y, imgSize, previousLevel->depth->GetData(false), previousLevel->depth->noDims);
+	}
+
+	return unprojectDepthRow(level->points->GetData(false), y, depth, imgSize, level->intrinsics);
+}
+
+int ITMLowLevelEngine_CPU::ConvertDepthToPyramid(ITMFloatImage *depth_out, const ITMShortImage *depth_in, const ITMIntrinsics *depthIntrinsics,
+	const ITMDisparityCalib *disparityCalib, ITMDepthPyramid *pyramid, int noLevels)
+{
+	static const int maxNoFusedLevels = 3;
+	int noFusedLevels = MIN(noLevels, maxNoFusedLevels);
+
+	const short *d_in = depth_in->GetData(false);
+	float *d_out = depth_out->GetData(false);
+	float fx_depth = depthIntrinsics->projectionParamsSimple.fx;
+
+	// Each row of the coarsest fused level is built together with the rows of the finer levels it is computed from,
+	// 2 rows of the level above it, 4 of the level above that, while those are still in the cache.
+	int noBlocks = pyramid->levels[noFusedLevels - 1]->depth->noDims.y;
+	int noValidDepths[maxNoFusedLevels] = { 0 };
+
+#ifdef WITH_OPENMP
+	#pragma omp parallel for
+#endif
+	for (int blockId = 0; blockId < noBlocks; blockId++)
+	{
+		for (int levelId = 0; levelId < noFusedLevels; levelId++)
+		{
+			int noRows = 1 << (noFusedLevels - 1 - levelId), blockNoValidDepths = 0;
+
+			for (int y = blockId * noRows; y < (blockId + 1) * noRows; y++)
+				blockNoValidDepths += convertDepthToPyramidRow(levelId, y, d_out, d_in, disparityCalib, fx_depth, pyramid);
+
+#ifdef WITH_OPENMP
+			#pragma omp atomic
+#endif
+			noValidDepths[levelId] += blockNoValidDepths;
+		}
+	}
+
+	// the rows below the last block, if the image height is not a multiple of the block height
+	for (int levelId = 0; levelId < noFusedLevels; levelId++)
+	{
+		int noRows = 1 << (noFusedLevels - 1 - levelId);
+
+		for (int y = noBlocks * noRows; y < pyramid->levels[levelId]->depth->noDims.y; y++)
+			noValidDepths[levelId] += convertDepthToPyramidRow(levelId, y, d_out, d_in, disparityCalib, fx_depth, pyramid);
+	}
+
+	for (int levelId = 0; levelId < noFusedLevels; levelId++) pyramid->levels[levelId]->noValidDepths = noValidDepths[levelId];
+
+	return noFusedLevels;
 }
@@ -1,42 +1,187 @@
 #include "ITMRenTracker_CPU.h"
 #include "../../DeviceAgnostic/ITMRenTracker.h"
 #include "../../DeviceAgnostic/ITMRepresentationAccess.h" 
+#include "ITMBlockReduction_CPU.h"
 
 using namespace ITMLib::Engine;
 
+// the depth points are visited in tiles of tileSize x tileSize pixels, so that neighbouring
+// points reuse the cached voxel block, and bands of tiles are the blocks of the deterministic
+// reduction, see ITMBlockReduction_CPU.h
+static const int tileSize = 8, blockSumSize = 6 + 6 + 5 + 4 + 3 + 2 + 1;
+
 template<class TVoxel, class TIndex>
 ITMRenTracker_CPU<TVoxel, TIndex>::ITMRenTracker_CPU(Vector2i imgSize, int noHierarchyLevels, ITMLowLevelEngine *lowLevelEngine, ITMScene<TVoxel,TIndex> *scene)
-	: ITMRenTracker<TVoxel, TIndex>(imgSize, noHierarchyLevels, lowLevelEngine, scene, false) { }
+	: ITMRenTracker<TVoxel, TIndex>(imgSize, noHierarchyLevels, lowLevelEngine, scene, false)
+{
+	int noMaxBands = (imgSize.y + tileSize - 1) / tileSize;
+
+	bandSums = new float[noMaxBands * blockSumSize];
+
+	int noLevels = this->noHierarchyLevels;
+	pointsX = new float*[noLevels]; pointsY = new float*[noLevels]; pointsZ = new float*[noLevels];
+	tileEnds = new int*[noLevels];
+
+	for (int levelId = 0; levelId < noLevels; levelId++)
+	{
+		Vector2i levelSize(imgSize.x >> levelId, imgSize.y >> levelId);
+		int noTiles = ((levelSize.x + tileSize - 1) / tileSize) * ((levelSize.y + tileSize - 1) / tileSize);
+
+		pointsX[levelId] = new float[levelSize.x * levelSize.y];
+		pointsY[levelId] = new float[levelSize.x * levelSize.y];
+		pointsZ[levelId] = new float[levelSize.x * levelSize.y];
+		tileEnds[levelId] = new int[noTiles];
+	}
+}
 
 template<class TVoxel, class TIndex>
-ITMRenTracker_CPU<TVoxel,TIndex>::~ITMRenTracker_CPU(void) { }
+ITMRenTracker_CPU<TVoxel,TIndex>::~ITMRenTracker_CPU(void)
+{
+	delete[] bandSums;
+
+	for (int levelId = 0; levelId < this->noHierarchyLevels; levelId++)
+	{
+		delete[] pointsX[levelId]; delete[] pointsY[levelId]; delete[] pointsZ[levelId];
+		delete[] tileEnds[levelId];
+	}
+
+	delete[] pointsX; delete[] pointsY; delete[] pointsZ;
+	delete[] tileEnds;
+}
+
+#ifdef __AVX2__
+/// Eight lane expf, Cephes style range reduction and polynomial.
+static inline __m256 exp_AVX2(__m256 x)
+{
+	x = _mm256_min_ps(_mm256_max_ps(x, _mm256_set1_ps(-87.3365f)), _mm256_set1_ps(88.3762f));
+
+	__m256 n = _mm256_floor_ps(_mm256_add_ps(_mm256_mul_ps(x, _mm256_set1_ps(1.44269504088896341f)), _mm256_set1_ps(0.5f)));
+
+	x = _mm256_sub_ps(x, _mm256_mul_ps(n, _mm256_set1_ps(0.693359375f)));
+	x = _mm256_sub_ps(x, _mm256_mul_ps(n, _mm256_set1_ps(-2.12194440e-4f)));
+
+	__m256 y = _mm256_set1_ps(1.9875691500e-4f);
+	y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(1.3981999507e-3f));
+	y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(8.3334519073e-3f));
+	y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(4.1665795894e-2f));
+	y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(1.6666665459e-1f));
+	y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(5.0000001201e-1f));
+	y = _mm256_add_ps(_mm256_mul_ps(y, _mm256_mul_ps(x, x)), _mm256_add_ps(x, _mm256_set1_ps(1.0f)));
+
+	__m256i pow2n = _mm256_slli_epi32(_mm256_add_epi32(_mm256_cvtps_epi32(n), _mm256_set1_epi32(127)), 23);
+	return _mm256_mul_ps(y, _mm256_castsi256_ps(pow2n));
+}
+
+/// Eight point version of computeLogisticEnergy
+static inline __m256 computeLogisticEnergy_AVX2(__m256 dt)
+{
+	__m256 expdt = exp_AVX2(_mm256_mul_ps(dt, _mm256_set1_ps(-DTUNE)));
+	__m256 deto = _mm256_add_ps(expdt, _mm256_set1_ps(1.0f));
+	return _mm256_div_ps(_mm256_mul_ps(_mm256_set1_ps(4.0f), expdt), _mm256_mul_ps(deto, deto));
+}
+
+/// Eight point version of computeJacobianFromDT, the gradient and Gauss-Newton Hessian
+/// contributions are added to the lanes of @p sumGradient and @p sumHessian.
+static inline void computePerPointGH_Ren_AVX2(__m256 *sumGradient, __m256 *sumHessian, const float *dt, const float *dDt, const float *cPt, int stride)
+{
+	const __m256 four = _mm256_set1_ps(4.0f);
+
+	__m256 expdt = exp_AVX2(_mm256_mul_ps(_mm256_loadu_ps(dt), _mm256_set1_ps(-DTUNE)));
+	__m256 deto = _mm256_add_ps(expdt, _mm256_set1_ps(1.0f));
+	__m256 detoSq = _mm256_mul_ps(deto, deto);
+
+	// exp(-2 dt DTUNE) is expdt^2
+	__m256 prefix = _mm256_sub_ps(_mm256_div_ps(_mm256_mul_ps(_mm256_set1_ps(2.0f), _mm256_mul_ps(expdt, expdt)), _mm256_mul_ps(detoSq, deto)),
+		_mm256_div_ps(expdt, detoSq));
+	prefix = _mm256_mul_ps(prefix, _mm256_set1_ps(4.0f * DTUNE));
+
+	__m256 dx = _mm256_mul_ps(_mm256_loadu_ps(dDt), prefix);
+	__m256 dy = _mm256_mul_ps(_mm256_loadu_ps(dDt + stride), prefix);
+	__m256 dz = _mm256_mul_ps(_mm256_loadu_ps(dDt + 2 * stride), prefix);
+	__m256 cx = _mm256_loadu_ps(cPt), cy = _mm256_loadu_ps(cPt + stride), cz = _mm256_loadu_ps(cPt + 2 * stride);
+
+	__m256 jacobian[6];
+	jacobian[0] = dx; jacobian[1] = dy; jacobian[2] = dz;
+	jacobian[3] = _mm256_mul_ps(four, _mm256_sub_ps(_mm256_mul_ps(dz, cy), _mm256_mul_ps(dy, cz)));
+	jacobian[4] = _mm256_mul_ps(four, _mm256_sub_ps(_mm256_mul_ps(dx, cz), _mm256_mul_ps(dz, cx)));
+	jacobian[5] = _mm256_mul_ps(four, _mm256_sub_ps(_mm256_mul_ps(dy, cx), _mm256_mul_ps(dx, cy)));
+
+	for (int r = 0, counter = 0; r < 6; r++)
+	{
+		sumGradient[r] = _mm256_sub_ps(sumGradient[r], jacobian[r]);
+		for (int c = 0; c <= r; c++, counter++) sumHessian[counter] = _mm256_add_ps(sumHessian[counter], _mm256_mul_ps(jacobian[r], jacobian[c]));
+	}
+}
+#endif
 
 template<class TVoxel, class TIndex>
 void ITMRenTracker_CPU<TVoxel,TIndex>::F_oneLevel(float *f, Matrix4f invM)
 {
-	int count = this->viewHierarchy->levels[this->levelId]->depth->dataSize;
-	Vector4f *ptList = this->viewHierarchy->levels[this->levelId]->depth->GetData(false);
+	Vector2i imgSize = this->depthPyramid->levels[this->levelId]->points->noDims;
+	const float *ptX = pointsX[this->levelId], *ptY = pointsY[this->levelId], *ptZ = pointsZ[this->levelId];
+	const int *levelTileEnds = tileEnds[this->levelId];
 
 	const TVoxel *voxelBlocks = this->scene->localVBA.GetVoxelBlocks();
 	const typename TIndex::IndexData *index = this->scene->index.getIndexData();
 	float oneOverVoxelSize = 1.0f / (float)this->scene->sceneParams->voxelSize;
 
-	float energy = 0;
+	int noBands = (imgSize.y + tileSize - 1) / tileSize, noTilesX = (imgSize.x + tileSize - 1) / tileSize;
 
-	for (int i = 0; i < count; i++)
+#ifdef WITH_OPENMP
+	#pragma omp parallel for schedule(dynamic)
+#endif
+	for (int bandId = 0; bandId < noBands; bandId++)
 	{
-		Vector4f inpt = ptList[i];
-		if (inpt.w > -1.0f) energy += computePerPixelEnergy<TVoxel,TIndex>(inpt, voxelBlocks, index, oneOverVoxelSize, invM);
+		typename TIndex::IndexCache cache;
+		float dtList[tileSize * tileSize];
+
+		float bandEnergy = 0.0f;
+#ifdef __AVX2__
+		__m256 sumEnergy_AVX2 = _mm256_setzero_ps();
+#endif
+
+		int pointId = bandId * tileSize * imgSize.x;
+
+		for (int tileX = 0; tileX < noTilesX; tileX++)
+		{
+			int pointEnd = levelTileEnds[tileX + bandId * noTilesX], noDT = 0;
+
+			for (; pointId < pointEnd; pointId++)
+			{
+				Vector4f inpt(ptX[pointId], ptY[pointId], ptZ[pointId], 1.0f);
+
+				bool isFound;
+				Vector3f pt = (invM * inpt * oneOverVoxelSize).toVector3();
+				float dt = readFromSDF_float_uninterpolated(voxelBlocks, index, pt, isFound, cache);
+
+				if (dt != 1.0f) dtList[noDT++] = dt;
+			}
+
+			int i = 0;
+#ifdef __AVX2__
+			for (; i + 8 <= noDT; i += 8) sumEnergy_AVX2 = _mm256_add_ps(sumEnergy_AVX2, computeLogisticEnergy_AVX2(_mm256_loadu_ps(dtList + i)));
+#endif
+			for (; i < noDT; i++) bandEnergy += computeLogisticEnergy(dtList[i]);
+		}
+
+#ifdef __AVX2__
+		bandEnergy += sumLanes_AVX2(sumEnergy_AVX2);
+#endif
+		bandSums[bandId * blockSumSize] = bandEnergy;
 	}
 
+	float energy = 0;
+	for (int bandId = 0; bandId < noBands; bandId++) energy += bandSums[bandId * blockSumSize];
+
 	f[0] = -energy;
 }
 
 template<class TVoxel, class TIndex>
 void ITMRenTracker_CPU<TVoxel,TIndex>::G_oneLevel(float *gradient, float *hessian, Matrix4f invM) const
 {
-	int count = this->viewHierarchy->levels[this->levelId]->depth->dataSize;
-	Vector4f *ptList = this->viewHierarchy->levels[this->levelId]->depth->GetData(false);
+	Vector2i imgSize = this->depthPyramid->levels[this->levelId]->points->noDims;
+	const float *ptX = pointsX[this->levelId], *ptY = pointsY[this->levelId], *ptZ = pointsZ[this->levelId];
+	const int *levelTileEnds = tileEnds[this->levelId];
 
 	const TVoxel *voxelBlocks = this->scene->localVBA.GetVoxelBlocks();
 	const typename TIndex::IndexData *index = this->scene->index.getIndexData();
@@ -48,21 +193,79 @@ void ITMRenTracker_CPU<TVoxel,TIndex>::G_oneLevel(float *gradient, float *hessia
 	for (int i = 0; i < noPara; i++) globalGradient[i] = 0.0f;
 	for (int i = 0; i < noParaSQ; i++) globalHessian[i] = 0.0f;
 
-	for (int i = 0; i < count; i++)
+	int noBands = (imgSize.y + tileSize - 1) / tileSize, noTilesX = (imgSize.x + tileSize - 1) / tileSize;
+
+#ifdef WITH_OPENMP
+	#pragma omp parallel for schedule(dynamic)
+#endif
+	for (int bandId = 0; bandId < noBands; bandId++)
 	{
-		Vector4f cPt = ptList[i];
-		if (cPt.w == -1.0f) continue;
+		const int noTilePoints = tileSize * tileSize;
+
+		typename TIndex::IndexCache cache;
+		float dtList[noTilePoints], dDtList[3 * noTilePoints], cPtList[3 * noTilePoints];
+
+		float *sumGradient = bandSums + bandId * blockSumSize, *sumHessian = sumGradient + 6;
+		for (int i = 0; i < noPara; i++) sumGradient[i] = 0.0f;
+		for (int i = 0; i < noParaSQ; i++) sumHessian[i] = 0.0f;
 
-		float jacobian[6];
+#ifdef __AVX2__
+		__m256 sumGradient_AVX2[6], sumHessian_AVX2[21];
+		for (int i = 0; i < noPara; i++) sumGradient_AVX2[i] = _mm256_setzero_ps();
+		for (int i = 0; i < noParaSQ; i++) sumHessian_AVX2[i] = _mm256_setzero_ps();
+#endif
 
-		if (computePerPixelJacobian<TVoxel,TIndex>(jacobian, cPt, voxelBlocks, index, oneOverVoxelSize, invM))
+		int pointId = bandId * tileSize * imgSize.x;
+
+		for (int tileX = 0; tileX < noTilesX; tileX++)
 		{
-			for (int r = 0, counter = 0; r < noPara; r++)
+			int pointEnd = levelTileEnds[tileX + bandId * noTilesX], noDT = 0;
+
+			for (; pointId < pointEnd; pointId++)
 			{
-				globalGradient[r] -= jacobian[r];
-				for (int c = 0; c <= r; c++, counter++) globalHessian[counter] += jacobian[r] * jacobian[c];
+				Vector4f inpt(ptX[pointId], ptY[pointId], ptZ[pointId], 1.0f);
+
+				float dt; Vector3f dDt, cPt;
+				if (!computePerPixelDT<TVoxel,TIndex>(dt, dDt, cPt, inpt, voxelBlocks, index, oneOverVoxelSize, invM, cache)) continue;
+
+				dtList[noDT] = dt;
+				dDtList[noDT] = dDt.x; dDtList[noDT + noTilePoints] = dDt.y; dDtList[noDT + 2 * noTilePoints] = dDt.z;
+				cPtList[noDT] = cPt.x; cPtList[noDT + noTilePoints] = cPt.y; cPtList[noDT + 2 * noTilePoints] = cPt.z;
+				noDT++;
+			}
+
+			int i = 0;
+#ifdef __AVX2__
+			for (; i + 8 <= noDT; i += 8)
+				computePerPointGH_Ren_AVX2(sumGradient_AVX2, sumHessian_AVX2, dtList + i, dDtList + i, cPtList + i, noTilePoints);
+#endif
+			for (; i < noDT; i++)
+			{
+				float jacobian[6];
+
+				computeJacobianFromDT(jacobian, dtList[i], Vector3f(dDtList[i], dDtList[i + noTilePoints], dDtList[i + 2 * noTilePoints]),
+					Vector3f(cPtList[i], cPtList[i + noTilePoints], cPtList[i + 2 * noTilePoints]));
+
+				for (int r = 0, counter = 0; r < noPara; r++)
+				{
+					sumGradient[r] -= jacobian[r];
+					for (int c = 0; c <= r; c++, counter++) sumHessian[counter] += jacobian[r] * jacobian[c];
+				}
 			}
 		}
+
+#ifdef __AVX2__
+		for (int i = 0; i < noPara; i++) sumGradient[i] += sumLanes_AVX2(sumGradient_AVX2[i]);
+		for (int i = 0; i < noParaSQ; i++) sumHessian[i] += sumLanes_AVX2(sumHessian_AVX2[i]);
+#endif
+	}
+
+	for (int bandId = 0; bandId < noBands; bandId++)
+	{
+		const float *sumGradient = bandSums + bandId * blockSumSize, *sumHessian = sumGradient + 6;
+
+		for (int i = 0; i < noPara; i++) globalGradient[i] += sumGradient[i];
+		for (int i = 0; i < noParaSQ; i++) globalHessian[i] += sumHessian[i];
 	}
 
 	for (int r = 0, counter = 0; r < noPara; r++) for (int c = 0; c <= r; c++, counter++) hessian[r + c * 6] = globalHessian[counter];
@@ -71,30 +274,44 @@ void ITMRenTracker_CPU<TVoxel,TIndex>::G_oneLevel(float *gradient, float *hessia
 }
 
 template<class TVoxel, class TIndex>
-void ITMRenTracker_CPU<TVoxel,TIndex>::UnprojectDepthToCam(ITMFloatImage *depth, ITMFloat4Image *upPtCloud, const Vector4f &intrinsic)
+void ITMRenTracker_CPU<TVoxel,TIndex>::PrepareViewPoints(void)
 {
-	float *depthMap = depth->GetData(false);
-	Vector4f *camPoints = upPtCloud->GetData(false);
+	for (int levelId = 0; levelId < this->noHierarchyLevels; levelId++)
+	{
+		const ITMDepthPyramidLevel *viewLevel = this->depthPyramid->levels[levelId];
+		const Vector4f *camPoints = viewLevel->points->GetData(false);
+		Vector2i imgSize = viewLevel->points->noDims;
 
-	Vector4f ooIntrinsics;
-	ooIntrinsics.x = 1.0f / intrinsic.x; ooIntrinsics.y = 1.0f / intrinsic.y;
-	ooIntrinsics.z = -intrinsic.z * ooIntrinsics.x; ooIntrinsics.w = -intrinsic.w * ooIntrinsics.y;
+		float *ptX = pointsX[levelId], *ptY = pointsY[levelId], *ptZ = pointsZ[levelId];
+		int *levelTileEnds = tileEnds[levelId];
 
-	Vector2i imgSize = depth->noDims;
-	upPtCloud->noDims = imgSize; upPtCloud->dataSize = depth->dataSize;
+		int noBands = (imgSize.y + tileSize - 1) / tileSize, noTilesX = (imgSize.x + tileSize - 1) / tileSize;
 
-	for (int y = 0; y < imgSize.y; y++) for (int x = 0; x < imgSize.x; x++)
-	{
-		Vector3f inpt; int locId = x + y * imgSize.x;
+		// the valid points are listed tile by tile, in the order F_oneLevel and G_oneLevel visit them
+#ifdef WITH_OPENMP
+		#pragma omp parallel for
+#endif
+		for (int bandId = 0; bandId < noBands; bandId++)
+		{
+			int pointId = bandId * tileSize * imgSize.x;
+			int yStart = bandId * tileSize, yEnd = MIN(yStart + tileSize, imgSize.y);
 
-		inpt.z = depthMap[locId];
+			for (int tileX = 0; tileX < noTilesX; tileX++)
+			{
+				int xStart = tileX * tileSize, xEnd = MIN(xStart + tileSize, imgSize.x);
 
-		if (inpt.z > 0.0f)
-		{
-			inpt.x = x * inpt.z; inpt.y = y * inpt.z;
-			unprojectPtWithIntrinsic(ooIntrinsics, inpt, camPoints[locId]);
+				for (int y = yStart; y < yEnd; y++) for (int x = xStart; x < xEnd; x++)
+				{
+					const Vector4f &pt = camPoints[x + y * imgSize.x];
+					if (pt.w < 0.0f) continue;
+
+					ptX[pointId] = pt.x; ptY[pointId] = pt.y; ptZ[pointId] = pt.z;
+					pointId++;
+				}
+
+				levelTileEnds[tileX + bandId * noTilesX] = pointId;
+			}
 		}
-		else camPoints[locId] = Vector4f(0.0f, 0.0f, 0.0f, -1.0f);
 	}
 }
 
@@ -11,15 +11,32 @@ namespace ITMLib
 		template<class TVoxel, class TIndex>
 		class ITMRenTracker_CPU : public ITMRenTracker<TVoxel,TIndex>
 		{
+		private:
+			/// Partial sums of the bands of image rows evaluated in parallel.
+			/// Scratch space only, so mutable: the const G_oneLevel() of the interface fills them too.
+			mutable float *bandSums;
+
+			/** The valid points of each level in the order they
+			    are evaluated, one array per coordinate. The points
+			    of band b start at b * tileSize * width, those of
+			    each tile end at the entry of tileEnds for it.
+			*/
+			float **pointsX, **pointsY, **pointsZ;
+			int **tileEnds;
+
 		protected:
 			void F_oneLevel(float *f, Matrix4f invM);
 			void G_oneLevel(float *gradient, float *hessian, Matrix4f invM) const;
 
-			void UnprojectDepthToCam(ITMFloatImage *depth, ITMFloat4Image *upPtCloud, const Vector4f &intrinsic);
+			void PrepareViewPoints(void);
 
 		public:
 			ITMRenTracker_CPU(Vector2i imgSize, int noHierarchyLevels, ITMLowLevelEngine *lowLevelEngine, ITMScene<TVoxel,TIndex> *scene);
 			~ITMRenTracker_CPU(void);
+
+			// Suppress the default copy constructor and assignment operator
+			ITMRenTracker_CPU(const ITMRenTracker_CPU&);
+			ITMRenTracker_CPU& operator=(const ITMRenTracker_CPU&);
 		};
 	}
 }
@@ -75,30 +75,27 @@ void ITMSceneReconstructionEngine_CPU<TVoxel,ITMVoxelBlockHash>::IntegrateIntoSc
 }
 
 template<class TVoxel>
-void ITMSceneReconstructionEngine_CPU<TVoxel,ITMVoxelBlockHash>::AllocateSceneFromDepth(ITMScene<TVoxel,ITMVoxelBlockHash> *scene, const ITMView *view, const ITMPose *pose_d)
+void ITMSceneReconstructionEngine_CPU<TVoxel,ITMVoxelBlockHash>::AllocateSceneFromDepth(ITMScene<TVoxel,ITMVoxelBlockHash> *scene, const ITMView *view, const ITMPose *pose_d,
+	const ITMDepthPyramid *depthPyramid)
 {
-	Vector2i depthImgSize = view->depth->noDims;
+	Vector2i depthImgSize = depthPyramid->levels[0]->points->noDims;
+	Vector4f projParams_d = depthPyramid->levels[0]->intrinsics;
 	float voxelSize = scene->sceneParams->voxelSize;
 
 	Matrix4f M_d, invM_d;
-	Vector4f projParams_d, invProjParams_d;
 
 	M_d = pose_d->M; M_d.inv(invM_d);
 
-	projParams_d = view->calib->intrinsics_d.projectionParamsSimple.all;
-	invProjParams_d = projParams_d;
-	invProjParams_d.x = 1.0f / invProjParams_d.x;
-	invProjParams_d.y = 1.0f / invProjParams_d.y;
-
 	float mu = scene->sceneParams->mu;
 
-	float *depth = view->depth->GetData(false);
+	const Vector4f *points = depthPyramid->levels[0]->points->GetData(false);
 	int *voxelAllocationList = scene->localVBA.GetAllocationList();
 	int *excessAllocationList = scene->index.GetExcessAllocationList();
 	uchar *entriesVisibleType = scene->index.GetEntriesVisibleType();
 	ITMHashEntry *hashTable = scene->index.GetEntries();
 	ITMHashCacheState *cacheStates = scene->useSwapping ? scene->globalCache->GetCacheStates(false) : 0;
 	int *liveEntryIDs = scene->index.GetLiveEntryIDs();
+	int *allocatedEntryIDs = scene->index.GetAllocatedEntryIDs();
 	int noTotalEntries = scene->index.noVoxelBlocks;
 
 	bool useSwapping = scene->useSwapping;
@@ -107,6 +104,7 @@ void ITMSceneReconstructionEngine_CPU<TVoxel,ITMVoxelBlockHash>::AllocateSceneFr
 
 	int lastFreeVoxelBlockId = scene->localVBA.lastFreeBlockId;
 	int lastFreeExcessListId = scene->index.lastFreeExcessListId;
+	int noAllocatedEntries = scene->index.noAllocatedEntries;
 
 	Vector3s pt_block_prev;
 	pt_block_prev.x = 0; pt_block_prev.y = 0; pt_block_prev.z = 0;
@@ -120,8 +118,8 @@ void ITMSceneReconstructionEngine_CPU<TVoxel,ITMVoxelBlockHash>::AllocateSceneFr
 	//build hashVisibility
 	for (int y = 0; y < depthImgSize.y; y++) for (int x = 0; x < depthImgSize.x; x++)
 	{
-		buildHashAllocAndVisibleTypePP(entriesAllocType, entriesVisibleType, x, y, blockCoords, depth, invM_d,
-			invProjParams_d, mu, depthImgSize, oneOverVoxelSize, hashTable, scene->sceneParams->viewFrustum_min,
+		buildHashAllocAndVisibleTypePP(entriesAllocType, entriesVisibleType, x, y, blockCoords, points, invM_d,
+			mu, depthImgSize, oneOverVoxelSize, hashTable, scene->sceneParams->viewFrustum_min,
 			scene->sceneParams->viewFrustum_max);
 	}
 
@@ -145,6 +143,9 @@ void ITMSceneReconstructionEngine_CPU<TVoxel,ITMVoxelBlockHash>::AllocateSceneFr
 				hashEntry.ptr = voxelAllocationList[vbaIdx];
 
 				hashTable[targetIdx] = hashEntry;
+
+				allocatedEntryIDs[noAllocatedEntries] = targetIdx;
+				noAllocatedEntries++;
 			}
 
 			break;
@@ -166,6 +167,9 @@ void ITMSceneReconstructionEngine_CPU<TVoxel,ITMVoxelBlockHash>::AllocateSceneFr
 				hashTable[SDF_BUCKET_NUM * SDF_ENTRY_NUM_PER_BUCKET + exlOffset] = hashEntry; //add child to the excess list
 
 				entriesVisibleType[SDF_BUCKET_NUM * SDF_ENTRY_NUM_PER_BUCKET + exlOffset] = 1; //make child visible
+
+				allocatedEntryIDs[noAllocatedEntries] = SDF_BUCKET_NUM * SDF_ENTRY_NUM_PER_BUCKET + exlOffset;
+				noAllocatedEntries++;
 			}
 
 			break;
@@ -241,7 +245,13 @@ void ITMSceneReconstructionEngine_CPU<TVoxel,ITMVoxelBlockHash>::AllocateSceneFr
 			if (entriesVisibleType[targetIdx] > 0 && hashEntry.ptr == -1) 
 			{
 				vbaIdx = lastFreeVoxelBlockId; lastFreeVoxelBlockId--;
-				if (vbaIdx >= 0) hashTable[targetIdx].ptr = voxelAllocationList[vbaIdx];
+				if (vbaIdx >= 0)
+				{
+					hashTable[targetIdx].ptr = voxelAllocationList[vbaIdx];
+
+					allocatedEntryIDs[noAllocatedEntries] = targetIdx;
+					noAllocatedEntries++;
+				}
 			}
 		}
 	}
@@ -249,6 +259,7 @@ void ITMSceneReconstructionEngine_CPU<TVoxel,ITMVoxelBlockHash>::AllocateSceneFr
 	scene->index.noLiveEntries = hashIdxLive;
 	scene->localVBA.lastFreeBlockId = lastFreeVoxelBlockId;
 	scene->index.lastFreeExcessListId = lastFreeExcessListId;
+	scene->index.noAllocatedEntries = noAllocatedEntries;
 }
 
 template<class TVoxel>
@@ -260,7 +271,8 @@ ITMSceneReconstructionEngine_CPU<TVoxel,ITMPlainVoxelArray>::~ITMSceneReconstruc
 {}
 
 template<class TVoxel>
-void ITMSceneReconstructionEngine_CPU<TVoxel,ITMPlainVoxelArray>::AllocateSceneFromDepth(ITMScene<TVoxel,ITMPlainVoxelArray> *scene, const ITMView *view, const ITMPose *pose_d)
+void ITMSceneReconstructionEngine_CPU<TVoxel,ITMPlainVoxelArray>::AllocateSceneFromDepth(ITMScene<TVoxel,ITMPlainVoxelArray> *scene, const ITMView *view, const ITMPose *pose_d,
+	const ITMDepthPyramid *depthPyramid)
 {}
 
 template<class TVoxel>
@@ -20,7 +20,8 @@ namespace ITMLib
 			Vector3s *blockCoords;
 
 		public:
-			void AllocateSceneFromDepth(ITMScene<TVoxel,ITMVoxelBlockHash> *scene, const ITMView *view, const ITMPose *pose);
+			void AllocateSceneFromDepth(ITMScene<TVoxel,ITMVoxelBlockHash> *scene, const ITMView *view, const ITMPose *pose,
+				const ITMDepthPyramid *depthPyramid);
 			
 			void IntegrateIntoScene(ITMScene<TVoxel,ITMVoxelBlockHash> *scene, const ITMView *view, const ITMPose *pose);
 
@@ -36,7 +37,8 @@ namespace ITMLib
 			Vector3s *blockCoords;
 
 		public:
-			void AllocateSceneFromDepth(ITMScene<TVoxel,ITMPlainVoxelArray> *scene, const ITMView *view, const ITMPose *pose);
+			void AllocateSceneFromDepth(ITMScene<TVoxel,ITMPlainVoxelArray> *scene, const ITMView *view, const ITMPose *pose,
+				const ITMDepthPyramid *depthPyramid);
 			
 			void IntegrateIntoScene(ITMScene<TVoxel,ITMPlainVoxelArray> *scene, const ITMView *view, const ITMPose *pose);
 
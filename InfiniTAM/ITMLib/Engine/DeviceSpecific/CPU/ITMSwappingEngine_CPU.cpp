@@ -162,6 +162,21 @@ void ITMSwappingEngine_CPU<TVoxel,ITMVoxelBlockHash>::SaveToGlobalMemory(ITMScen
 
 	scene->localVBA.lastFreeBlockId = noAllocatedVoxelEntries;
 
+	// remove the swapped out entries from the list of allocated entries
+	if (noNeededEntries > 0)
+	{
+		int *allocatedEntryIDs = scene->index.GetAllocatedEntryIDs();
+		int noAllocatedEntries = 0;
+
+		for (int i = 0; i < scene->index.noAllocatedEntries; i++)
+		{
+			int entryId = allocatedEntryIDs[i];
+			if (hashTable[entryId].ptr >= 0) allocatedEntryIDs[noAllocatedEntries++] = entryId;
+		}
+
+		scene->index.noAllocatedEntries = noAllocatedEntries;
+	}
+
 	// would copy neededEntryIDs_local, hasSyncedData_local and syncedVoxelBlocks_local into *_global here
 
 	if (noNeededEntries > 0)
@@ -8,6 +8,38 @@
 
 using namespace ITMLib::Engine;
 
+template<class TVoxel, class TIndex>
+ITMVisualisationEngine_CPU<TVoxel,TIndex>::ITMVisualisationEngine_CPU(void)
+{
+	fwdProjPoints = new ITMFloat4Image(false);
+	fwdProjNormals = new ITMFloat4Image(false);
+	fwdProjDepth = new ITMFloatImage(false);
+}
+
+template<class TVoxel, class TIndex>
+ITMVisualisationEngine_CPU<TVoxel,TIndex>::~ITMVisualisationEngine_CPU(void)
+{
+	delete fwdProjPoints;
+	delete fwdProjNormals;
+	delete fwdProjDepth;
+}
+
+template<class TVoxel>
+ITMVisualisationEngine_CPU<TVoxel,ITMVoxelBlockHash>::ITMVisualisationEngine_CPU(void)
+{
+	fwdProjPoints = new ITMFloat4Image(false);
+	fwdProjNormals = new ITMFloat4Image(false);
+	fwdProjDepth = new ITMFloatImage(false);
+}
+
+template<class TVoxel>
+ITMVisualisationEngine_CPU<TVoxel,ITMVoxelBlockHash>::~ITMVisualisationEngine_CPU(void)
+{
+	delete fwdProjPoints;
+	delete fwdProjNormals;
+	delete fwdProjDepth;
+}
+
 template<class TVoxel>
 ITMVisualisationEngine_CPU<TVoxel,ITMVoxelBlockHash>::State::State(const Vector2i & imgSize)
  : ITMVisualisationState(imgSize, false)
@@ -34,65 +66,35 @@ void ITMVisualisationEngine_CPU<TVoxel,ITMVoxelBlockHash>::FindVisibleBlocks(con
 {
 	State *state = (State*)_state;
 	const ITMHashEntry *hashTable = scene->index.GetEntries();
-	int noTotalEntries = scene->index.noVoxelBlocks;
-	float voxelSize = scene->sceneParams->voxelSize;
+	const int *allocatedEntryIDs = scene->index.GetAllocatedEntryIDs();
+	int noAllocatedEntries = scene->index.noAllocatedEntries;
+	float blockSize = scene->sceneParams->voxelSize * (float)SDF_BLOCK_SIZE;
 	Vector2i imgSize = state->minmaxImage->noDims;
 
-	Matrix4f M = pose->M;
-	Vector4f projParams = intrinsics->projectionParamsSimple.all;
+	Vector4f frustumPlanes[5];
+	ComputeFrustumPlanes(frustumPlanes, pose->M, intrinsics->projectionParamsSimple.all, imgSize);
 
-	state->visibleEntriesNum = 0;
+	uchar *entriesVisibleType = state->entriesVisibleType;
 
-	//build visible list
-	for (int targetIdx = 0; targetIdx < noTotalEntries; targetIdx++)
+	//check visibility of the allocated blocks only
+#ifdef WITH_OPENMP
+	#pragma omp parallel for
+#endif
+	for (int allocatedIdx = 0; allocatedIdx < noAllocatedEntries; allocatedIdx++)
 	{
-		unsigned char hashVisibleType = 0;// = entriesVisibleType[targetIdx];
+		int targetIdx = allocatedEntryIDs[allocatedIdx];
 		const ITMHashEntry &hashEntry = hashTable[targetIdx];
 
-		if (hashEntry.ptr >= 0)
-		{
-			Vector3f pt_image, buff3f;
-
-			int noInvisible = 0;//, noInvisibleEnlarged = 0;
-
-//			pt_image = hashEntry.pos.toFloat() * (float)SDF_BLOCK_SIZE * voxelSize;
-//			buff3f = M_d * pt_image;
-
-//			if (buff3f.z > 1e-10f)
-//			{
-			for (int x = 0; x <= 1; x++) for (int y = 0; y <= 1; y++) for (int z = 0; z <= 1; z++)
-			{
-				Vector3f off((float)x, (float)y, (float)z);
-
-				pt_image = (hashEntry.pos.toFloat() + off) * (float)SDF_BLOCK_SIZE * voxelSize;
-
-				buff3f = M * pt_image;
-
-				if (buff3f.z < 1e-10f) continue;
-
-				pt_image.x = projParams.x * buff3f.x / buff3f.z + projParams.z;
-				pt_image.y = projParams.y * buff3f.y / buff3f.z + projParams.w;
-
-				if (!(pt_image.x >= 0 && pt_image.x < imgSize.x && pt_image.y >= 0 && pt_image.y < imgSize.y)) noInvisible++;
-
-				/*if (useSwapping)
-				TODO
-				{
-					Vector4i lims;
-					lims.x = -depthImgSize.x / 8; lims.y = depthImgSize.x + depthImgSize.x / 8;
-					lims.z = -depthImgSize.y / 8; lims.w = depthImgSize.y + depthImgSize.y / 8;
-
-					if (!(pt_image.x >= lims.x && pt_image.x < lims.y && pt_image.y >= lims.z && pt_image.y < lims.w)) noInvisibleEnlarged++;
-				}*/
-			}
-
-			hashVisibleType = noInvisible < 8;
+		entriesVisibleType[targetIdx] = hashEntry.ptr >= 0 && IsBlockInFrustum(hashEntry.pos, frustumPlanes, blockSize);
+	}
 
-			//if (useSwapping) entriesVisibleType[targetIdx] = noInvisibleEnlarged < 8;
-			//}
-		}
+	//build visible list, keeping the order of the allocated list
+	state->visibleEntriesNum = 0;
+	for (int allocatedIdx = 0; allocatedIdx < noAllocatedEntries; allocatedIdx++)
+	{
+		int targetIdx = allocatedEntryIDs[allocatedIdx];
 
-		if (hashVisibleType > 0)
+		if (entriesVisibleType[targetIdx] > 0)
 		{
 			state->visibleEntryIDs[state->visibleEntriesNum] = targetIdx;
 			state->visibleEntriesNum++;
@@ -116,12 +118,30 @@ void ITMVisualisationEngine_CPU<TVoxel,TIndex>::CreateExpectedDepths(const ITMSc
 	}
 }
 
-template<class TVoxel>
-void ITMVisualisationEngine_CPU<TVoxel,ITMVoxelBlockHash>::CreateExpectedDepths(const ITMScene<TVoxel,ITMVoxelBlockHash> *scene, const ITMPose *pose, const ITMIntrinsics *intrinsics, ITMImage<Vector2f> *minmaximg, const ITMVisualisationState *state)
+/// Adds the rendering blocks covering the projection of a voxel block, growing the list if required.
+static void AddRenderingBlocks(std::vector<RenderingBlock> & renderingBlocks, int & numRenderingBlocks, const Vector3s & blockPos, const Matrix4f & pose,
+	const Vector4f & intrinsics, const Vector2i & imgSize, float voxelSize)
 {
-	Vector2i imgSize = minmaximg->noDims;
-	Vector2f *minmaxData = minmaximg->GetData(false);
+	Vector2i upperLeft, lowerRight;
+	Vector2f zRange;
+	if (!ProjectSingleBlock(blockPos, pose, intrinsics, imgSize, voxelSize, upperLeft, lowerRight, zRange)) return;
+
+	Vector2i requiredRenderingBlocks((int)ceilf((float)(lowerRight.x - upperLeft.x + 1) / (float)renderingBlockSizeX), 
+		(int)ceilf((float)(lowerRight.y - upperLeft.y + 1) / (float)renderingBlockSizeY));
+	int requiredNumBlocks = requiredRenderingBlocks.x * requiredRenderingBlocks.y;
 
+	if (numRenderingBlocks + requiredNumBlocks >= MAX_RENDERING_BLOCKS) return;
+	if ((int)renderingBlocks.size() < numRenderingBlocks + requiredNumBlocks) renderingBlocks.resize(numRenderingBlocks + requiredNumBlocks);
+
+	int offset = numRenderingBlocks;
+	numRenderingBlocks += requiredNumBlocks;
+
+	CreateRenderingBlocks(&(renderingBlocks[0]), offset, upperLeft, lowerRight, zRange);
+}
+
+/// Sets the depth range of each pixel to the one of the rendering blocks covering it.
+static void FillExpectedDepths(Vector2f *minmaxData, const Vector2i & imgSize, const RenderingBlock *renderingBlocks, int numRenderingBlocks)
+{
 	for (int y = 0; y < imgSize.y; ++y) {
 		for (int x = 0; x < imgSize.x; ++x) {
 			Vector2f & pixel = minmaxData[x + y*imgSize.x];
@@ -130,6 +150,27 @@ void ITMVisualisationEngine_CPU<TVoxel,ITMVoxelBlockHash>::CreateExpectedDepths(
 		}
 	}
 
+	// go through rendering blocks
+	for (int blockNo = 0; blockNo < numRenderingBlocks; ++blockNo) {
+		// fill minmaxData
+		const RenderingBlock & b(renderingBlocks[blockNo]);
+
+		for (int y = b.upperLeft.y; y <= b.lowerRight.y; ++y) {
+			for (int x = b.upperLeft.x; x <= b.lowerRight.x; ++x) {
+				Vector2f & pixel(minmaxData[x + y*imgSize.x]);
+				if (pixel.x > b.zRange.x) pixel.x = b.zRange.x;
+				if (pixel.y < b.zRange.y) pixel.y = b.zRange.y;
+			}
+		}
+	}
+}
+
+template<class TVoxel>
+void ITMVisualisationEngine_CPU<TVoxel,ITMVoxelBlockHash>::CreateExpectedDepths(const ITMScene<TVoxel,ITMVoxelBlockHash> *scene, const ITMPose *pose, const ITMIntrinsics *intrinsics, ITMImage<Vector2f> *minmaximg, const ITMVisualisationState *state)
+{
+	Vector2i imgSize = minmaximg->noDims;
+	Vector2f *minmaxData = minmaximg->GetData(false);
+
 	float voxelSize = scene->sceneParams->voxelSize;
 
 	std::vector<RenderingBlock> renderingBlocks(MAX_RENDERING_BLOCKS);
@@ -147,38 +188,12 @@ void ITMVisualisationEngine_CPU<TVoxel,ITMVoxelBlockHash>::CreateExpectedDepths(
 	for (int blockNo = 0; blockNo < noLiveEntries; ++blockNo) {
 		const ITMHashEntry & blockData(scene->index.GetEntries()[liveEntryIDs[blockNo]]);
 
-		Vector2i upperLeft, lowerRight;
-		Vector2f zRange;
-		bool validProjection = false;
 		if (blockData.ptr>=0) {
-			validProjection = ProjectSingleBlock(blockData.pos, pose->M, intrinsics->projectionParamsSimple.all, imgSize, voxelSize, upperLeft, lowerRight, zRange);
+			AddRenderingBlocks(renderingBlocks, numRenderingBlocks, blockData.pos, pose->M, intrinsics->projectionParamsSimple.all, imgSize, voxelSize);
 		}
-		if (!validProjection) continue;
-
-		Vector2i requiredRenderingBlocks((int)ceilf((float)(lowerRight.x - upperLeft.x + 1) / (float)renderingBlockSizeX), 
-			(int)ceilf((float)(lowerRight.y - upperLeft.y + 1) / (float)renderingBlockSizeY));
-		int requiredNumBlocks = requiredRenderingBlocks.x * requiredRenderingBlocks.y;
-
-		if (numRenderingBlocks + requiredNumBlocks >= MAX_RENDERING_BLOCKS) continue;
-		int offset = numRenderingBlocks;
-		numRenderingBlocks += requiredNumBlocks;
-
-		CreateRenderingBlocks(&(renderingBlocks[0]), offset, upperLeft, lowerRight, zRange);
 	}
 
-	// go through rendering blocks
-	for (int blockNo = 0; blockNo < numRenderingBlocks; ++blockNo) {
-		// fill minmaxData
-		const RenderingBlock & b(renderingBlocks[blockNo]);
-
-		for (int y = b.upperLeft.y; y <= b.lowerRight.y; ++y) {
-			for (int x = b.upperLeft.x; x <= b.lowerRight.x; ++x) {
-				Vector2f & pixel(minmaxData[x + y*imgSize.x]);
-				if (pixel.x > b.zRange.x) pixel.x = b.zRange.x;
-				if (pixel.y < b.zRange.y) pixel.y = b.zRange.y;
-			}
-		}
-	}
+	FillExpectedDepths(minmaxData, imgSize, &(renderingBlocks[0]), numRenderingBlocks);
 }
 
 template<class TVoxel, class TIndex>
@@ -321,6 +336,174 @@ static void CreateICPMaps_common(const ITMScene<TVoxel,TIndex> *scene, const ITM
 	}
 }
 
+template<class TVoxel, class TIndex>
+static void CreateICPMapsWithPointNormals_common(const ITMScene<TVoxel,TIndex> *scene, const ITMView *view, ITMTrackingState *trackingState)
+{
+	const TVoxel *voxelData = scene->localVBA.GetVoxelBlocks();
+	const typename TIndex::IndexData *voxelIndex = scene->index.getIndexData();
+
+	Vector2i imgSize = view->depth->noDims;
+	float voxelSize = scene->sceneParams->voxelSize;
+	float oneOverVoxelSize = 1.0f / scene->sceneParams->voxelSize;
+
+	Matrix4f invM = trackingState->pose_d->invM;
+	Vector4f projParams = view->calib->intrinsics_d.projectionParamsSimple.all;
+	projParams.x = 1.0f / projParams.x;
+	projParams.y = 1.0f / projParams.y;
+
+	float mu = scene->sceneParams->mu;
+	Vector3f lightSource = -Vector3f(invM.getColumn(2));
+
+	Vector4f *pointsMap = trackingState->pointCloud->locations->GetData(false);
+	Vector4f *normalsMap = trackingState->pointCloud->colours->GetData(false);
+	Vector4u *outRendering = trackingState->rendering->GetData(false);
+	const Vector2f *minmaximg = trackingState->renderingRangeImage->GetData(false);
+
+	// raycast the points only
+#ifdef WITH_OPENMP
+	#pragma omp parallel for
+#endif
+	for (int y = 0; y < imgSize.y; y++) for (int x = 0; x < imgSize.x; x++)
+	{
+		genericRaycastPoint<TVoxel,TIndex>(x, y, pointsMap, voxelData, voxelIndex, imgSize, invM, projParams, voxelSize, oneOverVoxelSize, minmaximg, mu);
+	}
+
+	// normals from neighbouring points, neighbours further apart than mu lie across a depth discontinuity
+#ifdef WITH_OPENMP
+	#pragma omp parallel for
+#endif
+	for (int y = 0; y < imgSize.y; y++) for (int x = 0; x < imgSize.x; x++)
+	{
+		computeNormalFromPointsMap(x, y, pointsMap, normalsMap, imgSize, mu);
+	}
+
+#ifdef WITH_OPENMP
+	#pragma omp parallel for
+#endif
+	for (int y = 0; y < imgSize.y; y++) for (int x = 0; x < imgSize.x; x++)
+	{
+		shadeForwardProjectedPixel<TVoxel,TIndex>(x + y * imgSize.x, pointsMap, normalsMap, outRendering, voxelData, voxelIndex, oneOverVoxelSize, lightSource);
+	}
+}
+
+template<class TVoxel, class TIndex>
+static void CreateICPMapsSubsampled_common(const ITMScene<TVoxel,TIndex> *scene, const ITMView *view, ITMTrackingState *trackingState, int subsample)
+{
+	const TVoxel *voxelData = scene->localVBA.GetVoxelBlocks();
+	const typename TIndex::IndexData *voxelIndex = scene->index.getIndexData();
+
+	Vector2i imgSize = view->depth->noDims;
+	float voxelSize = scene->sceneParams->voxelSize;
+	float oneOverVoxelSize = 1.0f / scene->sceneParams->voxelSize;
+
+	Matrix4f invM = trackingState->pose_d->invM;
+	Vector4f projParams = view->calib->intrinsics_d.projectionParamsSimple.all;
+	projParams.x = 1.0f / projParams.x;
+	projParams.y = 1.0f / projParams.y;
+
+	float mu = scene->sceneParams->mu;
+	Vector3f lightSource = -Vector3f(invM.getColumn(2));
+
+	Vector4f *pointsMap = trackingState->pointCloud->locations->GetData(false);
+	Vector4f *normalsMap = trackingState->pointCloud->colours->GetData(false);
+	Vector4u *outRendering = trackingState->rendering->GetData(false);
+	const Vector2f *minmaximg = trackingState->renderingRangeImage->GetData(false);
+
+	RaycastRenderer_ICPMaps renderer(outRendering, pointsMap, normalsMap, voxelSize);
+
+	// raycast the samples, i.e. an image of reduced resolution
+#ifdef WITH_OPENMP
+	#pragma omp parallel for
+#endif
+	for (int y = 0; y < imgSize.y; y += subsample) for (int x = 0; x < imgSize.x; x += subsample)
+	{
+		genericRaycastAndRender<TVoxel,TIndex>(x, y, renderer, voxelData, voxelIndex, imgSize, invM, projParams, oneOverVoxelSize, minmaximg, mu, lightSource);
+	}
+
+	// upsample on smooth surfaces, raycast across edges
+#ifdef WITH_OPENMP
+	#pragma omp parallel for
+#endif
+	for (int y = 0; y < imgSize.y; y++) for (int x = 0; x < imgSize.x; x++)
+	{
+		if (x % subsample == 0 && y % subsample == 0) continue;
+
+		if (interpolateICPMapsPixel(x, y, pointsMap, normalsMap, imgSize, subsample, voxelSize, 0.9f))
+			shadeForwardProjectedPixel<TVoxel,TIndex>(x + y * imgSize.x, pointsMap, normalsMap, outRendering, voxelData, voxelIndex, oneOverVoxelSize, lightSource);
+		else genericRaycastAndRender<TVoxel,TIndex>(x, y, renderer, voxelData, voxelIndex, imgSize, invM, projParams, oneOverVoxelSize, minmaximg, mu, lightSource);
+	}
+}
+
+template<class TVoxel, class TIndex>
+static void ForwardRenderICPMaps_common(const ITMScene<TVoxel,TIndex> *scene, const ITMView *view, ITMTrackingState *trackingState,
+	ITMFloat4Image *fwdProjPoints, ITMFloat4Image *fwdProjNormals, ITMFloatImage *fwdProjDepth)
+{
+	const TVoxel *voxelData = scene->localVBA.GetVoxelBlocks();
+	const typename TIndex::IndexData *voxelIndex = scene->index.getIndexData();
+
+	Vector2i imgSize = view->depth->noDims;
+	float voxelSize = scene->sceneParams->voxelSize;
+	float oneOverVoxelSize = 1.0f / scene->sceneParams->voxelSize;
+
+	Matrix4f M = trackingState->pose_d->M;
+	Matrix4f invM = trackingState->pose_d->invM;
+	Vector4f projParams = view->calib->intrinsics_d.projectionParamsSimple.all;
+	Vector4f invProjParams = projParams;
+	invProjParams.x = 1.0f / invProjParams.x;
+	invProjParams.y = 1.0f / invProjParams.y;
+
+	float mu = scene->sceneParams->mu;
+	Vector3f lightSource = -Vector3f(invM.getColumn(2));
+
+	// keep the previous maps as source of the projection
+	fwdProjPoints->ChangeDims(imgSize); fwdProjNormals->ChangeDims(imgSize); fwdProjDepth->ChangeDims(imgSize);
+	fwdProjPoints->SetFrom(trackingState->pointCloud->locations);
+	fwdProjNormals->SetFrom(trackingState->pointCloud->colours);
+
+	const Vector4f *prevPointsMap = fwdProjPoints->GetData(false);
+	const Vector4f *prevNormalsMap = fwdProjNormals->GetData(false);
+	float *depthMap = fwdProjDepth->GetData(false);
+
+	Vector4f *pointsMap = trackingState->pointCloud->locations->GetData(false);
+	Vector4f *normalsMap = trackingState->pointCloud->colours->GetData(false);
+	Vector4u *outRendering = trackingState->rendering->GetData(false);
+	const Vector2f *minmaximg = trackingState->renderingRangeImage->GetData(false);
+
+	int noTotalPixels = imgSize.x * imgSize.y;
+	for (int locId = 0; locId < noTotalPixels; locId++)
+	{
+		pointsMap[locId].w = -1.0f;
+		depthMap[locId] = FAR_AWAY;
+	}
+
+	// splat the previous points into the new view, keeping the closest one
+	for (int locId = 0; locId < noTotalPixels; locId++)
+	{
+		if (prevPointsMap[locId].w <= 0.0f || prevNormalsMap[locId].w < 0.0f) continue;
+
+		float depth;
+		int locId_new = forwardProjectPoint(depth, prevPointsMap[locId], M, projParams, imgSize);
+		if (locId_new < 0 || depth >= depthMap[locId_new]) continue;
+
+		depthMap[locId_new] = depth;
+		pointsMap[locId_new] = prevPointsMap[locId];
+		normalsMap[locId_new] = prevNormalsMap[locId];
+	}
+
+	// raycast holes and disocclusions, shade everything else
+	RaycastRenderer_ICPMaps renderer(outRendering, pointsMap, normalsMap, voxelSize);
+
+#ifdef WITH_OPENMP
+	#pragma omp parallel for
+#endif
+	for (int y = 0; y < imgSize.y; y++) for (int x = 0; x < imgSize.x; x++)
+	{
+		if (forwardProjectionMissing(x, y, pointsMap, depthMap, imgSize, mu))
+			genericRaycastAndRender<TVoxel,TIndex>(x, y, renderer, voxelData, voxelIndex, imgSize, invM, invProjParams, oneOverVoxelSize, minmaximg, mu, lightSource);
+		else shadeForwardProjectedPixel<TVoxel,TIndex>(x + y * imgSize.x, pointsMap, normalsMap, outRendering, voxelData, voxelIndex, oneOverVoxelSize, lightSource);
+	}
+}
+
 template<class TVoxel, class TIndex>
 void ITMVisualisationEngine_CPU<TVoxel,TIndex>::RenderImage(const ITMScene<TVoxel,TIndex> *scene, const ITMPose *pose, const ITMIntrinsics *intrinsics, const ITMVisualisationState *state, ITMUChar4Image *outputImage, bool useColour)
 {
@@ -333,6 +516,52 @@ void ITMVisualisationEngine_CPU<TVoxel,ITMVoxelBlockHash>::RenderImage(const ITM
 	RenderImage_common(scene, pose, intrinsics, state, outputImage, useColour);
 }
 
+template<class TVoxel>
+void ITMVisualisationEngine_CPU<TVoxel,ITMVoxelBlockHash>::RenderImages(const ITMScene<TVoxel,ITMVoxelBlockHash> *scene, int noViews, const ITMPose *poses, const ITMIntrinsics *intrinsics, ITMUChar4Image **outputImages, bool useColour)
+{
+	const ITMHashEntry *hashTable = scene->index.GetEntries();
+	const int *allocatedEntryIDs = scene->index.GetAllocatedEntryIDs();
+	int noAllocatedEntries = scene->index.noAllocatedEntries;
+	float voxelSize = scene->sceneParams->voxelSize;
+	float blockSize = voxelSize * (float)SDF_BLOCK_SIZE;
+
+	std::vector<Vector4f> frustumPlanes(5 * noViews);
+	std::vector<std::vector<RenderingBlock> > renderingBlocks(noViews);
+	std::vector<int> numRenderingBlocks(noViews, 0);
+
+	for (int viewId = 0; viewId < noViews; viewId++)
+		ComputeFrustumPlanes(&(frustumPlanes[5 * viewId]), poses[viewId].M, intrinsics[viewId].projectionParamsSimple.all, outputImages[viewId]->noDims);
+
+	// one sweep over the allocated blocks, projecting each into all views it is visible in
+	for (int allocatedIdx = 0; allocatedIdx < noAllocatedEntries; allocatedIdx++)
+	{
+		const ITMHashEntry &hashEntry = hashTable[allocatedEntryIDs[allocatedIdx]];
+		if (hashEntry.ptr < 0) continue;
+
+		for (int viewId = 0; viewId < noViews; viewId++)
+		{
+			if (!IsBlockInFrustum(hashEntry.pos, &(frustumPlanes[5 * viewId]), blockSize)) continue;
+
+			AddRenderingBlocks(renderingBlocks[viewId], numRenderingBlocks[viewId], hashEntry.pos, poses[viewId].M, 
+				intrinsics[viewId].projectionParamsSimple.all, outputImages[viewId]->noDims, voxelSize);
+		}
+	}
+
+	// the views are independent from here on
+#ifdef WITH_OPENMP
+	#pragma omp parallel for
+#endif
+	for (int viewId = 0; viewId < noViews; viewId++)
+	{
+		ITMVisualisationState state(outputImages[viewId]->noDims, false);
+
+		FillExpectedDepths(state.minmaxImage->GetData(false), outputImages[viewId]->noDims, 
+			renderingBlocks[viewId].empty() ? NULL : &(renderingBlocks[viewId][0]), numRenderingBlocks[viewId]);
+
+		RenderImage_common(scene, &(poses[viewId]), &(intrinsics[viewId]), &state, outputImages[viewId], useColour);
+	}
+}
+
 template<class TVoxel, class TIndex>
 void ITMVisualisationEngine_CPU<TVoxel,TIndex>::CreatePointCloud(const ITMScene<TVoxel,TIndex> *scene, const ITMView *view, ITMTrackingState *trackingState, bool skipPoints)
 {
@@ -357,4 +586,40 @@ void ITMVisualisationEngine_CPU<TVoxel,ITMVoxelBlockHash>::CreateICPMaps(const I
 	CreateICPMaps_common(scene, view, trackingState);
 }
 
+template<class TVoxel, class TIndex>
+void ITMVisualisationEngine_CPU<TVoxel,TIndex>::CreateICPMapsWithPointNormals(const ITMScene<TVoxel,TIndex> *scene, const ITMView *view, ITMTrackingState *trackingState)
+{
+	CreateICPMapsWithPointNormals_common(scene, view, trackingState);
+}
+
+template<class TVoxel>
+void ITMVisualisationEngine_CPU<TVoxel,ITMVoxelBlockHash>::CreateICPMapsWithPointNormals(const ITMScene<TVoxel,ITMVoxelBlockHash> *scene, const ITMView *view, ITMTrackingState *trackingState)
+{
+	CreateICPMapsWithPointNormals_common(scene, view, trackingState);
+}
+
+template<class TVoxel, class TIndex>
+void ITMVisualisationEngine_CPU<TVoxel,TIndex>::CreateICPMapsSubsampled(const ITMScene<TVoxel,TIndex> *scene, const ITMView *view, ITMTrackingState *trackingState, int subsample)
+{
+	CreateICPMapsSubsampled_common(scene, view, trackingState, subsample);
+}
+
+template<class TVoxel>
+void ITMVisualisationEngine_CPU<TVoxel,ITMVoxelBlockHash>::CreateICPMapsSubsampled(const ITMScene<TVoxel,ITMVoxelBlockHash> *scene, const ITMView *view, ITMTrackingState *trackingState, int subsample)
+{
+	CreateICPMapsSubsampled_common(scene, view, trackingState, subsample);
+}
+
+template<class TVoxel, class TIndex>
+void ITMVisualisationEngine_CPU<TVoxel,TIndex>::ForwardRenderICPMaps(const ITMScene<TVoxel,TIndex> *scene, const ITMView *view, ITMTrackingState *trackingState)
+{
+	ForwardRenderICPMaps_common(scene, view, trackingState, fwdProjPoints, fwdProjNormals, fwdProjDepth);
+}
+
+template<class TVoxel>
+void ITMVisualisationEngine_CPU<TVoxel,ITMVoxelBlockHash>::ForwardRenderICPMaps(const ITMScene<TVoxel,ITMVoxelBlockHash> *scene, const ITMView *view, ITMTrackingState *trackingState)
+{
+	ForwardRenderICPMaps_common(scene, view, trackingState, fwdProjPoints, fwdProjNormals, fwdProjDepth);
+}
+
 template class ITMLib::Engine::ITMVisualisationEngine_CPU<ITMVoxel, ITMVoxelIndex>;
@@ -11,7 +11,14 @@ namespace ITMLib
 		template<class TVoxel, class TIndex>
 		class ITMVisualisationEngine_CPU : public ITMVisualisationEngine<TVoxel,TIndex>
 		{
+		private:
+			ITMFloat4Image *fwdProjPoints, *fwdProjNormals;
+			ITMFloatImage *fwdProjDepth;
+
 		public:
+			ITMVisualisationEngine_CPU(void);
+			~ITMVisualisationEngine_CPU(void);
+
 			ITMVisualisationState* allocateInternalState(const Vector2i & imgSize)
 			{ return new ITMVisualisationState(imgSize, false); }
 
@@ -20,11 +27,18 @@ namespace ITMLib
 			void RenderImage(const ITMScene<TVoxel,TIndex> *scene, const ITMPose *pose, const ITMIntrinsics *intrinsics, const ITMVisualisationState *state, ITMUChar4Image *outputImage, bool useColour);
 			void CreatePointCloud(const ITMScene<TVoxel,TIndex> *scene, const ITMView *view, ITMTrackingState *trackingState, bool skipPoints);
 			void CreateICPMaps(const ITMScene<TVoxel,TIndex> *scene, const ITMView *view, ITMTrackingState *trackingState);
+			void CreateICPMapsWithPointNormals(const ITMScene<TVoxel,TIndex> *scene, const ITMView *view, ITMTrackingState *trackingState);
+			void CreateICPMapsSubsampled(const ITMScene<TVoxel,TIndex> *scene, const ITMView *view, ITMTrackingState *trackingState, int subsample);
+			void ForwardRenderICPMaps(const ITMScene<TVoxel,TIndex> *scene, const ITMView *view, ITMTrackingState *trackingState);
 		};
 
 		template<class TVoxel>
 		class ITMVisualisationEngine_CPU<TVoxel,ITMVoxelBlockHash> : public ITMVisualisationEngine<TVoxel,ITMVoxelBlockHash>
 		{
+		private:
+			ITMFloat4Image *fwdProjPoints, *fwdProjNormals;
+			ITMFloatImage *fwdProjDepth;
+
 		public:
 			class State : public ITMVisualisationState {
 				public:
@@ -36,14 +50,21 @@ namespace ITMLib
 				int visibleEntriesNum;
 			};
 
+			ITMVisualisationEngine_CPU(void);
+			~ITMVisualisationEngine_CPU(void);
+
 			ITMVisualisationState* allocateInternalState(const Vector2i & imgSize)
 			{ return new State(imgSize); }
 
 			void FindVisibleBlocks(const ITMScene<TVoxel,ITMVoxelBlockHash> *scene, const ITMPose *pose, const ITMIntrinsics *intrinsics, ITMVisualisationState *state);
 			void CreateExpectedDepths(const ITMScene<TVoxel,ITMVoxelBlockHash> *scene, const ITMPose *pose, const ITMIntrinsics *intrinsics, ITMFloat2Image *minmaxImg, const ITMVisualisationState *state = NULL);
 			void RenderImage(const ITMScene<TVoxel,ITMVoxelBlockHash> *scene, const ITMPose *pose, const ITMIntrinsics *intrinsics, const ITMVisualisationState *state, ITMUChar4Image *outputImage, bool useColour);
+			void RenderImages(const ITMScene<TVoxel,ITMVoxelBlockHash> *scene, int noViews, const ITMPose *poses, const ITMIntrinsics *intrinsics, ITMUChar4Image **outputImages, bool useColour);
 			void CreatePointCloud(const ITMScene<TVoxel,ITMVoxelBlockHash> *scene, const ITMView *view, ITMTrackingState *trackingState, bool skipPoints);
 			void CreateICPMaps(const ITMScene<TVoxel,ITMVoxelBlockHash> *scene, const ITMView *view, ITMTrackingState *trackingState);
+			void CreateICPMapsWithPointNormals(const ITMScene<TVoxel,ITMVoxelBlockHash> *scene, const ITMView *view, ITMTrackingState *trackingState);
+			void CreateICPMapsSubsampled(const ITMScene<TVoxel,ITMVoxelBlockHash> *scene, const ITMView *view, ITMTrackingState *trackingState, int subsample);
+			void ForwardRenderICPMaps(const ITMScene<TVoxel,ITMVoxelBlockHash> *scene, const ITMView *view, ITMTrackingState *trackingState);
 		};
 	}
 }
@@ -15,10 +15,23 @@ __global__ void colorTrackerOneLevel_g_rt_device(float *g_out, float *h_out, Vec
 __global__ void colorTrackerOneLevel_g_ro_device(float *g_out, float *h_out, Vector4f *locations, Vector4f *colours, Vector4s *gx, Vector4s *gy, Vector4u *rgb,
 	int noTotalPoints, Matrix4f M, Vector4f projParams, Vector2i imgSize);
 
+__global__ void colorTrackerOneLevel_f_intensity_device(Vector2f *out, Vector4f *locations, Vector4f *colours, uchar *intensity, int noTotalPoints,
+	Matrix4f M, Vector4f projParams, Vector2i imgSize);
+__global__ void colorTrackerOneLevel_g_intensity_device(float *g_out, float *h_out, Vector4f *locations, Vector4f *colours, Vector2s *gradients,
+	uchar *intensity, int noTotalPoints, Matrix4f M, Vector4f projParams, Vector2i imgSize, int numPara, int startPara);
+
+__global__ void colorTrackerOneLevel_j_device(float *h_out, int *noValidPoints_out, float *jacobians, int noMaxPoints, Vector4f *locations,
+	Vector4s *gx, Vector4s *gy, Vector4u *rgb, Vector2s *gradients, bool useLuminance, int noTotalPoints, Matrix4f M, Vector4f projParams,
+	Vector2i imgSize, int numPara, int startPara);
+__global__ void colorTrackerOneLevel_fj_device(Vector2f *f_out, float *g_out, const float *jacobians, int noMaxPoints, Vector4f *locations,
+	Vector4f *colours, Vector4u *rgb, uchar *intensity, bool useLuminance, int noTotalPoints, Matrix4f M, Vector4f projParams, Vector2i imgSize,
+	int numPara);
+
 // host methods
 
-ITMColorTracker_CUDA::ITMColorTracker_CUDA(Vector2i imgSize, int noHierarchyLevels, int noRotationOnlyLevels, ITMLowLevelEngine *lowLevelEngine) 
-	:ITMColorTracker(imgSize, noHierarchyLevels, noRotationOnlyLevels, lowLevelEngine, true)
+ITMColorTracker_CUDA::ITMColorTracker_CUDA(Vector2i imgSize, int noHierarchyLevels, int noRotationOnlyLevels, ITMLowLevelEngine *lowLevelEngine,
+	bool useFixedJacobians, bool useLuminance) 
+	:ITMColorTracker(imgSize, noHierarchyLevels, noRotationOnlyLevels, lowLevelEngine, useFixedJacobians, useLuminance, true)
 { 
 	int dim_g = 6;
 	int dim_h = 6 + 5 + 4 + 3 + 2 + 1;
@@ -30,6 +43,10 @@ ITMColorTracker_CUDA::ITMColorTracker_CUDA(Vector2i imgSize, int noHierarchyLeve
 	f_host = new Vector2f[imgSize.x * imgSize.y / 128];
 	g_host = new float[dim_g * imgSize.x * imgSize.y / 128];
 	h_host = new float[dim_h * imgSize.x * imgSize.y / 128];
+
+	noMaxPoints = imgSize.x * imgSize.y;
+	jacobians_device = NULL;
+	if (useFixedJacobians) ITMSafeCall(cudaMalloc((void**)&jacobians_device, sizeof(float) * 6 * (useLuminance ? 1 : 3) * noMaxPoints));
 }
 
 ITMColorTracker_CUDA::~ITMColorTracker_CUDA(void) 
@@ -37,6 +54,7 @@ ITMColorTracker_CUDA::~ITMColorTracker_CUDA(void)
 	ITMSafeCall(cudaFree(f_device));
 	ITMSafeCall(cudaFree(g_device));
 	ITMSafeCall(cudaFree(h_device));
+	if (jacobians_device != NULL) ITMSafeCall(cudaFree(jacobians_device));
 
 	delete[] f_host;
 	delete[] g_host;
@@ -53,20 +71,22 @@ void ITMColorTracker_CUDA::F_oneLevel(float *f, ITMPose *pose)
 
 	Matrix4f M = pose->M;
 
-	Vector2i imgSize = viewHierarchy->levels[levelId]->rgb->noDims;
+	Vector2i imgSize = useLuminance ? intensityHierarchy->levels[levelId]->intensity->noDims : viewHierarchy->levels[levelId]->rgb->noDims;
 
 	float scaleForOcclusions, final_f;
 
 	Vector4f *locations = trackingState->pointCloud->locations->GetData(true);
 	Vector4f *colours = trackingState->pointCloud->colours->GetData(true);
-	Vector4u *rgb = viewHierarchy->levels[levelId]->rgb->GetData(true);
+	Vector4u *rgb = useLuminance ? NULL : viewHierarchy->levels[levelId]->rgb->GetData(true);
+	uchar *intensity = useLuminance ? intensityHierarchy->levels[levelId]->intensity->GetData(true) : NULL;
 
 	dim3 blockSize(128, 1);
 	dim3 gridSize((int)ceil((float)noTotalPoints / (float)blockSize.x), 1);
 
 	ITMSafeCall(cudaMemset(f_device, 0, sizeof(Vector2f) * gridSize.x));
 
-	colorTrackerOneLevel_f_device << <gridSize, blockSize >> >(f_device, locations, colours, rgb, noTotalPoints, M, projParams, imgSize);
+	if (useLuminance) colorTrackerOneLevel_f_intensity_device << <gridSize, blockSize >> >(f_device, locations, colours, intensity, noTotalPoints, M, projParams, imgSize);
+	else colorTrackerOneLevel_f_device << <gridSize, blockSize >> >(f_device, locations, colours, rgb, noTotalPoints, M, projParams, imgSize);
 
 	ITMSafeCall(cudaMemcpy(f_host, f_device, sizeof(Vector2f)* gridSize.x, cudaMemcpyDeviceToHost));
 
@@ -89,7 +109,7 @@ void ITMColorTracker_CUDA::G_oneLevel(float *gradient, float *hessian, ITMPose *
 
 	Matrix4f M = pose->M;
 
-	Vector2i imgSize = viewHierarchy->levels[levelId]->rgb->noDims;
+	Vector2i imgSize = useLuminance ? intensityHierarchy->levels[levelId]->intensity->noDims : viewHierarchy->levels[levelId]->rgb->noDims;
 
 	float scaleForOcclusions;
 
@@ -101,14 +121,24 @@ void ITMColorTracker_CUDA::G_oneLevel(float *gradient, float *hessian, ITMPose *
 
 	Vector4f *locations = trackingState->pointCloud->locations->GetData(true);
 	Vector4f *colours = trackingState->pointCloud->colours->GetData(true);
-	Vector4u *rgb = viewHierarchy->levels[levelId]->rgb->GetData(true);
-	Vector4s *gx = viewHierarchy->levels[levelId]->gradientX_rgb->GetData(true);
-	Vector4s *gy = viewHierarchy->levels[levelId]->gradientY_rgb->GetData(true);
+	Vector4u *rgb = useLuminance ? NULL : viewHierarchy->levels[levelId]->rgb->GetData(true);
+	uchar *intensity = useLuminance ? intensityHierarchy->levels[levelId]->intensity->GetData(true) : NULL;
+	Vector4s *gx = useLuminance ? NULL : viewHierarchy->levels[levelId]->gradientX_rgb->GetData(true);
+	Vector4s *gy = useLuminance ? NULL : viewHierarchy->levels[levelId]->gradientY_rgb->GetData(true);
+	Vector2s *gradients = useLuminance ? intensityHierarchy->levels[levelId]->gradients->GetData(true) : NULL;
 
 	dim3 blockSize(128, 1);
 	dim3 gridSize((int)ceil((float)noTotalPoints / (float)blockSize.x), 1);
 
-	if (rotationOnly)
+	if (useLuminance)
+	{
+		ITMSafeCall(cudaMemset(g_device, 0, sizeof(float) * gridSize.x * numPara));
+		ITMSafeCall(cudaMemset(h_device, 0, sizeof(float) * gridSize.x * numParaSQ));
+
+		colorTrackerOneLevel_g_intensity_device << <gridSize, blockSize >> >(g_device, h_device, locations, colours, gradients, intensity, noTotalPoints,
+			M, projParams, imgSize, numPara, rotationOnly ? 3 : 0);
+	}
+	else if (rotationOnly)
 	{
 		ITMSafeCall(cudaMemset(g_device, 0, sizeof(float) * gridSize.x * 3));
 		ITMSafeCall(cudaMemset(h_device, 0, sizeof(float) * gridSize.x * 6));
@@ -148,6 +178,116 @@ void ITMColorTracker_CUDA::G_oneLevel(float *gradient, float *hessian, ITMPose *
 	}
 }
 
+void ITMColorTracker_CUDA::J_oneLevel(float *hessian, ITMPose *pose)
+{
+	int noTotalPoints = trackingState->pointCloud->noTotalPoints;
+
+	Vector4f projParams = view->calib->intrinsics_rgb.projectionParamsSimple.all;
+	projParams.x /= 1 << levelId; projParams.y /= 1 << levelId;
+	projParams.z /= 1 << levelId; projParams.w /= 1 << levelId;
+
+	Matrix4f M = pose->M;
+
+	Vector2i imgSize = useLuminance ? intensityHierarchy->levels[levelId]->intensity->noDims : viewHierarchy->levels[levelId]->rgb->noDims;
+
+	float scaleForOcclusions;
+
+	int numPara = rotationOnly ? 3 : 6, startPara = rotationOnly ? 3 : 0, numParaSQ = rotationOnly ? 3 + 2 + 1 : 6 + 5 + 4 + 3 + 2 + 1;
+
+	float globalHessian[21];
+	for (int i = 0; i < numParaSQ; i++) globalHessian[i] = 0.0f;
+
+	Vector4f *locations = trackingState->pointCloud->locations->GetData(true);
+	Vector4u *rgb = useLuminance ? NULL : viewHierarchy->levels[levelId]->rgb->GetData(true);
+	Vector4s *gx = useLuminance ? NULL : viewHierarchy->levels[levelId]->gradientX_rgb->GetData(true);
+	Vector4s *gy = useLuminance ? NULL : viewHierarchy->levels[levelId]->gradientY_rgb->GetData(true);
+	Vector2s *gradients = useLuminance ? intensityHierarchy->levels[levelId]->gradients->GetData(true) : NULL;
+
+	dim3 blockSize(128, 1);
+	dim3 gridSize((int)ceil((float)noTotalPoints / (float)blockSize.x), 1);
+
+	// the numbers of valid points of the blocks are kept in the first entries of f_device
+	int *noValidPoints_device = (int*)f_device, *noValidPoints_host = (int*)f_host;
+
+	ITMSafeCall(cudaMemset(h_device, 0, sizeof(float) * gridSize.x * numParaSQ));
+	ITMSafeCall(cudaMemset(noValidPoints_device, 0, sizeof(int) * gridSize.x));
+
+	colorTrackerOneLevel_j_device << <gridSize, blockSize >> >(h_device, noValidPoints_device, jacobians_device, noMaxPoints, locations,
+		gx, gy, rgb, gradients, useLuminance, noTotalPoints, M, projParams, imgSize, numPara, startPara);
+
+	ITMSafeCall(cudaMemcpy(h_host, h_device, sizeof(float)* gridSize.x * numParaSQ, cudaMemcpyDeviceToHost));
+	ITMSafeCall(cudaMemcpy(noValidPoints_host, noValidPoints_device, sizeof(int)* gridSize.x, cudaMemcpyDeviceToHost));
+
+	countedPoints_valid = 0;
+	for (size_t i = 0; i < gridSize.x; i++)
+	{
+		for (int p = 0; p < numParaSQ; p++) globalHessian[p] += h_host[i * numParaSQ + p];
+		countedPoints_valid += noValidPoints_host[i];
+	}
+
+	scaleForOcclusions = (float)noTotalPoints / countedPoints_valid;
+	if (countedPoints_valid == 0) { scaleForOcclusions = 1.0f; }
+
+	for (int para = 0, counter = 0; para < numPara; para++)
+	{
+		for (int col = 0; col <= para; col++, counter++) hessian[para + col * numPara] = globalHessian[counter] * scaleForOcclusions;
+	}
+	for (int row = 0; row < numPara; row++)
+	{
+		for (int col = row + 1; col < numPara; col++) hessian[row + col * numPara] = hessian[col + row * numPara];
+	}
+}
+
+void ITMColorTracker_CUDA::FJ_oneLevel(float *f, float *gradient, ITMPose *pose)
+{
+	int noTotalPoints = trackingState->pointCloud->noTotalPoints;
+
+	Vector4f projParams = view->calib->intrinsics_rgb.projectionParamsSimple.all;
+	projParams.x /= 1 << levelId; projParams.y /= 1 << levelId;
+	projParams.z /= 1 << levelId; projParams.w /= 1 << levelId;
+
+	Matrix4f M = pose->M;
+
+	Vector2i imgSize = useLuminance ? intensityHierarchy->levels[levelId]->intensity->noDims : viewHierarchy->levels[levelId]->rgb->noDims;
+
+	float scaleForOcclusions, final_f;
+
+	int numPara = rotationOnly ? 3 : 6;
+
+	float globalGradient[6];
+	for (int i = 0; i < numPara; i++) globalGradient[i] = 0.0f;
+
+	Vector4f *locations = trackingState->pointCloud->locations->GetData(true);
+	Vector4f *colours = trackingState->pointCloud->colours->GetData(true);
+	Vector4u *rgb = useLuminance ? NULL : viewHierarchy->levels[levelId]->rgb->GetData(true);
+	uchar *intensity = useLuminance ? intensityHierarchy->levels[levelId]->intensity->GetData(true) : NULL;
+
+	dim3 blockSize(128, 1);
+	dim3 gridSize((int)ceil((float)noTotalPoints / (float)blockSize.x), 1);
+
+	ITMSafeCall(cudaMemset(f_device, 0, sizeof(Vector2f) * gridSize.x));
+	ITMSafeCall(cudaMemset(g_device, 0, sizeof(float) * gridSize.x * numPara));
+
+	colorTrackerOneLevel_fj_device << <gridSize, blockSize >> >(f_device, g_device, jacobians_device, noMaxPoints, locations, colours, rgb,
+		intensity, useLuminance, noTotalPoints, M, projParams, imgSize, numPara);
+
+	ITMSafeCall(cudaMemcpy(f_host, f_device, sizeof(Vector2f)* gridSize.x, cudaMemcpyDeviceToHost));
+	ITMSafeCall(cudaMemcpy(g_host, g_device, sizeof(float)* gridSize.x * numPara, cudaMemcpyDeviceToHost));
+
+	final_f = 0; countedPoints_valid = 0;
+	for (size_t i = 0; i < gridSize.x; i++)
+	{
+		final_f += f_host[i].x; countedPoints_valid += (int)f_host[i].y;
+		for (int p = 0; p < numPara; p++) globalGradient[p] += g_host[i * numPara + p];
+	}
+
+	if (countedPoints_valid == 0) { final_f = MY_INF; scaleForOcclusions = 1.0; }
+	else { scaleForOcclusions = (float)noTotalPoints / countedPoints_valid; }
+
+	f[0] = final_f * scaleForOcclusions;
+	for (int para = 0; para < numPara; para++) gradient[para] = globalGradient[para] * scaleForOcclusions;
+}
+
 // device functions
 
 __global__ void colorTrackerOneLevel_f_device(Vector2f *out, Vector4f *locations, Vector4f *colours, Vector4u *rgb, int noTotalPoints,
@@ -321,3 +461,263 @@ __global__ void colorTrackerOneLevel_g_ro_device(float *g_out, float *h_out, Vec
 		if (threadIdx.x == 0) h_out[blockIdx.x * numParaSQ + paraId] = dim_shared[locId_local];
 	}
 }
+
+__global__ void colorTrackerOneLevel_f_intensity_device(Vector2f *out, Vector4f *locations, Vector4f *colours, uchar *intensity, int noTotalPoints,
+	Matrix4f M, Vector4f projParams, Vector2i imgSize)
+{
+	int locId_global = threadIdx.x + blockIdx.x * blockDim.x, locId_local = threadIdx.x;
+
+	__shared__ ITMLib::Vector2_<float> out_shared[128];
+
+	out_shared[locId_local].x = 0; out_shared[locId_local].y = 0;
+	__syncthreads();
+
+	if (locId_global < noTotalPoints)
+	{
+		float intensityDiffSq = getIntensityDifferenceSq(locations, colours, intensity, imgSize, locId_global, projParams, M);
+		if (intensityDiffSq >= 0)
+		{
+			out_shared[locId_local].x = intensityDiffSq;
+			out_shared[locId_local].y = 1.0f;
+		}
+	}
+
+	__syncthreads();
+
+	int sdataTargetOffset;
+	for (uint s = blockDim.x >> 1; s > 0; s >>= 1)
+	{
+		if (threadIdx.x < s)
+		{
+			sdataTargetOffset = threadIdx.x + s;
+			out_shared[locId_local].x += out_shared[sdataTargetOffset].x;
+			out_shared[locId_local].y += out_shared[sdataTargetOffset].y;
+		}
+		__syncthreads();
+	}
+
+	if (threadIdx.x == 0) out[blockIdx.x] = out_shared[0];
+}
+
+__global__ void colorTrackerOneLevel_g_intensity_device(float *g_out, float *h_out, Vector4f *locations, Vector4f *colours, Vector2s *gradients,
+	uchar *intensity, int noTotalPoints, Matrix4f M, Vector4f projParams, Vector2i imgSize, int numPara, int startPara)
+{
+	int locId_global = threadIdx.x + blockIdx.x * blockDim.x, locId_local = threadIdx.x;
+
+	__shared__ float dim_shared[128];
+
+	dim_shared[locId_local] = 0.0f;
+	__syncthreads();
+
+	float localGradient[6], localHessian[21];
+
+	int numParaSQ = numPara * (numPara + 1) / 2;
+
+	for (int i = 0; i < numPara; i++) localGradient[i] = 0.0f;
+	for (int i = 0; i < numParaSQ; i++) localHessian[i] = 0.0f;
+
+	if (locId_global < noTotalPoints)
+	{
+		computePerPointGH_rt_Intensity(localGradient, localHessian, locations, colours, intensity, imgSize, locId_global,
+			projParams, M, gradients, numPara, startPara);
+	}
+
+	for (int paraId = 0; paraId < numPara; paraId++)
+	{
+		dim_shared[locId_local] = localGradient[paraId];
+		__syncthreads();
+
+		int sdataTargetOffset;
+		for (uint s = blockDim.x >> 1; s > 32; s >>= 1)
+		{
+			if (threadIdx.x < s)
+			{
+				sdataTargetOffset = threadIdx.x + s;
+				dim_shared[locId_local] += dim_shared[sdataTargetOffset];
+			}
+			__syncthreads();
+		}
+
+		if (locId_local < 32) warpReduce(dim_shared, locId_local);
+
+		if (threadIdx.x == 0) g_out[blockIdx.x * numPara + paraId] = dim_shared[locId_local];
+		__syncthreads();
+	}
+
+	for (int paraId = 0; paraId < numParaSQ; paraId++)
+	{
+		dim_shared[locId_local] = localHessian[paraId];
+		__syncthreads();
+
+		int sdataTargetOffset;
+		for (uint s = blockDim.x >> 1; s > 32; s >>= 1)
+		{
+			if (threadIdx.x < s)
+			{
+				sdataTargetOffset = threadIdx.x + s;
+				dim_shared[locId_local] += dim_shared[sdataTargetOffset];
+			}
+			__syncthreads();
+		}
+
+		if (locId_local < 32) warpReduce(dim_shared, locId_local);
+
+		if (threadIdx.x == 0) h_out[blockIdx.x * numParaSQ + paraId] = dim_shared[locId_local];
+		__syncthreads();
+	}
+}
+
+__global__ void colorTrackerOneLevel_j_device(float *h_out, int *noValidPoints_out, float *jacobians, int noMaxPoints, Vector4f *locations,
+	Vector4s *gx, Vector4s *gy, Vector4u *rgb, Vector2s *gradients, bool useLuminance, int noTotalPoints, Matrix4f M, Vector4f projParams,
+	Vector2i imgSize, int numPara, int startPara)
+{
+	int locId_global = threadIdx.x + blockIdx.x * blockDim.x, locId_local = threadIdx.x;
+
+	__shared__ float dim_shared[128];
+
+	dim_shared[locId_local] = 0.0f;
+	__syncthreads();
+
+	Vector3f d[6];
+	float localHessian[21];
+
+	int numParaSQ = numPara * (numPara + 1) / 2;
+	bool isValidPoint = false;
+
+	for (int i = 0; i < numParaSQ; i++) localHessian[i] = 0.0f;
+
+	if (locId_global < noTotalPoints && useLuminance)
+	{
+		float d_intensity[6];
+
+		isValidPoint = computePerPointJ_rt_Intensity(d_intensity, locations, imgSize, locId_global, projParams, M, gradients, numPara, startPara);
+
+		for (int para = 0, counter = 0; para < numPara; para++)
+		{
+			if (!isValidPoint) d_intensity[para] = 0.0f;
+
+			jacobians[para * noMaxPoints + locId_global] = d_intensity[para];
+
+			for (int col = 0; col <= para; col++, counter++) localHessian[counter] = 2.0f * d_intensity[para] * d_intensity[col];
+		}
+	}
+	else if (locId_global < noTotalPoints)
+	{
+		isValidPoint = computePerPointJ_rt_Color(d, locations, rgb, imgSize, locId_global, projParams, M, gx, gy, numPara, startPara);
+
+		for (int para = 0, counter = 0; para < numPara; para++)
+		{
+			if (!isValidPoint) d[para] = Vector3f(0.0f);
+
+			jacobians[(para * 3 + 0) * noMaxPoints + locId_global] = d[para].x;
+			jacobians[(para * 3 + 1) * noMaxPoints + locId_global] = d[para].y;
+			jacobians[(para * 3 + 2) * noMaxPoints + locId_global] = d[para].z;
+
+			for (int col = 0; col <= para; col++, counter++)
+				localHessian[counter] = 2.0f * (d[para].x * d[col].x + d[para].y * d[col].y + d[para].z * d[col].z);
+		}
+	}
+
+	for (int paraId = 0; paraId < numParaSQ; paraId++)
+	{
+		dim_shared[locId_local] = localHessian[paraId];
+		__syncthreads();
+
+		int sdataTargetOffset;
+		for (uint s = blockDim.x >> 1; s > 32; s >>= 1)
+		{
+			if (threadIdx.x < s)
+			{
+				sdataTargetOffset = threadIdx.x + s;
+				dim_shared[locId_local] += dim_shared[sdataTargetOffset];
+			}
+			__syncthreads();
+		}
+
+		if (locId_local < 32) warpReduce(dim_shared, locId_local);
+
+		if (threadIdx.x == 0) h_out[blockIdx.x * numParaSQ + paraId] = dim_shared[locId_local];
+		__syncthreads();
+	}
+
+	dim_shared[locId_local] = isValidPoint ? 1.0f : 0.0f;
+	__syncthreads();
+
+	for (uint s = blockDim.x >> 1; s > 32; s >>= 1)
+	{
+		if (threadIdx.x < s) dim_shared[locId_local] += dim_shared[threadIdx.x + s];
+		__syncthreads();
+	}
+
+	if (locId_local < 32) warpReduce(dim_shared, locId_local);
+
+	if (threadIdx.x == 0) noValidPoints_out[blockIdx.x] = (int)dim_shared[locId_local];
+}
+
+__global__ void colorTrackerOneLevel_fj_device(Vector2f *f_out, float *g_out, const float *jacobians, int noMaxPoints, Vector4f *locations,
+	Vector4f *colours, Vector4u *rgb, uchar *intensity, bool useLuminance, int noTotalPoints, Matrix4f M, Vector4f projParams, Vector2i imgSize,
+	int numPara)
+{
+	int locId_global = threadIdx.x + blockIdx.x * blockDim.x, locId_local = threadIdx.x;
+
+	__shared__ float dim_shared[128];
+	__shared__ ITMLib::Vector2_<float> out_shared[128];
+
+	out_shared[locId_local].x = 0; out_shared[locId_local].y = 0;
+	dim_shared[locId_local] = 0.0f;
+	__syncthreads();
+
+	float localGradient[6];
+	for (int i = 0; i < numPara; i++) localGradient[i] = 0.0f;
+
+	if (locId_global < noTotalPoints)
+	{
+		float colorDiffSq = useLuminance ?
+			computePerPointG_fixedJ_Intensity(localGradient, locations, colours, intensity, imgSize, locId_global, projParams, M, jacobians, noMaxPoints, numPara) :
+			computePerPointG_fixedJ_Color(localGradient, locations, colours, rgb, imgSize, locId_global, projParams, M, jacobians, noMaxPoints, numPara);
+
+		if (colorDiffSq >= 0)
+		{
+			out_shared[locId_local].x = colorDiffSq;
+			out_shared[locId_local].y = 1.0f;
+		}
+		else for (int i = 0; i < numPara; i++) localGradient[i] = 0.0f;
+	}
+
+	__syncthreads();
+
+	int sdataTargetOffset;
+	for (uint s = blockDim.x >> 1; s > 0; s >>= 1)
+	{
+		if (threadIdx.x < s)
+		{
+			sdataTargetOffset = threadIdx.x + s;
+			out_shared[locId_local].x += out_shared[sdataTargetOffset].x;
+			out_shared[locId_local].y += out_shared[sdataTargetOffset].y;
+		}
+		__syncthreads();
+	}
+
+	if (threadIdx.x == 0) f_out[blockIdx.x] = out_shared[0];
+
+	for (int paraId = 0; paraId < numPara; paraId++)
+	{
+		dim_shared[locId_local] = localGradient[paraId];
+		__syncthreads();
+
+		for (uint s = blockDim.x >> 1; s > 32; s >>= 1)
+		{
+			if (threadIdx.x < s)
+			{
+				sdataTargetOffset = threadIdx.x + s;
+				dim_shared[locId_local] += dim_shared[sdataTargetOffset];
+			}
+			__syncthreads();
+		}
+
+		if (locId_local < 32) warpReduce(dim_shared, locId_local);
+
+		if (threadIdx.x == 0) g_out[blockIdx.x * numPara + paraId] = dim_shared[locId_local];
+		__syncthreads();
+	}
+}
@@ -14,12 +14,19 @@ namespace ITMLib
 			Vector2f *f_device; float *g_device, *h_device;
 			Vector2f *f_host; float *g_host, *h_host;
 
+			/// For the fixed Jacobians variant: derivatives of the colours of the points, stored as
+			/// numPara x 3 arrays of noMaxPoints entries, or numPara for the luminance
+			float *jacobians_device;
+			int noMaxPoints;
+
 		public:
 			void F_oneLevel(float *f, ITMPose *pose);
 			void G_oneLevel(float *gradient, float *hessian, ITMPose *pose) const;
+			void J_oneLevel(float *hessian, ITMPose *pose);
+			void FJ_oneLevel(float *f, float *gradient, ITMPose *pose);
 
 			ITMColorTracker_CUDA(Vector2i imgSize, int noHierarchyLevels, int noRotationOnlyLevels,
-				ITMLowLevelEngine *lowLevelEngine);
+				ITMLowLevelEngine *lowLevelEngine, bool useFixedJacobians, bool useLuminance);
 			~ITMColorTracker_CUDA(void);
 		};
 	}
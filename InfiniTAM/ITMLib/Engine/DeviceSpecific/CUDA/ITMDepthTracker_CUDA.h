@@ -11,16 +11,16 @@ namespace ITMLib
 		class ITMDepthTracker_CUDA : public ITMDepthTracker
 		{
 		private:
-			int *na_device; float *g_device, *h_device;
-			int *na_host; float *g_host, *h_host;
+			int *na_device; float *f_device, *g_device, *h_device;
+			int *na_host; float *f_host_blocks, *g_host, *h_host;
 
 		protected:
-			void ChangeIgnorePixelToZero(ITMFloatImage *image);
-			int ComputeGandH(ITMSceneHierarchyLevel *sceneHierarchyLevel, ITMTemplatedHierarchyLevel<ITMFloatImage> *viewHierarchyLevel,
+			int ComputeGandH(ITMSceneHierarchyLevel *sceneHierarchyLevel, const ITMDepthPyramidLevel *viewLevel,
 				Matrix4f approxInvPose, Matrix4f imagePose, bool rotationOnly);
 
 		public:
-			ITMDepthTracker_CUDA(Vector2i imgSize, int noHierarchyLevels, int noRotationOnlyLevels, int noICPRunTillLevel, float distThresh, ITMLowLevelEngine *lowLevelEngine);
+			ITMDepthTracker_CUDA(Vector2i imgSize, int noHierarchyLevels, int noRotationOnlyLevels, int noICPRunTillLevel, float distThresh,
+				const int *noIterationsPerLevel, float stepThreshold, float residualThreshold, int minNoInliers, ITMLowLevelEngine *lowLevelEngine);
 			~ITMDepthTracker_CUDA(void);
 		};
 	}
@@ -2,25 +2,47 @@
 
 #include "ITMLowLevelEngine_CUDA.h"
 #include "ITMCUDADefines.h"
+#include "ITMCUDAUtils.h"
 
 #include "../../DeviceAgnostic/ITMLowLevelEngine.h"
 
 using namespace ITMLib::Engine;
 
-ITMLowLevelEngine_CUDA::ITMLowLevelEngine_CUDA(void) { }
-ITMLowLevelEngine_CUDA::~ITMLowLevelEngine_CUDA(void) { }
+ITMLowLevelEngine_CUDA::ITMLowLevelEngine_CUDA(void) : ITMLowLevelEngine(true)
+{
+	noValidDepths_device = NULL; noValidDepths_host = NULL; noValidDepthsSize = 0;
+}
+
+ITMLowLevelEngine_CUDA::~ITMLowLevelEngine_CUDA(void)
+{
+	if (noValidDepths_device != NULL) ITMSafeCall(cudaFree(noValidDepths_device));
+	if (noValidDepths_host != NULL) delete[] noValidDepths_host;
+}
 
 __global__ void convertDisparityToDepth_device(float *depth_out, const short *depth_in, Vector2f disparityCalibParams, float fx_depth, Vector2i imgSize);
 
 __global__ void convertDepthMMToFloat_device(float *d_out, const short *d_in, Vector2i imgSize);
 
 __global__ void filterSubsample_device(Vector4u *imageData_out, Vector2i newDims, const Vector4u *imageData_in, Vector2i oldDims);
+__global__ void filterSubsample_device(uchar *imageData_out, Vector2i newDims, const uchar *imageData_in, Vector2i oldDims);
 
 __global__ void filterSubsampleWithHoles_device(float *imageData_out, Vector2i newDims, const float *imageData_in, Vector2i oldDims);
 __global__ void filterSubsampleWithHoles_device(Vector4f *imageData_out, Vector2i newDims, const Vector4f *imageData_in, Vector2i oldDims);
+__global__ void filterSubsampleNormalsWithHoles_device(Vector4f *normals_out, Vector2i newDims, const Vector4f *normals_in, Vector2i oldDims);
 
 __global__ void gradientX_device(Vector4s *grad, const Vector4u *image, Vector2i imgSize);
 __global__ void gradientY_device(Vector4s *grad, const Vector4u *image, Vector2i imgSize);
+__global__ void gradient_device(Vector2s *grad, const uchar *image, Vector2i imgSize);
+
+__global__ void convertColourToIntensity_device(uchar *intensity, const Vector4u *rgb, Vector2i imgSize);
+
+__global__ void unprojectDepthToWorld_device(Vector4f *pointsMap, const float *depth, Vector2i imgSize, Vector4f intrinsics, Matrix4f invM);
+__global__ void computeNormalFromPointsMap_device(Vector4f *normalsMap, const Vector4f *pointsMap, Vector2i imgSize, float maxDist);
+
+__global__ void unprojectDepthToCamera_device(int *noValidDepths, Vector4f *points, float *depth, Vector2i imgSize, Vector4f intrinsics);
+__global__ void convertDepthToPyramid_device(int *noValidDepths, float *d_out, const short *d_in, bool isDisparity, Vector2f disparityCalibParams,
+	float fx_depth, float *depth_0, Vector4f *points_0, Vector2i imgSize_0, Vector4f intrinsics_0, float *depth_1, Vector4f *points_1, Vector2i imgSize_1,
+	Vector4f intrinsics_1);
 
 // host methods
 
@@ -64,6 +86,22 @@ void ITMLowLevelEngine_CUDA::FilterSubsample(ITMUChar4Image *image_out, const IT
 	filterSubsample_device << <gridSize, blockSize >> >(imageData_out, newDims, imageData_in, oldDims);
 }
 
+void ITMLowLevelEngine_CUDA::FilterSubsample(ITMUCharImage *image_out, const ITMUCharImage *image_in)
+{
+	Vector2i oldDims = image_in->noDims;
+	Vector2i newDims; newDims.x = image_in->noDims.x / 2; newDims.y = image_in->noDims.y / 2;
+
+	image_out->ChangeDims(newDims);
+
+	const uchar *imageData_in = image_in->GetData(true);
+	uchar *imageData_out = image_out->GetData(true);
+
+	dim3 blockSize(16, 16);
+	dim3 gridSize((int)ceil((float)newDims.x / (float)blockSize.x), (int)ceil((float)newDims.y / (float)blockSize.y));
+
+	filterSubsample_device << <gridSize, blockSize >> >(imageData_out, newDims, imageData_in, oldDims);
+}
+
 void ITMLowLevelEngine_CUDA::FilterSubsampleWithHoles(ITMFloatImage *image_out, const ITMFloatImage *image_in)
 {
 	Vector2i oldDims = image_in->noDims;
@@ -96,6 +134,22 @@ void ITMLowLevelEngine_CUDA::FilterSubsampleWithHoles(ITMFloat4Image *image_out,
 	filterSubsampleWithHoles_device << <gridSize, blockSize >> >(imageData_out, newDims, imageData_in, oldDims);
 }
 
+void ITMLowLevelEngine_CUDA::FilterSubsampleNormalsWithHoles(ITMFloat4Image *normals_out, const ITMFloat4Image *normals_in)
+{
+	Vector2i oldDims = normals_in->noDims;
+	Vector2i newDims; newDims.x = normals_in->noDims.x / 2; newDims.y = normals_in->noDims.y / 2;
+
+	normals_out->ChangeDims(newDims);
+
+	const Vector4f *imageData_in = normals_in->GetData(true);
+	Vector4f *imageData_out = normals_out->GetData(true);
+
+	dim3 blockSize(16, 16);
+	dim3 gridSize((int)ceil((float)newDims.x / (float)blockSize.x), (int)ceil((float)newDims.y / (float)blockSize.y));
+
+	filterSubsampleNormalsWithHoles_device << <gridSize, blockSize >> >(imageData_out, newDims, imageData_in, oldDims);
+}
+
 void ITMLowLevelEngine_CUDA::GradientX(ITMShort4Image *grad_out, const ITMUChar4Image *image_in)
 {
 	grad_out->ChangeDims(image_in->noDims);
@@ -128,6 +182,36 @@ void ITMLowLevelEngine_CUDA::GradientY(ITMShort4Image *grad_out, const ITMUChar4
 	gradientY_device << <gridSize, blockSize >> >(grad, image, imgSize);
 }
 
+void ITMLowLevelEngine_CUDA::Gradient(ITMShort2Image *grad_out, const ITMUCharImage *image_in)
+{
+	grad_out->ChangeDims(image_in->noDims);
+	Vector2i imgSize = image_in->noDims;
+
+	Vector2s *grad = grad_out->GetData(true);
+	const uchar *image = image_in->GetData(true);
+
+	dim3 blockSize(16, 16);
+	dim3 gridSize((int)ceil((float)imgSize.x / (float)blockSize.x), (int)ceil((float)imgSize.y / (float)blockSize.y));
+
+	ITMSafeCall(cudaMemset(grad, 0, imgSize.x * imgSize.y * sizeof(Vector2s)));
+
+	gradient_device << <gridSize, blockSize >> >(grad, image, imgSize);
+}
+
+void ITMLowLevelEngine_CUDA::ConvertColourToIntensity(ITMUCharImage *image_out, const ITMUChar4Image *image_in)
+{
+	image_out->ChangeDims(image_in->noDims);
+	Vector2i imgSize = image_in->noDims;
+
+	uchar *intensity = image_out->GetData(true);
+	const Vector4u *rgb = image_in->GetData(true);
+
+	dim3 blockSize(16, 16);
+	dim3 gridSize((int)ceil((float)imgSize.x / (float)blockSize.x), (int)ceil((float)imgSize.y / (float)blockSize.y));
+
+	convertColourToIntensity_device << <gridSize, blockSize >> >(intensity, rgb, imgSize);
+}
+
 void ITMLowLevelEngine_CUDA::ConvertDisparityToDepth(ITMFloatImage *depth_out, const ITMShortImage *depth_in, const ITMIntrinsics *depthIntrinsics,
 	const ITMDisparityCalib *disparityCalib)
 {
@@ -160,6 +244,99 @@ void ITMLowLevelEngine_CUDA::ConvertDepthMMToFloat(ITMFloatImage *depth_out, con
 	convertDepthMMToFloat_device << <gridSize, blockSize >> >(d_out, d_in, imgSize);
 }
 
+void ITMLowLevelEngine_CUDA::CreateICPMapsFromDepth(ITMFloat4Image *pointsMap, ITMFloat4Image *normalsMap, const ITMFloatImage *depth, Vector4f intrinsics,
+	const Matrix4f & invM, float maxNormalDist)
+{
+	Vector2i imgSize = depth->noDims;
+
+	const float *d_in = depth->GetData(true);
+	Vector4f *points = pointsMap->GetData(true);
+	Vector4f *normals = normalsMap->GetData(true);
+
+	dim3 blockSize(16, 16);
+	dim3 gridSize((int)ceil((float)imgSize.x / (float)blockSize.x), (int)ceil((float)imgSize.y / (float)blockSize.y));
+
+	unprojectDepthToWorld_device << <gridSize, blockSize >> >(points, d_in, imgSize, intrinsics, invM);
+	computeNormalFromPointsMap_device << <gridSize, blockSize >> >(normals, points, imgSize, maxNormalDist);
+}
+
+int ITMLowLevelEngine_CUDA::UnprojectDepth(ITMFloat4Image *points, ITMFloatImage *depth, Vector4f intrinsics)
+{
+	Vector2i imgSize = depth->noDims;
+
+	points->ChangeDims(imgSize);
+
+	float *d_in = depth->GetData(true);
+	Vector4f *pts_out = points->GetData(true);
+
+	dim3 blockSize(16, 16);
+	dim3 gridSize((int)ceil((float)imgSize.x / (float)blockSize.x), (int)ceil((float)imgSize.y / (float)blockSize.y));
+
+	int gridSizeTotal = gridSize.x * gridSize.y;
+
+	AllocateNoValidDepths(gridSizeTotal);
+
+	unprojectDepthToCamera_device << <gridSize, blockSize >> >(noValidDepths_device, pts_out, d_in, imgSize, intrinsics);
+
+	ITMSafeCall(cudaMemcpy(noValidDepths_host, noValidDepths_device, sizeof(int) * gridSizeTotal, cudaMemcpyDeviceToHost));
+
+	int noValidDepths = 0;
+	for (int i = 0; i < gridSizeTotal; i++) noValidDepths += noValidDepths_host[i];
+
+	return noValidDepths;
+}
+
+void ITMLowLevelEngine_CUDA::AllocateNoValidDepths(int size)
+{
+	// the per block counts are kept for the finest level, which needs the most
+	if (size <= noValidDepthsSize) return;
+
+	if (noValidDepths_device != NULL) ITMSafeCall(cudaFree(noValidDepths_device));
+	if (noValidDepths_host != NULL) delete[] noValidDepths_host;
+
+	ITMSafeCall(cudaMalloc((void**)&noValidDepths_device, sizeof(int) * size));
+	noValidDepths_host = new int[size];
+	noValidDepthsSize = size;
+}
+
+int ITMLowLevelEngine_CUDA::ConvertDepthToPyramid(ITMFloatImage *depth_out, const ITMShortImage *depth_in, const ITMIntrinsics *depthIntrinsics,
+	const ITMDisparityCalib *disparityCalib, ITMDepthPyramid *pyramid, int noLevels)
+{
+	ITMDepthPyramidLevel *level_0 = pyramid->levels[0], *level_1 = noLevels > 1 ? pyramid->levels[1] : NULL;
+
+	Vector2i imgSize_0 = level_0->depth->noDims, imgSize_1 = level_1 != NULL ? level_1->depth->noDims : Vector2i(0, 0);
+
+	const short *d_in = depth_in->GetData(true);
+	float *d_out = depth_out->GetData(true);
+
+	Vector2f disparityCalibParams(0.0f, 0.0f);
+	if (disparityCalib != NULL) { disparityCalibParams.x = disparityCalib->params.x; disparityCalibParams.y = disparityCalib->params.y; }
+	float fx_depth = depthIntrinsics->projectionParamsSimple.fx;
+
+	// one thread per pixel of the second level, which converts and back projects the 2x2 pixels of the first level it is subsampled from
+	dim3 blockSize(16, 16);
+	dim3 gridSize((int)ceil((float)imgSize_0.x / (2.0f * blockSize.x)), (int)ceil((float)imgSize_0.y / (2.0f * blockSize.y)));
+
+	int gridSizeTotal = gridSize.x * gridSize.y;
+
+	AllocateNoValidDepths(2 * gridSizeTotal);
+
+	convertDepthToPyramid_device << <gridSize, blockSize >> >(noValidDepths_device, d_out, d_in, disparityCalib != NULL, disparityCalibParams, fx_depth,
+		level_0->depth->GetData(true), level_0->points->GetData(true), imgSize_0, level_0->intrinsics,
+		level_1 != NULL ? level_1->depth->GetData(true) : NULL, level_1 != NULL ? level_1->points->GetData(true) : NULL, imgSize_1,
+		level_1 != NULL ? level_1->intrinsics : Vector4f(0.0f, 0.0f, 0.0f, 0.0f));
+
+	ITMSafeCall(cudaMemcpy(noValidDepths_host, noValidDepths_device, sizeof(int) * 2 * gridSizeTotal, cudaMemcpyDeviceToHost));
+
+	int noValidDepths_0 = 0, noValidDepths_1 = 0;
+	for (int i = 0; i < gridSizeTotal; i++) { noValidDepths_0 += noValidDepths_host[i]; noValidDepths_1 += noValidDepths_host[gridSizeTotal + i]; }
+
+	level_0->noValidDepths = noValidDepths_0;
+	if (level_1 != NULL) level_1->noValidDepths = noValidDepths_1;
+
+	return level_1 != NULL ? 2 : 1;
+}
+
 // device functions
 
 __global__ void convertDisparityToDepth_device(float *d_out, const short *d_in, Vector2f disparityCalibParams, float fx_depth, Vector2i imgSize)
@@ -191,6 +368,15 @@ __global__ void filterSubsample_device(Vector4u *imageData_out, Vector2i newDims
 	filterSubsample(imageData_out, x, y, newDims, imageData_in, oldDims);
 }
 
+__global__ void filterSubsample_device(uchar *imageData_out, Vector2i newDims, const uchar *imageData_in, Vector2i oldDims)
+{
+	int x = threadIdx.x + blockIdx.x * blockDim.x, y = threadIdx.y + blockIdx.y * blockDim.y;
+
+	if (x > newDims.x - 1 || y > newDims.y - 1) return;
+
+	filterSubsample(imageData_out, x, y, newDims, imageData_in, oldDims);
+}
+
 __global__ void filterSubsampleWithHoles_device(float *imageData_out, Vector2i newDims, const float *imageData_in, Vector2i oldDims)
 {
 	int x = threadIdx.x + blockIdx.x * blockDim.x, y = threadIdx.y + blockIdx.y * blockDim.y;
@@ -209,6 +395,15 @@ __global__ void filterSubsampleWithHoles_device(Vector4f *imageData_out, Vector2
 	filterSubsampleWithHoles(imageData_out, x, y, newDims, imageData_in, oldDims);
 }
 
+__global__ void filterSubsampleNormalsWithHoles_device(Vector4f *normals_out, Vector2i newDims, const Vector4f *normals_in, Vector2i oldDims)
+{
+	int x = threadIdx.x + blockIdx.x * blockDim.x, y = threadIdx.y + blockIdx.y * blockDim.y;
+
+	if (x > newDims.x - 1 || y > newDims.y - 1) return;
+
+	filterSubsampleNormalsWithHoles(normals_out, x, y, newDims, normals_in, oldDims);
+}
+
 __global__ void gradientX_device(Vector4s *grad, const Vector4u *image, Vector2i imgSize)
 {
 	int x = threadIdx.x + blockIdx.x * blockDim.x, y = threadIdx.y + blockIdx.y * blockDim.y;
@@ -226,3 +421,115 @@ __global__ void gradientY_device(Vector4s *grad, const Vector4u *image, Vector2i
 
 	gradientY(grad, x, y, image, imgSize);
 }
+
+__global__ void gradient_device(Vector2s *grad, const uchar *image, Vector2i imgSize)
+{
+	int x = threadIdx.x + blockIdx.x * blockDim.x, y = threadIdx.y + blockIdx.y * blockDim.y;
+
+	if (x < 1 || x > imgSize.x - 2 || y < 1 || y > imgSize.y - 2) return;
+
+	gradient(grad, x, y, image, imgSize);
+}
+
+__global__ void convertColourToIntensity_device(uchar *intensity, const Vector4u *rgb, Vector2i imgSize)
+{
+	int x = threadIdx.x + blockIdx.x * blockDim.x, y = threadIdx.y + blockIdx.y * blockDim.y;
+
+	if (x > imgSize.x - 1 || y > imgSize.y - 1) return;
+
+	convertColourToIntensity(intensity, x, y, rgb, imgSize);
+}
+
+__global__ void unprojectDepthToWorld_device(Vector4f *pointsMap, const float *depth, Vector2i imgSize, Vector4f intrinsics, Matrix4f invM)
+{
+	int x = threadIdx.x + blockIdx.x * blockDim.x;
+	int y = threadIdx.y + blockIdx.y * blockDim.y;
+
+	if ((x >= imgSize.x) || (y >= imgSize.y)) return;
+
+	unprojectDepthToWorld(pointsMap, x, y, depth, imgSize, intrinsics, invM);
+}
+
+__global__ void computeNormalFromPointsMap_device(Vector4f *normalsMap, const Vector4f *pointsMap, Vector2i imgSize, float maxDist)
+{
+	int x = threadIdx.x + blockIdx.x * blockDim.x;
+	int y = threadIdx.y + blockIdx.y * blockDim.y;
+
+	if ((x >= imgSize.x) || (y >= imgSize.y)) return;
+
+	computeNormalFromPointsMap(x, y, pointsMap, normalsMap, imgSize, maxDist);
+}
+
+__global__ void unprojectDepthToCamera_device(int *noValidDepths, Vector4f *points, float *depth, Vector2i imgSize, Vector4f intrinsics)
+{
+	int x = threadIdx.x + blockIdx.x * blockDim.x, y = threadIdx.y + blockIdx.y * blockDim.y;
+
+	int locId_local = threadIdx.x + threadIdx.y * blockDim.x;
+	int blockId_global = blockIdx.x + blockIdx.y * gridDim.x;
+	__shared__ float dim_shared[256];
+
+	bool isValidDepth = false;
+
+	if (x < imgSize.x && y < imgSize.y) isValidDepth = unprojectDepthToCamera(points, x, y, depth, imgSize, intrinsics);
+
+	dim_shared[locId_local] = isValidDepth;
+	__syncthreads();
+
+	if (locId_local < 128) dim_shared[locId_local] += dim_shared[locId_local + 128];
+	__syncthreads();
+	if (locId_local < 64) dim_shared[locId_local] += dim_shared[locId_local + 64];
+	__syncthreads();
+
+	if (locId_local < 32) warpReduce(dim_shared, locId_local);
+
+	if (locId_local == 0) noValidDepths[blockId_global] = (int)dim_shared[locId_local];
+}
+
+__global__ void convertDepthToPyramid_device(int *noValidDepths, float *d_out, const short *d_in, bool isDisparity, Vector2f disparityCalibParams,
+	float fx_depth, float *depth_0, Vector4f *points_0, Vector2i imgSize_0, Vector4f intrinsics_0, float *depth_1, Vector4f *points_1, Vector2i imgSize_1,
+	Vector4f intrinsics_1)
+{
+	int x_1 = threadIdx.x + blockIdx.x * blockDim.x, y_1 = threadIdx.y + blockIdx.y * blockDim.y;
+
+	int locId_local = threadIdx.x + threadIdx.y * blockDim.x;
+	int blockId_global = blockIdx.x + blockIdx.y * gridDim.x, noBlocks = gridDim.x * gridDim.y;
+	__shared__ float dim_shared[256];
+
+	int noValidDepths_0 = 0;
+	bool isValidDepth_1 = false;
+
+	for (int i = 0; i < 4; i++)
+	{
+		int x = 2 * x_1 + (i & 1), y = 2 * y_1 + (i >> 1);
+		if (x >= imgSize_0.x || y >= imgSize_0.y) continue;
+
+		if (isDisparity) convertDisparityToDepth(d_out, x, y, d_in, disparityCalibParams, fx_depth, imgSize_0);
+		else convertDepthMMToFloat(d_out, x, y, d_in, imgSize_0);
+
+		depth_0[x + y * imgSize_0.x] = d_out[x + y * imgSize_0.x];
+		noValidDepths_0 += unprojectDepthToCamera(points_0, x, y, depth_0, imgSize_0, intrinsics_0);
+	}
+
+	// the 2x2 pixels were all written by this thread
+	if (x_1 < imgSize_1.x && y_1 < imgSize_1.y)
+	{
+		filterSubsampleWithHoles(depth_1, x_1, y_1, imgSize_1, depth_0, imgSize_0);
+		isValidDepth_1 = unprojectDepthToCamera(points_1, x_1, y_1, depth_1, imgSize_1, intrinsics_1);
+	}
+
+	for (int levelId = 0; levelId < 2; levelId++)
+	{
+		dim_shared[locId_local] = levelId == 0 ? (float)noValidDepths_0 : (float)isValidDepth_1;
+		__syncthreads();
+
+		if (locId_local < 128) dim_shared[locId_local] += dim_shared[locId_local + 128];
+		__syncthreads();
+		if (locId_local < 64) dim_shared[locId_local] += dim_shared[locId_local + 64];
+		__syncthreads();
+
+		if (locId_local < 32) warpReduce(dim_shared, locId_local);
+
+		if (locId_local == 0) noValidDepths[levelId * noBlocks + blockId_global] = (int)dim_shared[locId_local];
+		__syncthreads();
+	}
+}
@@ -10,22 +10,43 @@ namespace ITMLib
 	{
 		class ITMLowLevelEngine_CUDA : public ITMLowLevelEngine
 		{
+		private:
+			int *noValidDepths_device, *noValidDepths_host;
+			int noValidDepthsSize;
+
+			/// Makes sure that the buffers for the per block counts of valid depths hold at least @p size counts.
+			void AllocateNoValidDepths(int size);
+
+		protected:
+			int ConvertDepthToPyramid(ITMFloatImage *depth_out, const ITMShortImage *depth_in, const ITMIntrinsics *depthIntrinsics,
+				const ITMDisparityCalib *disparityCalib, ITMDepthPyramid *pyramid, int noLevels);
+
 		public:
 			void CopyImage(ITMUChar4Image *image_out, const ITMUChar4Image *image_in);
 			void CopyImage(ITMFloatImage *image_out, const ITMFloatImage *image_in);
 			void CopyImage(ITMFloat4Image *image_out, const ITMFloat4Image *image_in);
 
 			void FilterSubsample(ITMUChar4Image *image_out, const ITMUChar4Image *image_in);
+			void FilterSubsample(ITMUCharImage *image_out, const ITMUCharImage *image_in);
 			void FilterSubsampleWithHoles(ITMFloatImage *image_out, const ITMFloatImage *image_in);
 			void FilterSubsampleWithHoles(ITMFloat4Image *image_out, const ITMFloat4Image *image_in);
+			void FilterSubsampleNormalsWithHoles(ITMFloat4Image *normals_out, const ITMFloat4Image *normals_in);
 
 			void GradientX(ITMShort4Image *grad_out, const ITMUChar4Image *image_in);
 			void GradientY(ITMShort4Image *grad_out, const ITMUChar4Image *image_in);
+			void Gradient(ITMShort2Image *grad_out, const ITMUCharImage *image_in);
+
+			void ConvertColourToIntensity(ITMUCharImage *image_out, const ITMUChar4Image *image_in);
 
 			void ConvertDisparityToDepth(ITMFloatImage *depth_out, const ITMShortImage *depth_in, const ITMIntrinsics *depthIntrinsics, 
 				const ITMDisparityCalib *disparityCalib);
 			void ConvertDepthMMToFloat(ITMFloatImage *depth_out, const ITMShortImage *depth_in);
 
+			void CreateICPMapsFromDepth(ITMFloat4Image *pointsMap, ITMFloat4Image *normalsMap, const ITMFloatImage *depth, Vector4f intrinsics,
+				const Matrix4f & invM, float maxNormalDist);
+
+			int UnprojectDepth(ITMFloat4Image *points, ITMFloatImage *depth, Vector4f intrinsics);
+
 			ITMLowLevelEngine_CUDA(void);
 			~ITMLowLevelEngine_CUDA(void);
 		};
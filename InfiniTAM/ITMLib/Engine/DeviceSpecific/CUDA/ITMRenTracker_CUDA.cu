@@ -6,8 +6,6 @@
 
 using namespace ITMLib::Engine;
 
-__global__ void unprojectDepthToCam_device(Vector4f *camPoints, float *depthMap, Vector2i imgSize, Vector4f ooIntrinsics);
-
 template<class TVoxel, class TIndex>
 __global__ void renTrackerOneLevel_f_device(float *f_device, Vector4f *ptList, int count, const TVoxel *voxelBlocks,
 	const typename TIndex::IndexData *index, float oneOverVoxelSize, Matrix4f invM);
@@ -50,7 +48,7 @@ ITMRenTracker_CUDA<TVoxel,TIndex>::~ITMRenTracker_CUDA(void)
 template<class TVoxel, class TIndex>
 void ITMRenTracker_CUDA<TVoxel,TIndex>::F_oneLevel(float *f, Matrix4f invM)
 {
-	int count = this->viewHierarchy->levels[this->levelId]->depth->dataSize;
+	int count = this->depthPyramid->levels[this->levelId]->points->dataSize;
 
 	dim3 blockSize(256, 1);
 	dim3 gridSize((int)ceil((float)count / (float)blockSize.x), 1);
@@ -61,8 +59,8 @@ void ITMRenTracker_CUDA<TVoxel,TIndex>::F_oneLevel(float *f, Matrix4f invM)
 
 	ITMSafeCall(cudaMemset(f_device, 0, sizeof(float) * gridSize.x));
 
-	renTrackerOneLevel_f_device<TVoxel,TIndex> << <gridSize, blockSize >> >(f_device, this->viewHierarchy->levels[this->levelId]->depth->GetData(true), 
-		this->viewHierarchy->levels[this->levelId]->depth->dataSize, voxelBlocks, index, oneOverVoxelSize, invM);
+	renTrackerOneLevel_f_device<TVoxel,TIndex> << <gridSize, blockSize >> >(f_device, this->depthPyramid->levels[this->levelId]->points->GetData(true), 
+		count, voxelBlocks, index, oneOverVoxelSize, invM);
 
 	ITMSafeCall(cudaMemcpy(f_host, f_device, sizeof(float)* gridSize.x, cudaMemcpyDeviceToHost));
 
@@ -75,8 +73,8 @@ void ITMRenTracker_CUDA<TVoxel,TIndex>::F_oneLevel(float *f, Matrix4f invM)
 template<class TVoxel, class TIndex>
 void ITMRenTracker_CUDA<TVoxel,TIndex>::G_oneLevel(float *gradient, float *hessian, Matrix4f invM) const
 {
-	int count = this->viewHierarchy->levels[this->levelId]->depth->dataSize;
-	Vector4f *ptList = this->viewHierarchy->levels[this->levelId]->depth->GetData(true);
+	int count = this->depthPyramid->levels[this->levelId]->points->dataSize;
+	Vector4f *ptList = this->depthPyramid->levels[this->levelId]->points->GetData(true);
 
 	const TVoxel *voxelBlocks = this->scene->localVBA.GetVoxelBlocks();
 	const typename TIndex::IndexData *index = this->scene->index.getIndexData();
@@ -118,46 +116,8 @@ void ITMRenTracker_CUDA<TVoxel,TIndex>::G_oneLevel(float *gradient, float *hessi
 	//getchar();
 }
 
-template<class TVoxel, class TIndex>
-void ITMRenTracker_CUDA<TVoxel,TIndex>::UnprojectDepthToCam(ITMFloatImage *depth, ITMFloat4Image *upPtCloud, const Vector4f &intrinsic)
-{
-	float *depthMap = depth->GetData(true);
-	Vector4f *camPoints = upPtCloud->GetData(true);
-
-	Vector4f ooIntrinsics;
-	ooIntrinsics.x = 1.0f / intrinsic.x; ooIntrinsics.y = 1.0f / intrinsic.y;
-	ooIntrinsics.z = -intrinsic.z * ooIntrinsics.x; ooIntrinsics.w = -intrinsic.w * ooIntrinsics.y;
-
-	Vector2i imgSize = depth->noDims;
-	upPtCloud->noDims = imgSize; upPtCloud->dataSize = depth->dataSize;
-
-	dim3 blockSize(16, 16);
-	dim3 gridSize((int)ceil((float)imgSize.x / (float)blockSize.x), (int)ceil((float)imgSize.y / (float)blockSize.y));
-
-	unprojectDepthToCam_device << <gridSize, blockSize >> >(camPoints, depthMap, imgSize, ooIntrinsics);
-}
-
 // device functions
 
-__global__ void unprojectDepthToCam_device(Vector4f *camPoints, float *depthMap, Vector2i imgSize, Vector4f ooIntrinsics)
-{
-	int x = threadIdx.x + blockIdx.x * blockDim.x, y = threadIdx.y + blockIdx.y * blockDim.y;
-
-	if (x < imgSize.x && y < imgSize.y)
-	{
-		Vector3f inpt; int locId = x + y * imgSize.x;
-
-		inpt.z = depthMap[locId];
-
-		if (inpt.z > 0.0f)
-		{
-			inpt.x = x * inpt.z; inpt.y = y * inpt.z;
-			unprojectPtWithIntrinsic(ooIntrinsics, inpt, camPoints[locId]);
-		}
-		else camPoints[locId] = Vector4f(0.0f, 0.0f, 0.0f, -1.0f);
-	}
-}
-
 template<class TVoxel, class TIndex>
 __global__ void renTrackerOneLevel_f_device(float *f_device, Vector4f *ptList, int count, const TVoxel *voxelBlocks, 
 	const typename TIndex::IndexData *index, float oneOverVoxelSize, Matrix4f invM)
@@ -166,12 +126,14 @@ __global__ void renTrackerOneLevel_f_device(float *f_device, Vector4f *ptList, i
 
 	__shared__ float dim_shared[256];
 
+	typename TIndex::IndexCache cache;
+
 	dim_shared[locId_local] = 0.0f;
 
 	if (locId_global < count)
 	{
 		Vector4f inpt = ptList[locId_global];
-		if (inpt.w > -1.0f) dim_shared[locId_local] = computePerPixelEnergy<TVoxel,TIndex>(inpt, voxelBlocks, index, oneOverVoxelSize, invM);
+		if (inpt.w > -1.0f) dim_shared[locId_local] = computePerPixelEnergy<TVoxel,TIndex>(inpt, voxelBlocks, index, oneOverVoxelSize, invM, cache);
 	}
 	
 	{ //reduction for f_device
@@ -198,6 +160,7 @@ __global__ void renTrackerOneLevel_g_device(float *g_device, float *h_device, Ve
 	__shared__ bool shouldAdd; bool hasValidData = false;
 
 	float localGradient[6], localHessian[21];
+	typename TIndex::IndexCache cache;
 
 	int noPara = 6, noParaSQ = 6 + 5 + 4 + 3 + 2 + 1;
 
@@ -209,7 +172,7 @@ __global__ void renTrackerOneLevel_g_device(float *g_device, float *h_device, Ve
 		Vector4f cPt = ptList[locId_global];
 		if (cPt.w > -1.0f)
 		{
-			if (computePerPixelJacobian<TVoxel,TIndex>(localGradient, cPt, voxelBlocks, index, oneOverVoxelSize, invM))
+			if (computePerPixelJacobian<TVoxel,TIndex>(localGradient, cPt, voxelBlocks, index, oneOverVoxelSize, invM, cache))
 			{
 				shouldAdd = true; hasValidData = true;
 				for (int r = 0, counter = 0; r < noPara; r++) for (int c = 0; c <= r; c++, counter++)
@@ -18,8 +18,6 @@ namespace ITMLib
 			void F_oneLevel(float *f, Matrix4f invM);
 			void G_oneLevel(float *gradient, float *hessian, Matrix4f invM) const;
 
-			void UnprojectDepthToCam(ITMFloatImage *depth, ITMFloat4Image *upPtCloud, const Vector4f &intrinsic);
-
 		public:
 			ITMRenTracker_CUDA(Vector2i imgSize, int noHierarchyLevels, ITMLowLevelEngine *lowLevelEngine, ITMScene<TVoxel,TIndex> *scene);
 			~ITMRenTracker_CUDA(void);
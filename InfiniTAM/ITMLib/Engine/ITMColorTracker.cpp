@@ -7,19 +7,25 @@
 
 using namespace ITMLib::Engine;
 
-static inline bool minimizeLM(const ITMColorTracker & tracker, ITMPose & initialization);
+static inline bool minimizeLM(const ITMColorTracker & tracker, ITMPose & initialization, ITMTrackingQuality & quality);
 
 ITMColorTracker::ITMColorTracker(Vector2i imgSize, int noHierarchyLevels, int noRotationOnlyLevels,
-	ITMLowLevelEngine *lowLevelEngine, bool useGPU)
+	ITMLowLevelEngine *lowLevelEngine, bool useFixedJacobians, bool useLuminance, bool useGPU)
 {
-	viewHierarchy = new ITMImageHierarchy<ITMViewHierarchyLevel>(imgSize, noHierarchyLevels, noRotationOnlyLevels, useGPU);
+	viewHierarchy = NULL; intensityHierarchy = NULL;
+
+	if (useLuminance) intensityHierarchy = new ITMImageHierarchy<ITMIntensityHierarchyLevel>(imgSize, noHierarchyLevels, noRotationOnlyLevels, useGPU);
+	else viewHierarchy = new ITMImageHierarchy<ITMViewHierarchyLevel>(imgSize, noHierarchyLevels, noRotationOnlyLevels, useGPU);
 
 	this->lowLevelEngine = lowLevelEngine;
+	this->useFixedJacobians = useFixedJacobians;
+	this->useLuminance = useLuminance;
 }
 
 ITMColorTracker::~ITMColorTracker(void)
 {
-	delete viewHierarchy;
+	if (viewHierarchy != NULL) delete viewHierarchy;
+	if (intensityHierarchy != NULL) delete intensityHierarchy;
 }
 
 void ITMColorTracker::TrackCamera(ITMTrackingState *trackingState, const ITMView *view)
@@ -29,12 +35,15 @@ void ITMColorTracker::TrackCamera(ITMTrackingState *trackingState, const ITMView
 	this->PrepareForEvaluation(view);
 
 	ITMPose currentPara(view->calib->trafo_rgb_to_depth.calib_inv * trackingState->pose_d->M);
-	for (int levelId = viewHierarchy->noLevels - 1; levelId >= 0; levelId--)
+	int noLevels = useLuminance ? intensityHierarchy->noLevels : viewHierarchy->noLevels;
+	for (int levelId = noLevels - 1; levelId >= 0; levelId--)
 	{
 		this->levelId = levelId;
-		this->rotationOnly = viewHierarchy->levels[levelId]->rotationOnly;
+		this->rotationOnly = useLuminance ? intensityHierarchy->levels[levelId]->rotationOnly : viewHierarchy->levels[levelId]->rotationOnly;
 
-		minimizeLM(*this, currentPara);
+		// each level overwrites the quality measures, so the finest level is reported
+		if (useFixedJacobians) TrackLevelFixedJacobians(currentPara, *trackingState->trackingQuality);
+		else minimizeLM(*this, currentPara, *trackingState->trackingQuality);
 	}
 
 	// these following will coerce the result back into the chosen
@@ -47,6 +56,20 @@ void ITMColorTracker::TrackCamera(ITMTrackingState *trackingState, const ITMView
 
 void ITMColorTracker::PrepareForEvaluation(const ITMView *view)
 {
+	if (useLuminance)
+	{
+		// the colour image is converted once, the coarser levels and gradients only have a single channel
+		lowLevelEngine->ConvertColourToIntensity(intensityHierarchy->levels[0]->intensity, view->rgb);
+
+		for (int i = 1; i < intensityHierarchy->noLevels; i++)
+			lowLevelEngine->FilterSubsample(intensityHierarchy->levels[i]->intensity, intensityHierarchy->levels[i - 1]->intensity);
+
+		for (int i = 0; i < intensityHierarchy->noLevels; i++)
+			lowLevelEngine->Gradient(intensityHierarchy->levels[i]->gradients, intensityHierarchy->levels[i]->intensity);
+
+		return;
+	}
+
 	lowLevelEngine->CopyImage(viewHierarchy->levels[0]->rgb, view->rgb);
 
 	ITMImageHierarchy<ITMViewHierarchyLevel> *hierarchy = viewHierarchy;
@@ -84,28 +107,52 @@ void ITMColorTracker::applyDelta(const ITMPose & para_old, const float *delta, I
 	para_new.MultiplyWith(&(para_old));
 }
 
+void ITMColorTracker::applyDeltaFixedJacobians(const ITMPose & para_ref, const ITMPose & para_old, const float *delta, ITMPose & para_new) const
+{
+	float paramVector[6];
+
+	if (rotationOnly)
+	{
+		paramVector[0] = 0.0f; paramVector[1] = 0.0f; paramVector[2] = 0.0f;
+		paramVector[3] = delta[0]; paramVector[4] = delta[1]; paramVector[5] = delta[2];
+	}
+	else
+	{
+		for (int i = 0; i < 6; i++) paramVector[i] = delta[i];
+	}
+
+	ITMPose para_delta(paramVector);
+	para_delta.SetModelViewFromParams();
+
+	// the Jacobians are derivatives with respect to a motion of the points in front of the reference camera
+	para_new.SetFrom(para_old.M * para_ref.invM * para_delta.M * para_ref.M);
+}
+
 void ITMColorTracker::EvaluationPoint::computeGradients(bool hessianRequired)
 {
-	int numPara = mParent->numParameters();
-	cacheNabla = new float[numPara];
-	cacheHessian = new float[numPara*numPara];
+	mParent->G_oneLevel(cacheNabla, cacheHessian, &mPara);
 
-	mParent->G_oneLevel(cacheNabla, cacheHessian, mPara);
+	hasGradients = true;
 }
 
-ITMColorTracker::EvaluationPoint::EvaluationPoint(ITMPose *pos, const ITMColorTracker *f_parent)
+void ITMColorTracker::EvaluationPoint::Evaluate(const ITMPose & pos, const ITMColorTracker *f_parent)
 {
 	float localF[1];
 
-	this->mPara = pos; this->mParent = f_parent;
+	this->mPara.SetFrom(&pos); this->mParent = f_parent;
 
 	ITMColorTracker *parent = (ITMColorTracker *)mParent;
 
-	parent->F_oneLevel(localF, mPara);
+	parent->F_oneLevel(localF, &mPara);
 
 	cacheF = localF[0];
 
-	cacheHessian = NULL; cacheNabla = NULL;
+	// F_oneLevel scales the sum of squared differences up to all points to account for occlusions
+	int noTotalPoints = parent->trackingState->pointCloud->noTotalPoints;
+	cacheInlierRatio = noTotalPoints > 0 ? (float)parent->countedPoints_valid / (float)noTotalPoints : 0.0f;
+	cacheResidual = parent->countedPoints_valid > 0 ? cacheF / (float)noTotalPoints : 0.0f;
+
+	hasGradients = false;
 }
 
 // LM optimisation
@@ -114,17 +161,16 @@ static inline double stepQuality(ITMColorTracker::EvaluationPoint *x, ITMColorTr
 {
 	double actual_reduction = x->f() - x2->f();
 	double predicted_reduction = 0.0;
-	float *tmp = new float[numPara];
+	float tmp[6];
 
 	matmul(B, step, tmp, numPara, numPara);
 	for (int i = 0; i < numPara; i++) predicted_reduction -= grad[i] * step[i] + 0.5*step[i] * tmp[i];
-	delete[] tmp;
 
 	if (predicted_reduction < 0) return actual_reduction / fabs(predicted_reduction);
 	return actual_reduction / predicted_reduction;
 }
 
-static inline bool minimizeLM(const ITMColorTracker & tracker, ITMPose & initialization)
+static inline bool minimizeLM(const ITMColorTracker & tracker, ITMPose & initialization, ITMTrackingQuality & quality)
 {
 	// These are some sensible default parameters for Levenberg Marquardt.
 	// The first three control the convergence criteria, the others might
@@ -138,14 +184,20 @@ static inline bool minimizeLM(const ITMColorTracker & tracker, ITMPose & initial
 	static const float TR_REGION_DECREASE = 0.25f;
 
 	int numPara = tracker.numParameters();
-	float *d = new float[numPara];
+	float d[6], A[6 * 6];
 	float lambda = 0.01f;
 	int step_counter = 0;
 
-	ITMColorTracker::EvaluationPoint *x = tracker.evaluateAt(new ITMPose(initialization));
-	ITMColorTracker::EvaluationPoint *x2 = NULL;
+	// the current point and the candidate after a step, swapped when a step is accepted
+	ITMColorTracker::EvaluationPoint points[2];
+	ITMColorTracker::EvaluationPoint *x = &(points[0]), *x2 = &(points[1]);
+
+	tracker.evaluateAt(x, initialization);
 
-	if (!portable_finite(x->f())) { delete[] d; delete x; return false; }
+	quality.inlierRatio = x->inlierRatio();
+	quality.residual = x->residual();
+
+	if (!portable_finite(x->f())) return false;
 
 	do
 	{
@@ -155,9 +207,11 @@ static inline bool minimizeLM(const ITMColorTracker & tracker, ITMPose & initial
 		grad = x->nabla_f();
 		B = x->hessian_GN();
 
+		quality.hessianCondition = ITMLib::Utils::ITMCholesky::PoseConditionEstimate(B, numPara);
+		quality.noIterations++;
+
 		bool success;
 		{
-			float *A = new float[numPara*numPara];
 			for (int i = 0; i < numPara*numPara; ++i) A[i] = B[i];
 			for (int i = 0; i < numPara; ++i)
 			{
@@ -171,7 +225,6 @@ static inline bool minimizeLM(const ITMColorTracker & tracker, ITMPose & initial
 			// TODO: if Cholesky failed, set success to false!
 
 			success = true;
-			delete[] A;
 		}
 
 		if (success)
@@ -183,12 +236,12 @@ static inline bool minimizeLM(const ITMColorTracker & tracker, ITMPose & initial
 			for (int i = 0; i < numPara; i++) d[i] = -d[i];
 
 			// make step
-			ITMPose *tmp_para = new ITMPose(x->getParameter());
-			tracker.applyDelta(x->getParameter(), &(d[0]), *tmp_para);
+			ITMPose tmp_para;
+			tracker.applyDelta(x->getParameter(), &(d[0]), tmp_para);
 
 			// check whether step reduces error function and
 			// compute a new value of lambda
-			x2 = tracker.evaluateAt(tmp_para);
+			tracker.evaluateAt(x2, tmp_para);
 
 			double rho = stepQuality(x, x2, &(d[0]), grad, B, numPara);
 			if (rho > TR_QUALITY_GAMMA1) lambda = lambda / TR_REGION_INCREASE;
@@ -196,7 +249,6 @@ static inline bool minimizeLM(const ITMColorTracker & tracker, ITMPose & initial
 		}
 		else
 		{
-			x2 = NULL;
 			// can't compute a step quality here...
 			lambda = lambda / TR_REGION_DECREASE;
 		}
@@ -207,19 +259,87 @@ static inline bool minimizeLM(const ITMColorTracker & tracker, ITMPose & initial
 			bool continueIteration = true;
 			if (!(x2->f() < (x->f() - fabs(x->f()) * MIN_DECREASE))) continueIteration = false;
 
-			delete x;
-			x = x2;
+			ITMColorTracker::EvaluationPoint *tmp = x; x = x2; x2 = tmp;
 
 			if (!continueIteration) break;
 		}
-		else if (x2 != NULL) delete x2;
 		if (step_counter++ >= MAX_STEPS - 1) break;
 	} while (true);
 
 	initialization.SetFrom(&(x->getParameter()));
-	delete x;
 
-	delete[] d;
+	quality.inlierRatio = x->inlierRatio();
+	quality.residual = x->residual();
 
 	return true;
 }
+
+// Gauss-Newton with precomputed Jacobians
+
+void ITMColorTracker::TrackLevelFixedJacobians(ITMPose & para, ITMTrackingQuality & quality)
+{
+	// the same convergence criteria as for Levenberg Marquardt
+	static const int MAX_STEPS = 100;
+	static const float MIN_STEP = 0.00005f;
+	static const float MIN_DECREASE = 0.00001f;
+
+	int numPara = numParameters();
+	int noTotalPoints = trackingState->pointCloud->noTotalPoints;
+	float hessian[6 * 6], grad[6], grad_new[6], d[6], f, f_new;
+
+	ITMPose para_ref(para), para_new;
+
+	// the Jacobians and Hessian stay fixed on this level, each step
+	// only warps the points and accumulates the residuals
+	J_oneLevel(hessian, &para_ref);
+	if (countedPoints_valid == 0)
+	{
+		// no point projects into the image, so the level failed, rather than keeping the quality of the previous level
+		quality.inlierRatio = 0.0f; quality.residual = 0.0f; quality.hessianCondition = FLT_MAX;
+		return;
+	}
+
+	for (int i = 0; i < numPara; ++i)
+	{
+		float & ele = hessian[i*(numPara + 1)];
+		if (fabs(ele) < 1e-15f) ele = 1e-10f;
+	}
+
+	ITMLib::Utils::ITMCholesky cholH(hessian, numPara);
+	quality.hessianCondition = ITMLib::Utils::ITMCholesky::PoseConditionEstimate(hessian, numPara);
+
+	FJ_oneLevel(&f, grad, &para);
+	int noValidPoints = countedPoints_valid;
+
+	if (portable_finite(f))
+	{
+		for (int step_counter = 0; step_counter < MAX_STEPS; step_counter++)
+		{
+			quality.noIterations++;
+
+			cholH.Backsub(d, grad);
+
+			float MAXnorm = 0.0;
+			for (int i = 0; i < numPara; i++) { float tmp = fabs(d[i]); if (tmp > MAXnorm) MAXnorm = tmp; }
+
+			if (MAXnorm < MIN_STEP) break;
+			for (int i = 0; i < numPara; i++) d[i] = -d[i];
+
+			applyDeltaFixedJacobians(para_ref, para, d, para_new);
+			FJ_oneLevel(&f_new, grad_new, &para_new);
+
+			// without a trust region a step that does not reduce the error ends the level
+			if (!(f_new < f)) break;
+
+			bool continueIteration = f_new < f - fabs(f) * MIN_DECREASE;
+
+			para.SetFrom(&para_new); f = f_new; noValidPoints = countedPoints_valid;
+			for (int i = 0; i < numPara; i++) grad[i] = grad_new[i];
+
+			if (!continueIteration) break;
+		}
+	}
+
+	quality.inlierRatio = noTotalPoints > 0 ? (float)noValidPoints / (float)noTotalPoints : 0.0f;
+	quality.residual = noValidPoints > 0 ? f / (float)noTotalPoints : 0.0f;
+}
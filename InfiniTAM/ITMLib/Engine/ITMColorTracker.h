@@ -6,6 +6,7 @@
 
 #include "../Objects/ITMImageHierarchy.h"
 #include "../Objects/ITMViewHierarchyLevel.h"
+#include "../Objects/ITMIntensityHierarchyLevel.h"
 
 #include "../Engine/ITMTracker.h"
 #include "../Engine/ITMLowLevelEngine.h"
@@ -28,45 +29,61 @@ namespace ITMLib
 
 			void PrepareForEvaluation(const ITMView *view);
 
+			/// Gauss-Newton on one level with Jacobians frozen at the level's initial pose, see J_oneLevel().
+			void TrackLevelFixedJacobians(ITMPose & para, ITMTrackingQuality & quality);
+
 		protected: 
 			bool rotationOnly;
 			ITMTrackingState *trackingState; const ITMView *view;
+			/// Colour images and their gradients, or only their luminance if useLuminance is set
 			ITMImageHierarchy<ITMViewHierarchyLevel> *viewHierarchy;
+			ITMImageHierarchy<ITMIntensityHierarchyLevel> *intensityHierarchy;
 			int levelId;
 
+			/// Compare the luminance of the points and images instead of all three colour channels
+			bool useLuminance;
+
+			/// Gauss-Newton with Jacobians frozen at the level's initial pose, instead of Levenberg-Marquardt with
+			/// Jacobians recomputed at every step
+			bool useFixedJacobians;
+
 			int countedPoints_valid;
 		public:
 			class EvaluationPoint
 			{
 			public:
 				float f(void) { return cacheF; }
-				const float* nabla_f(void) { if (cacheNabla == NULL) computeGradients(false); return cacheNabla; }
-
-				const float* hessian_GN(void) { if (cacheHessian == NULL) computeGradients(true); return cacheHessian; }
-				const ITMPose & getParameter(void) const { return *mPara; }
-
-				EvaluationPoint(ITMPose *pos, const ITMColorTracker *f_parent);
-				~EvaluationPoint(void)
-				{
-					delete mPara;
-					if (cacheNabla != NULL) delete[] cacheNabla;
-					if (cacheHessian != NULL) delete[] cacheHessian;
-				}
+				/// Fraction of the scene points that projected into the image
+				float inlierRatio(void) const { return cacheInlierRatio; }
+				/// Mean squared colour difference of the points that projected into the image
+				float residual(void) const { return cacheResidual; }
+				const float* nabla_f(void) { if (!hasGradients) computeGradients(false); return cacheNabla; }
+
+				const float* hessian_GN(void) { if (!hasGradients) computeGradients(true); return cacheHessian; }
+				const ITMPose & getParameter(void) const { return mPara; }
+
+				/** Evaluates the energy at @p pos. The gradient and
+				    Hessian are computed on demand and kept in fixed
+				    storage, so points can be reused without any
+				    memory allocation.
+				*/
+				void Evaluate(const ITMPose & pos, const ITMColorTracker *f_parent);
 
 			protected:
 				void computeGradients(bool requiresHessian);
 
-				ITMPose *mPara;
+				ITMPose mPara;
 				const ITMColorTracker *mParent;
 
-				float cacheF;
-				float *cacheNabla;
-				float *cacheHessian;
+				float cacheF, cacheInlierRatio, cacheResidual;
+				float cacheNabla[6];
+				float cacheHessian[6 * 6];
+				bool hasGradients;
 			};
 
-			EvaluationPoint* evaluateAt(ITMPose *para) const
+			void evaluateAt(EvaluationPoint *point, const ITMPose & para) const
 			{
-				return new EvaluationPoint(para, this);
+				point->Evaluate(para, this);
 			}
 
 			int numParameters(void) const { return rotationOnly ? 3 : 6; }
@@ -74,12 +91,23 @@ namespace ITMLib
 			virtual void F_oneLevel(float *f, ITMPose *pose) = 0;
 			virtual void G_oneLevel(float *gradient, float *hessian, ITMPose *pose) const = 0;
 
+			/** Computes the derivatives of the observed colours of
+			    all points at @p pose on the current level and keeps
+			    them for FJ_oneLevel(). Returns the Gauss-Newton
+			    Hessian built from them, scaled like G_oneLevel().
+			*/
+			virtual void J_oneLevel(float *hessian, ITMPose *pose) = 0;
+			/// Energy at @p pose as in F_oneLevel(), and its gradient from the derivatives of the last J_oneLevel() call.
+			virtual void FJ_oneLevel(float *f, float *gradient, ITMPose *pose) = 0;
+
 			void applyDelta(const ITMPose & para_old, const float *delta, ITMPose & para_new) const;
+			/// Applies @p delta in the camera frame of @p para_ref, the pose the Jacobians of J_oneLevel() were computed at.
+			void applyDeltaFixedJacobians(const ITMPose & para_ref, const ITMPose & para_old, const float *delta, ITMPose & para_new) const;
 
 			void TrackCamera(ITMTrackingState *trackingState, const ITMView *view);
 
 			ITMColorTracker(Vector2i imgSize, int noHierarchyLevels, int noRotationOnlyLevels,
-				ITMLowLevelEngine *lowLevelEngine, bool useGPU);
+				ITMLowLevelEngine *lowLevelEngine, bool useFixedJacobians, bool useLuminance, bool useGPU);
 			virtual ~ITMColorTracker(void);
 		};
 	}
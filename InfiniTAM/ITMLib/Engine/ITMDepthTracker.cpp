@@ -2,24 +2,24 @@
 
 #include "ITMDepthTracker.h"
 #include "../Utils/ITMCholesky.h"
+#include "../Utils/ITMTimer.h"
 
 #include <math.h>
 
 using namespace ITMLib::Engine;
 using namespace ITMLib::Utils;
 
-ITMDepthTracker::ITMDepthTracker(Vector2i imgSize, int noHierarchyLevels, int noRotationOnlyLevels, int noICPRunTillLevel, float distThresh, ITMLowLevelEngine *lowLevelEngine, bool useGPU)
+ITMDepthTracker::ITMDepthTracker(Vector2i imgSize, int noHierarchyLevels, int noRotationOnlyLevels, int noICPRunTillLevel, float distThresh,
+	const int *noIterationsPerLevel, float stepThreshold, float residualThreshold, int minNoInliers, ITMLowLevelEngine *lowLevelEngine, bool useGPU)
 {
-	viewHierarchy = new ITMImageHierarchy<ITMTemplatedHierarchyLevel<ITMFloatImage> >(imgSize, noHierarchyLevels, noRotationOnlyLevels, useGPU);
 	sceneHierarchy = new ITMImageHierarchy<ITMSceneHierarchyLevel>(imgSize, noHierarchyLevels, noRotationOnlyLevels, useGPU);
 
 	this->noIterationsPerLevel = new int[noHierarchyLevels];
+	for (int levelId = 0; levelId < noHierarchyLevels; levelId++) this->noIterationsPerLevel[levelId] = noIterationsPerLevel[levelId];
 
-	this->noIterationsPerLevel[0] = 2; //TODO -> make parameter
-	for (int levelId = 1; levelId < noHierarchyLevels; levelId++)
-	{
-		noIterationsPerLevel[levelId] = noIterationsPerLevel[levelId - 1] + 2;
-	}
+	this->stepThreshold = stepThreshold;
+	this->residualThreshold = residualThreshold;
+	this->minNoInliers = minNoInliers;
 
 	this->lowLevelEngine = lowLevelEngine;
 
@@ -30,7 +30,6 @@ ITMDepthTracker::ITMDepthTracker(Vector2i imgSize, int noHierarchyLevels, int no
 
 ITMDepthTracker::~ITMDepthTracker(void) 
 { 
-	delete this->viewHierarchy;
 	delete this->sceneHierarchy;
 
 	delete[] this->noIterationsPerLevel;
@@ -42,26 +41,20 @@ void ITMDepthTracker::SetEvaluationData(ITMTrackingState *trackingState, const I
 	this->view = view;
 
 	sceneHierarchy->levels[0]->intrinsics = view->calib->intrinsics_d.projectionParamsSimple.all;
-	viewHierarchy->levels[0]->intrinsics = view->calib->intrinsics_d.projectionParamsSimple.all;
 
-	lowLevelEngine->CopyImage(viewHierarchy->levels[0]->depth, view->depth);
+	depthPyramid = lowLevelEngine->GetDepthPyramid(view, sceneHierarchy->noLevels);
+
 	lowLevelEngine->CopyImage(sceneHierarchy->levels[0]->pointsMap, trackingState->pointCloud->locations);
 	lowLevelEngine->CopyImage(sceneHierarchy->levels[0]->normalsMap, trackingState->pointCloud->colours);
 }
 
 void ITMDepthTracker::PrepareForEvaluation()
 {
-	this->ChangeIgnorePixelToZero(viewHierarchy->levels[0]->depth);
-
-	for (int i = 1; i < viewHierarchy->noLevels; i++)
+	for (int i = 1; i < sceneHierarchy->noLevels; i++)
 	{
-		ITMTemplatedHierarchyLevel<ITMFloatImage> *currentLevelView = viewHierarchy->levels[i], *previousLevelView = viewHierarchy->levels[i - 1];
-		lowLevelEngine->FilterSubsampleWithHoles(currentLevelView->depth, previousLevelView->depth);
-		currentLevelView->intrinsics = previousLevelView->intrinsics * 0.5f;
-
 		ITMSceneHierarchyLevel *currentLevelScene = sceneHierarchy->levels[i], *previousLevelScene = sceneHierarchy->levels[i - 1];
-		//lowLevelEngine->FilterSubsampleWithHoles(currentLevelScene->pointsMap, previousLevelScene->pointsMap);
-		//lowLevelEngine->FilterSubsampleWithHoles(currentLevelScene->normalsMap, previousLevelScene->normalsMap);
+		lowLevelEngine->FilterSubsampleWithHoles(currentLevelScene->pointsMap, previousLevelScene->pointsMap);
+		lowLevelEngine->FilterSubsampleNormalsWithHoles(currentLevelScene->normalsMap, previousLevelScene->normalsMap);
 		currentLevelScene->intrinsics = previousLevelScene->intrinsics * 0.5f;
 	}
 }
@@ -69,7 +62,7 @@ void ITMDepthTracker::PrepareForEvaluation()
 void ITMDepthTracker::SetEvaluationParams(int levelId)
 {
 	this->levelId = levelId;
-	this->rotationOnly = viewHierarchy->levels[levelId]->rotationOnly;
+	this->rotationOnly = sceneHierarchy->levels[levelId]->rotationOnly;
 }
 
 void ITMDepthTracker::ComputeSingleStep(float *step, float *ATA, float *ATb, bool rotationOnly)
@@ -91,6 +84,19 @@ void ITMDepthTracker::ComputeSingleStep(float *step, float *ATA, float *ATb, boo
 	}
 }
 
+float ITMDepthTracker::ComputeHessianCondition(const float *ATA, bool rotationOnly)
+{
+	if (rotationOnly)
+	{
+		float smallATA[3 * 3];
+		for (int r = 0; r < 3; r++) for (int c = 0; c < 3; c++) smallATA[r + c * 3] = ATA[r + c * 6];
+
+		return ITMCholesky::PoseConditionEstimate(smallATA, 3);
+	}
+
+	return ITMCholesky::PoseConditionEstimate(ATA, 6);
+}
+
 Matrix4f ITMDepthTracker::ApplySingleStep(Matrix4f approxInvPose, float *step)
 {
 	Matrix4f Tinc;
@@ -109,34 +115,68 @@ void ITMDepthTracker::TrackCamera(ITMTrackingState *trackingState, const ITMView
 
 	this->PrepareForEvaluation();
 
-	Matrix4f approxInvPose = trackingState->pose_d->invM, imagePose = trackingState->pose_d->M;
+	// the scene points were created at pose_pointCloud, tracking starts from the (possibly predicted) pose_d
+	Matrix4f approxInvPose = trackingState->pose_d->invM, imagePose = trackingState->pose_pointCloud->M;
+
+	ITMTrackerStatistics *stats = trackingState->trackerStats;
+	stats->Reset();
 
-	for (int levelId = viewHierarchy->noLevels - 1; levelId >= noICPLevel; levelId--)
+	ITMTrackingQuality *quality = trackingState->trackingQuality;
+	int noExpectedInliers = 0;
+
+	for (int levelId = sceneHierarchy->noLevels - 1; levelId >= noICPLevel; levelId--)
 	{
-		
+		ITMTimer timer;
+
 		this->SetEvaluationParams(levelId);
 
 		int noValidPoints;
+		float residual, lastResidual = 0.0f;
 
-		ITMSceneHierarchyLevel *sceneHierarchyLevel = sceneHierarchy->levels[0];
-		ITMTemplatedHierarchyLevel<ITMFloatImage> *viewHierarchyLevel = viewHierarchy->levels[levelId];
+		ITMSceneHierarchyLevel *sceneHierarchyLevel = sceneHierarchy->levels[levelId];
+		const ITMDepthPyramidLevel *viewLevel = depthPyramid->levels[levelId];
+
+		int noSelectedPoints = this->SelectPoints(viewLevel);
+		noExpectedInliers = noSelectedPoints >= 0 ? noSelectedPoints : viewLevel->noValidDepths;
 
 		for (int iterNo = 0; iterNo < noIterationsPerLevel[levelId]; iterNo++)
 		{
-			noValidPoints = this->ComputeGandH(sceneHierarchyLevel, viewHierarchyLevel, approxInvPose, imagePose, rotationOnly);
+			noValidPoints = this->ComputeGandH(sceneHierarchyLevel, viewLevel, approxInvPose, imagePose, rotationOnly);
+			residual = noValidPoints > 0 ? f_host / (float)noValidPoints : 0.0f;
+
+			stats->noIterationsPerLevel[levelId] = iterNo + 1;
+			stats->noInliersPerLevel[levelId] = noValidPoints;
+			stats->residualPerLevel[levelId] = residual;
+
+			if (noValidPoints <= 0 || noValidPoints < minNoInliers) break; // too few inliers
 
-			if (noValidPoints > 0)
-			{
-				this->ComputeSingleStep(step, ATA_host, ATb_host, rotationOnly);
+			// the residual of the current pose barely improved over the previous one
+			if (residualThreshold > 0.0f && iterNo > 0 && lastResidual - residual < residualThreshold * lastResidual) break;
+			lastResidual = residual;
 
-				float stepLength = 0.0f;
-				for (int i = 0; i < 6; i++) stepLength += step[i] * step[i];
+			this->ComputeSingleStep(step, ATA_host, ATb_host, rotationOnly);
 
-				if (sqrtf(stepLength) / 6 < 1e-3) break; //converged
+			float stepLength = 0.0f;
+			for (int i = 0; i < 6; i++) stepLength += step[i] * step[i];
 
-				approxInvPose = ApplySingleStep(approxInvPose, step);
-			}
+			if (sqrtf(stepLength) / 6 < stepThreshold) break; //converged
+
+			approxInvPose = ApplySingleStep(approxInvPose, step);
 		}
+
+		stats->noInliers = stats->noInliersPerLevel[levelId];
+		stats->residual = stats->residualPerLevel[levelId];
+		quality->noIterations += stats->noIterationsPerLevel[levelId];
+
+		stats->timePerLevel[levelId] = timer.GetElapsedMilliseconds();
+	}
+
+	// the quality of the finest level tracked, ATA_host still holds the Hessian of its last iteration
+	if (stats->noIterationsPerLevel[noICPLevel] > 0)
+	{
+		quality->inlierRatio = noExpectedInliers > 0 ? MIN((float)stats->noInliers / (float)noExpectedInliers, 1.0f) : 0.0f;
+		quality->residual = stats->residual;
+		quality->hessianCondition = ComputeHessianCondition(ATA_host, sceneHierarchy->levels[noICPLevel]->rotationOnly);
 	}
 
 	approxInvPose.inv(trackingState->pose_d->M);
@@ -5,8 +5,8 @@
 #include "../Utils/ITMLibDefines.h"
 
 #include "../Objects/ITMImageHierarchy.h"
-#include "../Objects/ITMTemplatedHierarchyLevel.h"
 #include "../Objects/ITMSceneHierarchyLevel.h"
+#include "../Objects/ITMDepthPyramid.h"
 
 #include "../Engine/ITMTracker.h"
 #include "../Engine/ITMLowLevelEngine.h"
@@ -26,13 +26,17 @@ namespace ITMLib
 		private:
 			ITMLowLevelEngine *lowLevelEngine;
 			ITMImageHierarchy<ITMSceneHierarchyLevel> *sceneHierarchy;
-			ITMImageHierarchy<ITMTemplatedHierarchyLevel<ITMFloatImage> > *viewHierarchy;
+			/// Depth pyramid of the current frame, shared with the other users of the low level engine.
+			const ITMDepthPyramid *depthPyramid;
 
 			ITMTrackingState *trackingState; const ITMView *view;
 
 			int *noIterationsPerLevel;
 			int noICPLevel;
 
+			float stepThreshold, residualThreshold;
+			int minNoInliers;
+
 			int levelId;
 			bool rotationOnly;
 
@@ -40,23 +44,32 @@ namespace ITMLib
 			void SetEvaluationParams(int levelId);
 
 			void ComputeSingleStep(float *step, float *ATA, float *ATb, bool rotationOnly);
+			float ComputeHessianCondition(const float *ATA, bool rotationOnly);
 			Matrix4f ApplySingleStep(Matrix4f approxInvPose, float *step);
 
 			void SetEvaluationData(ITMTrackingState *trackingState, const ITMView *view);
 		protected:
 			float ATA_host[6 * 6];
 			float ATb_host[6];
+			/// Sum of the squared point-to-plane residuals of the inliers
+			float f_host;
 			float step[6];
 			float distThresh;
 
-			virtual void ChangeIgnorePixelToZero(ITMFloatImage *image) = 0;
-			virtual int ComputeGandH(ITMSceneHierarchyLevel *sceneHierarchyLevel, ITMTemplatedHierarchyLevel<ITMFloatImage> *viewHierarchyLevel,
+			/** Restricts the following calls of ComputeGandH() on
+			    @p viewLevel to a subset of its pixels.
+			    Returns the number of pixels selected, or -1 if all
+			    pixels are used, which is the default.
+			*/
+			virtual int SelectPoints(const ITMDepthPyramidLevel *viewLevel) { return -1; }
+			virtual int ComputeGandH(ITMSceneHierarchyLevel *sceneHierarchyLevel, const ITMDepthPyramidLevel *viewLevel,
 				Matrix4f approxInvPose, Matrix4f imagePose, bool rotationOnly) = 0;
 
 		public:
 			void TrackCamera(ITMTrackingState *trackingState, const ITMView *view);
 
-			ITMDepthTracker(Vector2i imgSize, int noHierarchyLevels, int noRotationOnlyLevels, int noICPRunTillLevel, float distThresh, ITMLowLevelEngine *lowLevelEngine, bool useGPU);
+			ITMDepthTracker(Vector2i imgSize, int noHierarchyLevels, int noRotationOnlyLevels, int noICPRunTillLevel, float distThresh,
+				const int *noIterationsPerLevel, float stepThreshold, float residualThreshold, int minNoInliers, ITMLowLevelEngine *lowLevelEngine, bool useGPU);
 			virtual ~ITMDepthTracker(void);
 		};
 	}
@@ -0,0 +1,64 @@
+// Copyright 2014 Isis Innovation Limited and the authors of InfiniTAM
+
+#include "ITMLowLevelEngine.h"
+
+#include <stdexcept>
+
+using namespace ITMLib::Engine;
+
+void ITMLowLevelEngine::AllocateDepthPyramid(const ITMView *view, int noLevels)
+{
+	// the users keep the pointer to the pyramid, so it is never reallocated
+	if (depthPyramid == NULL) depthPyramid = new ITMDepthPyramid(view->depth->noDims, noLevels, useGPU);
+	else if (depthPyramid->noLevels < noLevels)
+		throw std::runtime_error("Error: ITMLowLevelEngine: more depth pyramid levels requested than allocated by the first request");
+
+	depthPyramid->levels[0]->intrinsics = view->calib->intrinsics_d.projectionParamsSimple.all;
+	for (int levelId = 1; levelId < depthPyramid->noLevels; levelId++)
+		depthPyramid->levels[levelId]->intrinsics = depthPyramid->levels[levelId - 1]->intrinsics * 0.5f;
+}
+
+void ITMLowLevelEngine::BuildDepthPyramidLevels(int firstLevelId)
+{
+	for (int levelId = firstLevelId; levelId < depthPyramid->noLevels; levelId++)
+	{
+		ITMDepthPyramidLevel *previousLevel = depthPyramid->levels[levelId - 1], *level = depthPyramid->levels[levelId];
+
+		this->FilterSubsampleWithHoles(level->depth, previousLevel->depth);
+		level->noValidDepths = this->UnprojectDepth(level->points, level->depth, level->intrinsics);
+	}
+}
+
+const ITMDepthPyramid *ITMLowLevelEngine::GetDepthPyramid(const ITMView *view, int noLevels)
+{
+	if (depthPyramid != NULL && depthPyramid->noLevels >= noLevels && depthPyramid->frameId == view->frameId) return depthPyramid;
+
+	AllocateDepthPyramid(view, noLevels);
+
+	ITMDepthPyramidLevel *level = depthPyramid->levels[0];
+
+	this->CopyImage(level->depth, view->depth);
+	level->noValidDepths = this->UnprojectDepth(level->points, level->depth, level->intrinsics);
+
+	// all levels are built, so that users asking for fewer levels than others share the same pyramid
+	BuildDepthPyramidLevels(1);
+
+	depthPyramid->frameId = view->frameId;
+
+	return depthPyramid;
+}
+
+void ITMLowLevelEngine::PrepareDepth(ITMView *view, int noLevels)
+{
+	if (view->inputImageType == ITMView::InfiniTAM_FLOAT_DEPTH_IMAGE) { GetDepthPyramid(view, noLevels); return; }
+
+	AllocateDepthPyramid(view, noLevels);
+
+	const ITMDisparityCalib *disparityCalib = view->inputImageType == ITMView::InfiniTAM_DISPARITY_IMAGE ? &(view->calib->disparityCalib) : NULL;
+	int noLevelsBuilt = this->ConvertDepthToPyramid(view->depth, view->rawDepth, &(view->calib->intrinsics_d), disparityCalib,
+		depthPyramid, depthPyramid->noLevels);
+
+	BuildDepthPyramidLevels(noLevelsBuilt);
+
+	depthPyramid->frameId = view->frameId;
+}
@@ -8,6 +8,8 @@
 #include "../Objects/ITMExtrinsics.h"
 
 #include "../Objects/ITMImage.h"
+#include "../Objects/ITMView.h"
+#include "../Objects/ITMDepthPyramid.h"
 
 using namespace ITMLib::Objects;
 
@@ -18,24 +20,101 @@ namespace ITMLib
 		/// Interface to low level image processing engines.
 		class ITMLowLevelEngine
 		{
+		private:
+			bool useGPU;
+
+			/// Depth pyramid of the latest frame, see @ref GetDepthPyramid().
+			ITMDepthPyramid *depthPyramid;
+
+			/// Allocates @ref depthPyramid on the first call, later calls only check that it has at least @p noLevels levels.
+			void AllocateDepthPyramid(const ITMView *view, int noLevels);
+			/// Builds the levels of @ref depthPyramid from @p firstLevelId on, each from the level before.
+			void BuildDepthPyramidLevels(int firstLevelId);
+
+		protected:
+			/** Converts @p depth_in to @p depth_out, as
+			    ConvertDisparityToDepth does if @p disparityCalib is
+			    given and as ConvertDepthMMToFloat does otherwise,
+			    and builds up to @p noLevels levels of @p pyramid in
+			    the same pass. The intrinsics of the levels must be
+			    set already. Returns the number of levels built,
+			    the remaining levels are left to the caller.
+			*/
+			virtual int ConvertDepthToPyramid(ITMFloatImage *depth_out, const ITMShortImage *depth_in, const ITMIntrinsics *depthIntrinsics,
+				const ITMDisparityCalib *disparityCalib, ITMDepthPyramid *pyramid, int noLevels) = 0;
+
 		public:
 			virtual void CopyImage(ITMUChar4Image *image_out, const ITMUChar4Image *image_in) = 0;
 			virtual void CopyImage(ITMFloatImage *image_out, const ITMFloatImage *image_in) = 0;
 			virtual void CopyImage(ITMFloat4Image *image_out, const ITMFloat4Image *image_in) = 0;
 
 			virtual void FilterSubsample(ITMUChar4Image *image_out, const ITMUChar4Image *image_in) = 0;
+			virtual void FilterSubsample(ITMUCharImage *image_out, const ITMUCharImage *image_in) = 0;
 			virtual void FilterSubsampleWithHoles(ITMFloatImage *image_out, const ITMFloatImage *image_in) = 0;
 			virtual void FilterSubsampleWithHoles(ITMFloat4Image *image_out, const ITMFloat4Image *image_in) = 0;
+			/// Like FilterSubsampleWithHoles, but the averaged normals are normalised again.
+			virtual void FilterSubsampleNormalsWithHoles(ITMFloat4Image *normals_out, const ITMFloat4Image *normals_in) = 0;
 
 			virtual void GradientX(ITMShort4Image *grad_out, const ITMUChar4Image *image_in) = 0;
 			virtual void GradientY(ITMShort4Image *grad_out, const ITMUChar4Image *image_in) = 0;
+			/// Both gradients of a single channel image at once, x of @p grad_out as GradientX and y as GradientY.
+			virtual void Gradient(ITMShort2Image *grad_out, const ITMUCharImage *image_in) = 0;
+
+			/// Converts a colour image to its luminance, for colour tracking on a single channel.
+			virtual void ConvertColourToIntensity(ITMUCharImage *image_out, const ITMUChar4Image *image_in) = 0;
 
 			virtual void ConvertDisparityToDepth(ITMFloatImage *depth_out, const ITMShortImage *disp_in, const ITMIntrinsics *depthIntrinsics,
 				const ITMDisparityCalib *disparityCalib) = 0;
 			virtual void ConvertDepthMMToFloat(ITMFloatImage *depth_out, const ITMShortImage *depth_in) = 0;
 
-			ITMLowLevelEngine(void) { }
-			virtual ~ITMLowLevelEngine(void) { }
+			/** Creates ICP maps from a depth image instead of a
+			    raycast of the scene: the back projected points in
+			    world coordinates, with @p invM the camera-to-world
+			    transformation, and their normals from neighbouring
+			    points. Neighbours further apart than @p maxNormalDist
+			    lie across a depth discontinuity.
+			*/
+			virtual void CreateICPMapsFromDepth(ITMFloat4Image *pointsMap, ITMFloat4Image *normalsMap, const ITMFloatImage *depth, Vector4f intrinsics,
+				const Matrix4f & invM, float maxNormalDist) = 0;
+
+			/** Back projects @p depth to camera coordinates in
+			    @p points, with w = -1 where the depth is invalid.
+			    Negative depths are set to zero as they are invalid
+			    as well. Returns the number of valid depths.
+			*/
+			virtual int UnprojectDepth(ITMFloat4Image *points, ITMFloatImage *depth, Vector4f intrinsics) = 0;
+
+			/** Returns the depth pyramid of @p view with at least
+			    @p noLevels levels. The pyramid is built only once
+			    per frame, identified by ITMView::frameId, and
+			    shared by all its users, e.g. the trackers and the
+			    allocation of the scene, so it may have more levels
+			    than requested. The pyramid is allocated by the
+			    first call, with the levels requested then, and is
+			    never reallocated, so the pointer stays valid for
+			    the lifetime of the engine. Requesting more levels
+			    later throws, so the first call, usually
+			    PrepareDepth(), must ask for the most levels any
+			    user needs.
+			*/
+			const ITMDepthPyramid *GetDepthPyramid(const ITMView *view, int noLevels);
+
+			/** Turns the raw depth of @p view into view->depth,
+			    unless it is given in metres already, and builds
+			    the depth pyramid of the frame with at least
+			    @p noLevels levels, see @ref GetDepthPyramid().
+			    The conversion and the finest levels of the
+			    pyramid are done in a single pass over the image,
+			    instead of one pass per conversion and level.
+			*/
+			void PrepareDepth(ITMView *view, int noLevels);
+
+			explicit ITMLowLevelEngine(bool useGPU) { this->useGPU = useGPU; this->depthPyramid = NULL; }
+			virtual ~ITMLowLevelEngine(void) { if (depthPyramid != NULL) delete depthPyramid; }
+
+			// Suppress the default copy constructor and assignment operator
+			ITMLowLevelEngine(const ITMLowLevelEngine&);
+			ITMLowLevelEngine& operator=(const ITMLowLevelEngine&);
 		};
 	}
 }
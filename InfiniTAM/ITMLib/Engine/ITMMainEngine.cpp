@@ -40,6 +40,17 @@ ITMMainEngine::ITMMainEngine(const ITMLibSettings *settings, const ITMRGBDCalib
 
 	visualisationState = NULL;
 
+	relocaliser = NULL;
+	if (settings->useRelocalisation)
+		relocaliser = new ITMRelocaliser(imgSize_d, settings->relocaliserMaxNoKeyframes, settings->relocaliserKeyframeThreshold, settings->relocaliserMaxDistance);
+
+	posePredictor = NULL; ownsPosePredictor = false;
+	if (settings->posePredictorType == ITMLibSettings::POSE_PREDICTOR_CONSTANT_VELOCITY)
+	{
+		posePredictor = new ITMConstantVelocityPosePredictor();
+		ownsPosePredictor = true;
+	}
+
 	hasStartedObjectReconstruction = false;
 	fusionActive = true;
 }
@@ -51,6 +62,8 @@ ITMMainEngine::~ITMMainEngine()
 	if (trackerSecondary != NULL) delete trackerSecondary;
 	delete visualisationEngine;
 	delete lowLevelEngine;
+	if (relocaliser != NULL) delete relocaliser;
+	if (ownsPosePredictor) delete posePredictor;
 
 	if (settings->useSwapping) delete swappingEngine;
 
@@ -79,29 +92,59 @@ void ITMMainEngine::ProcessFrame(void)
 		}
 	}
 
-	// prepare image and turn it into a depth image
-	if (view->inputImageType == ITMView::InfiniTAM_DISPARITY_IMAGE)
-	{
-		lowLevelEngine->ConvertDisparityToDepth(view->depth, view->rawDepth, &(view->calib->intrinsics_d), &(view->calib->disparityCalib));
-	}
-	else if (view->inputImageType == ITMView::InfiniTAM_SHORT_DEPTH_IMAGE)
-	{
-		lowLevelEngine->ConvertDepthMMToFloat(view->depth, view->rawDepth);
-	}
+	// a new depth image, anything cached for the previous one is outdated
+	view->frameId++;
+
+	// turn it into a depth image, along with the depth pyramid shared by the depth trackers and the allocation
+	lowLevelEngine->PrepareDepth(view, settings->trackerType == ITMLibSettings::TRACKER_COLOR ? 1 : settings->noHierarchyLevels);
+
+	// pose prediction, the trackers start from the predicted pose
+	if (posePredictor != NULL) posePredictor->PredictPose(trackingState->pose_d);
 
 	// tracking
+	trackingState->trackingQuality->Reset();
 	if (hasStartedObjectReconstruction)
 	{
 		if (trackerPrimary != NULL) trackerPrimary->TrackCamera(trackingState, view);
 		if (trackerSecondary != NULL) trackerSecondary->TrackCamera(trackingState, view);
 
+		ClassifyTrackingQuality();
 	}
 
-	// allocation
-	sceneRecoEngine->AllocateSceneFromDepth(scene, view, trackingState->pose_d);
+	ITMTrackingQuality::TrackingResult trackingResult = trackingState->trackingQuality->result;
+
+	// relocalisation
+	bool trackingLost = false;
+	if (relocaliser != NULL)
+	{
+		if (useGPU) view->depth->UpdateHostFromDevice();
+		relocaliser->ComputeCode(view);
 
-	// integration
-	if (fusionActive) sceneRecoEngine->IntegrateIntoScene(scene, view, trackingState->pose_d);
+		if (trackingResult == ITMTrackingQuality::TRACKING_FAILED)
+		{
+			// restart from the most similar keyframe, or else from the last tracked pose, and force a full raycast there
+			if (!relocaliser->Relocalise(trackingState->pose_d)) trackingState->pose_d->SetFrom(trackingState->pose_pointCloud);
+			trackingState->age_pointCloud = -1;
+			trackingLost = true;
+		}
+		else if (trackingResult == ITMTrackingQuality::TRACKING_GOOD) relocaliser->AddKeyframe(trackingState->pose_d);
+	}
+
+	if (posePredictor != NULL)
+	{
+		if (trackingLost) posePredictor->Reset();
+		else posePredictor->UpdatePose(trackingState->pose_d);
+	}
+
+	// the pose of a relocalised frame was not tracked, so the frame is never integrated
+	if (!trackingLost && ShouldIntegrate())
+	{
+		// allocation
+		sceneRecoEngine->AllocateSceneFromDepth(scene, view, trackingState->pose_d, lowLevelEngine->GetDepthPyramid(view, 1));
+
+		// integration
+		if (fusionActive) sceneRecoEngine->IntegrateIntoScene(scene, view, trackingState->pose_d);
+	}
 
 	// !! add ID change function!
 	//sceneSeg(scene);
@@ -117,9 +160,35 @@ void ITMMainEngine::ProcessFrame(void)
 	{
 	case ITMLibSettings::TRACKER_ICP:
 	case ITMLibSettings::TRACKER_REN:
-		// raycasting
-		visualisationEngine->CreateExpectedDepths(scene, trackingState->pose_d, &(view->calib->intrinsics_d), trackingState->renderingRangeImage);
-		visualisationEngine->CreateICPMaps(scene, view, trackingState);
+		if (settings->useFrameToFrameTracking && CanTrackFrameToFrame())
+		{
+			// ICP maps from the current depth image, the rendering keeps showing the last raycast
+			lowLevelEngine->CreateICPMapsFromDepth(trackingState->pointCloud->locations, trackingState->pointCloud->colours, view->depth,
+				view->calib->intrinsics_d.projectionParamsSimple.all, trackingState->pose_d->invM, settings->frameToFrameMaxNormalDist);
+			trackingState->pointCloudFromDepth = true;
+			trackingState->age_pointCloud++;
+		}
+		else
+		{
+			// raycasting
+			visualisationEngine->CreateExpectedDepths(scene, trackingState->pose_d, &(view->calib->intrinsics_d), trackingState->renderingRangeImage);
+			if (settings->useICPMapsForwardProjection && CanForwardProjectICPMaps())
+			{
+				visualisationEngine->ForwardRenderICPMaps(scene, view, trackingState);
+				trackingState->age_pointCloud++;
+			}
+			else
+			{
+				if (settings->icpMapsRaycastSubsample > 1)
+					visualisationEngine->CreateICPMapsSubsampled(scene, view, trackingState, settings->icpMapsRaycastSubsample);
+				else if (settings->icpNormalsType == ITMLibSettings::NORMALS_FROM_POINTS)
+					visualisationEngine->CreateICPMapsWithPointNormals(scene, view, trackingState);
+				else visualisationEngine->CreateICPMaps(scene, view, trackingState);
+				trackingState->age_pointCloud = 0;
+			}
+			trackingState->pointCloudFromDepth = false;
+		}
+		trackingState->pose_pointCloud->SetFrom(trackingState->pose_d);
 		break;
 	case ITMLibSettings::TRACKER_COLOR:
 		// raycasting
@@ -132,6 +201,61 @@ void ITMMainEngine::ProcessFrame(void)
 	hasStartedObjectReconstruction = true;
 }
 
+void ITMMainEngine::SetPosePredictor(ITMPosePredictor *posePredictor)
+{
+	if (ownsPosePredictor) delete this->posePredictor;
+
+	this->posePredictor = posePredictor;
+	ownsPosePredictor = false;
+}
+
+bool ITMMainEngine::CanForwardProjectICPMaps(void) const
+{
+	if (trackingState->age_pointCloud < 0 || trackingState->age_pointCloud >= settings->icpMapsFullRaycastInterval) return false;
+
+	// maps built from a depth image have the holes and noise of that image, a full raycast replaces them
+	if (trackingState->pointCloudFromDepth) return false;
+
+	Matrix4f poseChange = trackingState->pose_d->M * trackingState->pose_pointCloud->invM;
+
+	Vector3f translation(poseChange.getColumn(3));
+	if (length(translation) > settings->icpMapsMaxTranslation) return false;
+
+	float cosAngle = 0.5f * (poseChange.m00 + poseChange.m11 + poseChange.m22 - 1.0f);
+	if (cosAngle < cosf(settings->icpMapsMaxRotation)) return false;
+
+	return true;
+}
+
+bool ITMMainEngine::CanTrackFrameToFrame(void) const
+{
+	// the first frame and relocalised frames have no tracked depth image to build on
+	if (trackingState->age_pointCloud < 0 || trackingState->age_pointCloud >= settings->frameToFrameRaycastInterval) return false;
+
+	// a drifting pose shows in the tracking quality, a raycast of the scene then brings tracking back to the model
+	return trackingState->trackingQuality->result == ITMTrackingQuality::TRACKING_GOOD;
+}
+
+void ITMMainEngine::ClassifyTrackingQuality(void)
+{
+	ITMTrackingQuality *quality = trackingState->trackingQuality;
+
+	if (quality->inlierRatio < settings->trackingFailedMinInlierRatio) quality->result = ITMTrackingQuality::TRACKING_FAILED;
+	else if (quality->inlierRatio < settings->trackingPoorMinInlierRatio || quality->hessianCondition > settings->trackingPoorMaxHessianCondition)
+		quality->result = ITMTrackingQuality::TRACKING_POOR;
+	else quality->result = ITMTrackingQuality::TRACKING_GOOD;
+}
+
+bool ITMMainEngine::ShouldIntegrate(void) const
+{
+	switch (settings->integrationPolicy)
+	{
+	case ITMLibSettings::INTEGRATE_UNLESS_FAILED: return trackingState->trackingQuality->result != ITMTrackingQuality::TRACKING_FAILED;
+	case ITMLibSettings::INTEGRATE_ONLY_GOOD: return trackingState->trackingQuality->result == ITMTrackingQuality::TRACKING_GOOD;
+	default: return true;
+	}
+}
+
 void ITMMainEngine::GetImage(ITMUChar4Image *out, GetImageType getImageType, bool useColour, ITMPose *pose, ITMIntrinsics *intrinsics)
 {
 	out->Clear();
@@ -169,6 +293,11 @@ void ITMMainEngine::GetImage(ITMUChar4Image *out, GetImageType getImageType, boo
 	};
 }
 
+void ITMMainEngine::GetImages(ITMUChar4Image **out, int noViews, const ITMPose *poses, const ITMIntrinsics *intrinsics, bool useColour)
+{
+	visualisationEngine->RenderImages(scene, noViews, poses, intrinsics, out, useColour);
+}
+
 void ITMMainEngine::turnOnIntegration()
 {
 	fusionActive = true;
@@ -183,6 +312,7 @@ void ITMMainEngine::turnOffIntegration()
 // scene segment function
 void ITMMainEngine::sceneSeg(ITMScene<ITMVoxel,ITMVoxelBlockHash> *scene)
 {
+#ifndef COMPILE_WITHOUT_CUDA
 	ITMVoxel *VoxelBlocks_host = (ITMVoxel*)malloc(scene->localVBA.allocatedSize * sizeof(ITMVoxel));
 	ITMSafeCall(cudaMemcpy(VoxelBlocks_host,scene->localVBA.GetVoxelBlocks(),scene->localVBA.allocatedSize*sizeof(ITMVoxel),cudaMemcpyDeviceToHost));
 
@@ -203,4 +333,5 @@ void ITMMainEngine::sceneSeg(ITMScene<ITMVoxel,ITMVoxelBlockHash> *scene)
 
 	ITMSafeCall(cudaMemcpy(scene->localVBA.GetVoxelBlocks(),VoxelBlocks_host,scene->localVBA.allocatedSize*sizeof(ITMVoxel),cudaMemcpyHostToDevice));
 	free(VoxelBlocks_host);
+#endif
 }
\ No newline at end of file
@@ -59,6 +59,18 @@ namespace ITMLib
 			ITMSwappingEngine<ITMVoxel,ITMVoxelIndex> *swappingEngine;
 			ITMVisualisationEngine<ITMVoxel,ITMVoxelIndex> *visualisationEngine;
 			ITMVisualisationState *visualisationState; // output data stored in this variable
+			ITMRelocaliser *relocaliser;
+			ITMPosePredictor *posePredictor;
+			bool ownsPosePredictor;
+
+			/// Whether the ICP maps of the last frame are recent and close enough to the current pose to be forward projected
+			bool CanForwardProjectICPMaps(void) const;
+			/// Whether the next frame can be tracked against ICP maps built from the current depth image
+			bool CanTrackFrameToFrame(void) const;
+			/// Classifies the tracking of the current frame from the quality measures reported by the trackers
+			void ClassifyTrackingQuality(void);
+			/// Whether the integration policy allows the current frame to be integrated
+			bool ShouldIntegrate(void) const;
 		public:
 			enum GetImageType
 			{
@@ -87,9 +99,23 @@ namespace ITMLib
 			/// Get a result image as output
 			void GetImage(ITMUChar4Image *out, GetImageType getImageType, bool useColour, ITMPose *pose = NULL, ITMIntrinsics *intrinsics = NULL);
 
+			/** Render the scene from @p noViews free cameras at once,
+			    given by the arrays @p poses and @p intrinsics, into
+			    the caller's @p out images. These have to be allocated
+			    with the desired image sizes beforehand.
+			*/
+			void GetImages(ITMUChar4Image **out, int noViews, const ITMPose *poses, const ITMIntrinsics *intrinsics, bool useColour);
+
 			void SaveAll();// seems still no implementation
 
 
+			/** Replaces the pose predictor selected in the
+			    settings, e.g. with an ITMOdometryPosePredictor.
+			    The engine does not take ownership of @p
+			    posePredictor, NULL disables pose prediction.
+			*/
+			void SetPosePredictor(ITMPosePredictor *posePredictor);
+
 			/// switch for turning intergration on/off
 			void turnOnIntegration();
 			void turnOffIntegration();
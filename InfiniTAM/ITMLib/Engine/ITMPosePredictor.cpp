@@ -0,0 +1,79 @@
+// Copyright 2014 Isis Innovation Limited and the authors of InfiniTAM
+
+#include "ITMPosePredictor.h"
+
+#include <fstream>
+
+using namespace ITMLib::Engine;
+
+void ITMConstantVelocityPosePredictor::PredictPose(ITMPose *pose)
+{
+	if (noPoses < 2) return;
+
+	// motion from the last but one to the last frame, in the coordinates of the last but one camera
+	Matrix4f motion = lastPose.M * lastButOnePose.invM;
+
+	pose->SetFrom(motion * pose->M);
+}
+
+void ITMConstantVelocityPosePredictor::UpdatePose(const ITMPose *pose)
+{
+	lastButOnePose.SetFrom(&lastPose);
+	lastPose.SetFrom(pose);
+	if (noPoses < 2) noPoses++;
+}
+
+ITMOdometryPosePredictor::ITMOdometryPosePredictor(const char *fileName)
+{
+	this->src = new std::ifstream(fileName);
+	this->ownsSource = true;
+	this->callback = NULL; this->userData = NULL;
+	this->hasLastPose = false;
+}
+
+ITMOdometryPosePredictor::ITMOdometryPosePredictor(std::istream & src)
+{
+	this->src = &src;
+	this->ownsSource = false;
+	this->callback = NULL; this->userData = NULL;
+	this->hasLastPose = false;
+}
+
+ITMOdometryPosePredictor::ITMOdometryPosePredictor(OdometryCallback callback, void *userData)
+{
+	this->src = NULL;
+	this->ownsSource = false;
+	this->callback = callback; this->userData = userData;
+	this->hasLastPose = false;
+}
+
+ITMOdometryPosePredictor::~ITMOdometryPosePredictor(void)
+{
+	if (ownsSource) delete src;
+}
+
+bool ITMOdometryPosePredictor::ReadOdometryPose(Matrix4f & pose_odometry)
+{
+	if (callback != NULL) return callback(pose_odometry, userData);
+
+	*src >> pose_odometry.m00 >> pose_odometry.m10 >> pose_odometry.m20 >> pose_odometry.m30;
+	*src >> pose_odometry.m01 >> pose_odometry.m11 >> pose_odometry.m21 >> pose_odometry.m31;
+	*src >> pose_odometry.m02 >> pose_odometry.m12 >> pose_odometry.m22 >> pose_odometry.m32;
+	pose_odometry.m03 = 0.0f; pose_odometry.m13 = 0.0f; pose_odometry.m23 = 0.0f; pose_odometry.m33 = 1.0f;
+
+	return !src->fail();
+}
+
+void ITMOdometryPosePredictor::PredictPose(ITMPose *pose)
+{
+	Matrix4f pose_odometry, M_odometry;
+
+	if (!ReadOdometryPose(pose_odometry)) { hasLastPose = false; return; }
+	pose_odometry.inv(M_odometry);
+
+	// motion from the last to the current frame, in the coordinates of the last camera
+	if (hasLastPose) pose->SetFrom(M_odometry * lastPose_odometry * pose->M);
+
+	lastPose_odometry = pose_odometry;
+	hasLastPose = true;
+}
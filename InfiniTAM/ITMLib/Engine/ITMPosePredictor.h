@@ -0,0 +1,102 @@
+// Copyright 2014 Isis Innovation Limited and the authors of InfiniTAM
+
+#pragma once
+
+#include "../Utils/ITMLibDefines.h"
+
+#include "../Objects/ITMPose.h"
+
+#include <iostream>
+
+using namespace ITMLib::Objects;
+
+namespace ITMLib
+{
+	namespace Engine
+	{
+		/** \brief
+		    Interface to predict the camera pose of a new frame
+		    before tracking, so that the trackers start close to
+		    the solution.
+		*/
+		class ITMPosePredictor
+		{
+		public:
+			/** Called once per frame before tracking, replaces
+			    @p pose, the final pose of the previous frame, with
+			    the prediction for the new frame.
+			*/
+			virtual void PredictPose(ITMPose *pose) = 0;
+
+			/// Called once per frame with the final pose after tracking.
+			virtual void UpdatePose(const ITMPose *pose) { }
+
+			/// Forgets the motion observed so far, e.g. after tracking was lost.
+			virtual void Reset(void) { }
+
+			virtual ~ITMPosePredictor(void) {}
+		};
+
+		/** \brief
+		    Extrapolates the motion between the final poses of the
+		    last two frames, assuming constant velocity.
+		*/
+		class ITMConstantVelocityPosePredictor : public ITMPosePredictor
+		{
+		private:
+			ITMPose lastPose, lastButOnePose;
+			int noPoses;
+
+		public:
+			void PredictPose(ITMPose *pose);
+			void UpdatePose(const ITMPose *pose);
+			void Reset(void) { noPoses = 0; }
+
+			ITMConstantVelocityPosePredictor(void) { noPoses = 0; }
+		};
+
+		/** \brief
+		    Applies the relative motion measured by an external
+		    odometry source, e.g. wheel odometry or an IMU, to the
+		    final pose of the previous frame.
+
+		    The odometry poses are the camera-to-world transformations
+		    of the depth camera in the odometry's own coordinate frame,
+		    one per frame. They are either read from a stream or file,
+		    each as the top three rows of the 4x4 matrix, or requested
+		    from a callback. If no odometry pose is available for a
+		    frame, its pose is not predicted.
+		*/
+		class ITMOdometryPosePredictor : public ITMPosePredictor
+		{
+		public:
+			/// Writes the odometry pose of the next frame to @p pose_odometry and returns true, or false if there is none.
+			typedef bool (*OdometryCallback)(Matrix4f & pose_odometry, void *userData);
+
+		private:
+			std::istream *src;
+			bool ownsSource;
+
+			OdometryCallback callback;
+			void *userData;
+
+			/// Odometry pose of the last frame.
+			Matrix4f lastPose_odometry;
+			bool hasLastPose;
+
+			bool ReadOdometryPose(Matrix4f & pose_odometry);
+
+		public:
+			void PredictPose(ITMPose *pose);
+
+			explicit ITMOdometryPosePredictor(const char *fileName);
+			explicit ITMOdometryPosePredictor(std::istream & src);
+			ITMOdometryPosePredictor(OdometryCallback callback, void *userData);
+			~ITMOdometryPosePredictor(void);
+
+			// Suppress the default copy constructor and assignment operator
+			ITMOdometryPosePredictor(const ITMOdometryPosePredictor&);
+			ITMOdometryPosePredictor& operator=(const ITMOdometryPosePredictor&);
+		};
+	}
+}
@@ -0,0 +1,149 @@
+// Copyright 2014 Isis Innovation Limited and the authors of InfiniTAM
+
+#include "ITMRelocaliser.h"
+
+#include <math.h>
+#include <string.h>
+
+using namespace ITMLib::Engine;
+
+// depth differences of this many metres or more count as a complete mismatch of two code entries
+static const float depthTolerance = 0.1f;
+
+ITMRelocaliser::ITMRelocaliser(Vector2i imgSize_d, int noMaxKeyframes, float keyframeThreshold, float maxDistance)
+{
+	this->imgSize_d = imgSize_d;
+	this->codeDims = Vector2i((imgSize_d.x + codeBlockSize - 1) / codeBlockSize, (imgSize_d.y + codeBlockSize - 1) / codeBlockSize);
+	this->codeSize = codeDims.x * codeDims.y;
+
+	this->noMaxKeyframes = noMaxKeyframes;
+	this->keyframeThreshold = keyframeThreshold;
+	this->maxDistance = maxDistance;
+
+	currentCode = new float[2 * codeSize];
+	keyframeCodes = new float[2 * codeSize * noMaxKeyframes];
+	keyframePoses = new ITMPose[noMaxKeyframes];
+
+	noKeyframes = 0; noValidPixels = 0;
+}
+
+ITMRelocaliser::~ITMRelocaliser(void)
+{
+	delete[] currentCode;
+	delete[] keyframeCodes;
+	delete[] keyframePoses;
+}
+
+void ITMRelocaliser::ComputeCode(const ITMView *view)
+{
+	const float *depth = view->depth->GetData(false);
+	const Vector4u *rgb = view->rgb->GetData(false);
+	Vector2i imgSize_rgb = view->rgb->noDims;
+
+	float *codeDepth = currentCode, *codeIntensity = currentCode + codeSize;
+	int totalValidPixels = 0;
+
+#ifdef WITH_OPENMP
+	#pragma omp parallel for reduction(+:totalValidPixels)
+#endif
+	for (int cy = 0; cy < codeDims.y; cy++) for (int cx = 0; cx < codeDims.x; cx++)
+	{
+		int x0 = cx * codeBlockSize, x1 = MIN(x0 + codeBlockSize, imgSize_d.x);
+		int y0 = cy * codeBlockSize, y1 = MIN(y0 + codeBlockSize, imgSize_d.y);
+
+		float sumDepth = 0.0f; int noValid = 0;
+		for (int y = y0; y < y1; y++) for (int x = x0; x < x1; x++)
+		{
+			float d = depth[x + y * imgSize_d.x];
+			if (d > 0.0f) { sumDepth += d; noValid++; }
+		}
+
+		// blocks with less than a quarter of valid pixels are too unreliable to compare
+		codeDepth[cx + cy * codeDims.x] = (4 * noValid >= (x1 - x0) * (y1 - y0)) ? sumDepth / noValid : -1.0f;
+		totalValidPixels += noValid;
+
+		// the same block in the colour image, which may have a different resolution
+		int rx0 = x0 * imgSize_rgb.x / imgSize_d.x, rx1 = MAX(x1 * imgSize_rgb.x / imgSize_d.x, rx0 + 1);
+		int ry0 = y0 * imgSize_rgb.y / imgSize_d.y, ry1 = MAX(y1 * imgSize_rgb.y / imgSize_d.y, ry0 + 1);
+
+		float sumIntensity = 0.0f;
+		for (int y = ry0; y < ry1; y++) for (int x = rx0; x < rx1; x++)
+		{
+			const Vector4u &c = rgb[x + y * imgSize_rgb.x];
+			sumIntensity += (float)c.r + (float)c.g + (float)c.b;
+		}
+
+		codeIntensity[cx + cy * codeDims.x] = sumIntensity / (3.0f * 255.0f * (rx1 - rx0) * (ry1 - ry0));
+	}
+
+	// removing the mean makes the intensities robust to global changes in brightness
+	float meanIntensity = 0.0f;
+	for (int i = 0; i < codeSize; i++) meanIntensity += codeIntensity[i];
+	meanIntensity /= codeSize;
+	for (int i = 0; i < codeSize; i++) codeIntensity[i] -= meanIntensity;
+
+	noValidPixels = totalValidPixels;
+}
+
+float ITMRelocaliser::Distance(const float *codeA, const float *codeB) const
+{
+	const float *intensityA = codeA + codeSize, *intensityB = codeB + codeSize;
+
+	float sum = 0.0f; int noCompared = 0;
+
+	for (int i = 0; i < codeSize; i++)
+	{
+		bool validA = codeA[i] >= 0.0f, validB = codeB[i] >= 0.0f;
+		if (!validA && !validB) continue;
+
+		noCompared++;
+
+		// a block with depth in only one of the codes is a complete mismatch
+		if (!validA || !validB) { sum += 2.0f; continue; }
+
+		sum += MIN(fabsf(codeA[i] - codeB[i]) / depthTolerance, 1.0f) + fabsf(intensityA[i] - intensityB[i]);
+	}
+
+	if (noCompared == 0) return (float)MY_INF;
+
+	return sum / noCompared;
+}
+
+int ITMRelocaliser::FindNearestKeyframe(float &distance) const
+{
+	int bestId = -1; distance = (float)MY_INF;
+
+	for (int keyframeId = 0; keyframeId < noKeyframes; keyframeId++)
+	{
+		float d = Distance(currentCode, keyframeCodes + 2 * codeSize * keyframeId);
+		if (d < distance) { distance = d; bestId = keyframeId; }
+	}
+
+	return bestId;
+}
+
+bool ITMRelocaliser::AddKeyframe(const ITMPose *pose)
+{
+	if (noKeyframes >= noMaxKeyframes || noValidPixels == 0) return false;
+
+	float distance;
+	if (FindNearestKeyframe(distance) >= 0 && distance < keyframeThreshold) return false;
+
+	memcpy(keyframeCodes + 2 * codeSize * noKeyframes, currentCode, 2 * codeSize * sizeof(float));
+	keyframePoses[noKeyframes].SetFrom(pose);
+	noKeyframes++;
+
+	return true;
+}
+
+bool ITMRelocaliser::Relocalise(ITMPose *pose) const
+{
+	float distance;
+	int keyframeId = FindNearestKeyframe(distance);
+
+	if (keyframeId < 0 || distance > maxDistance) return false;
+
+	pose->SetFrom(&keyframePoses[keyframeId]);
+
+	return true;
+}
@@ -0,0 +1,82 @@
+// Copyright 2014 Isis Innovation Limited and the authors of InfiniTAM
+
+#pragma once
+
+#include "../Utils/ITMLibDefines.h"
+
+#include "../Objects/ITMView.h"
+#include "../Objects/ITMPose.h"
+
+using namespace ITMLib::Objects;
+
+namespace ITMLib
+{
+	namespace Engine
+	{
+		/** \brief
+		    Keyframe based relocaliser.
+
+		    Every frame is summarised by a small code of block
+		    averaged depth and intensity values. While tracking
+		    works, the codes of frames that differ enough from all
+		    stored ones are kept along with their poses. Once
+		    tracking is lost, the pose of the keyframe with the
+		    most similar code is used to restart tracking.
+
+		    All computations run on the host copies of the images.
+		*/
+		class ITMRelocaliser
+		{
+		private:
+			Vector2i imgSize_d, codeDims;
+			int codeSize;
+
+			int noMaxKeyframes, noKeyframes;
+			float keyframeThreshold, maxDistance;
+
+			/// Codes of the current frame and of the keyframes: codeSize depth values, -1 where
+			/// invalid, followed by codeSize intensity values with their mean removed.
+			float *currentCode, *keyframeCodes;
+			ITMPose *keyframePoses;
+
+			int noValidPixels;
+
+			float Distance(const float *codeA, const float *codeB) const;
+
+		public:
+			/// Size of the square image blocks summarised by one entry of the code.
+			static const int codeBlockSize = 16;
+
+			/// Computes the code of the current frame, from the host copies of the depth and colour images.
+			void ComputeCode(const ITMView *view);
+
+			/// Number of valid depth pixels of the frame passed to @ref ComputeCode().
+			int GetNoValidPixels(void) const { return noValidPixels; }
+
+			int GetNoKeyframes(void) const { return noKeyframes; }
+
+			/** Stores the current code with @p pose as a new
+			    keyframe, unless a similar keyframe is stored
+			    already or the maximum number of keyframes is
+			    reached. Returns whether the keyframe was added.
+			*/
+			bool AddKeyframe(const ITMPose *pose);
+
+			/// Returns the keyframe with the code most similar to the current one, or -1 if there are none.
+			int FindNearestKeyframe(float &distance) const;
+
+			/** Sets @p pose to the pose of the most similar
+			    keyframe. Returns false and leaves @p pose
+			    unchanged if no keyframe is similar enough.
+			*/
+			bool Relocalise(ITMPose *pose) const;
+
+			ITMRelocaliser(Vector2i imgSize_d, int noMaxKeyframes, float keyframeThreshold, float maxDistance);
+			~ITMRelocaliser(void);
+
+			// Suppress the default copy constructor and assignment operator
+			ITMRelocaliser(const ITMRelocaliser&);
+			ITMRelocaliser& operator=(const ITMRelocaliser&);
+		};
+	}
+}
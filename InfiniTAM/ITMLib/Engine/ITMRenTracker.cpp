@@ -60,10 +60,8 @@ ITMRenTracker<TVoxel, TIndex>::ITMRenTracker(Vector2i imgSize, int noHierarchyLe
 { 
 	//TODO from parameters, rotationOnly not implemented
 
-	viewHierarchy = new ITMImageHierarchy<ITMTemplatedHierarchyLevel<ITMFloat4Image> >(imgSize, noHierarchyLevels, 0, useGPU);
-
-	tempImage1 = new ITMFloatImage(imgSize, useGPU);
-	tempImage2 = new ITMFloatImage(imgSize, useGPU);
+	this->noHierarchyLevels = noHierarchyLevels;
+	this->depthPyramid = NULL;
 
 	this->lowLevelEngine = lowLevelEngine;
 	this->scene = scene;
@@ -72,37 +70,14 @@ ITMRenTracker<TVoxel, TIndex>::ITMRenTracker(Vector2i imgSize, int noHierarchyLe
 template<class TVoxel, class TIndex>
 ITMRenTracker<TVoxel,TIndex>::~ITMRenTracker(void)
 {
-	delete this->viewHierarchy;
-
-	delete tempImage1;
-	delete tempImage2;
 };
 
 template<class TVoxel, class TIndex>
 void ITMRenTracker<TVoxel,TIndex>::PrepareForEvaluation(const ITMView *view)
 {
-	Vector4f intrinsics = view->calib->intrinsics_d.projectionParamsSimple.all;
-
-	this->tempImage1->noDims = view->depth->noDims;
-	this->tempImage1->dataSize = view->depth->dataSize;
-	lowLevelEngine->CopyImage(this->tempImage1, view->depth);
-
-	viewHierarchy->levels[0]->intrinsics = intrinsics;
-	UnprojectDepthToCam(view->depth, viewHierarchy->levels[0]->depth, intrinsics);
-
-	for (int i = 1; i < viewHierarchy->noLevels; i++)
-	{
-		ITMTemplatedHierarchyLevel<ITMFloat4Image> *currentLevelView = viewHierarchy->levels[i], *previousLevelView = viewHierarchy->levels[i - 1];
-		
-		lowLevelEngine->FilterSubsampleWithHoles(tempImage2, tempImage1);
-
-		currentLevelView->intrinsics = previousLevelView->intrinsics * 0.5f;
-		UnprojectDepthToCam(tempImage2, viewHierarchy->levels[i]->depth, viewHierarchy->levels[i]->intrinsics);
+	depthPyramid = lowLevelEngine->GetDepthPyramid(view, noHierarchyLevels);
 
-		this->tempImage1->noDims = this->tempImage2->noDims;
-		this->tempImage1->dataSize = this->tempImage2->dataSize;
-		lowLevelEngine->CopyImage(this->tempImage1, this->tempImage2);
-	}
+	this->PrepareViewPoints();
 }
 
 template<class TVoxel, class TIndex>
@@ -113,7 +88,7 @@ void ITMRenTracker<TVoxel,TIndex>::TrackCamera(ITMTrackingState *trackingState,
 	// // Olaf LM
 
 	//ITMPose currentPara(*trackingState->pose_d);
-	//for (int levelId = viewHierarchy->noLevels - 1; levelId >= 2; levelId--) //skips full resolution
+	//for (int levelId = noHierarchyLevels - 1; levelId >= 2; levelId--) //skips full resolution
 	//{
 	//	this->levelId = levelId;
 	//	this->rotationOnly = rotationOnly; //ignored 
@@ -174,7 +149,10 @@ void ITMRenTracker<TVoxel,TIndex>::TrackCamera(ITMTrackingState *trackingState,
 	float step[6]; Matrix4f invM, tmpM;
 	invM = trackingState->pose_d->invM;
 
-	for (int mlevelId = viewHierarchy->noLevels - 1; mlevelId >= 0; mlevelId--)
+	// the energy has no notion of inliers, so only the iterations are added to the quality reported by the ICP tracker run before
+	ITMTrackingQuality *quality = trackingState->trackingQuality;
+
+	for (int mlevelId = noHierarchyLevels - 1; mlevelId >= 0; mlevelId--)
 	{
 		this->levelId = mlevelId;
 		
@@ -183,6 +161,7 @@ void ITMRenTracker<TVoxel,TIndex>::TrackCamera(ITMTrackingState *trackingState,
 			float normal = 0.0f;
 			G_oneLevel(ATb_host, ATA_host, invM);
 			ComputeSingleStep(step, ATA_host, ATb_host, 0.0f);
+			quality->noIterations++;
 
 			for (int i = 0; i < 6; i++)
 			{
@@ -4,8 +4,7 @@
 
 #include "../Utils/ITMLibDefines.h"
 
-#include "../Objects/ITMImageHierarchy.h"
-#include "../Objects/ITMTemplatedHierarchyLevel.h"
+#include "../Objects/ITMDepthPyramid.h"
 
 #include "../Engine/ITMTracker.h"
 #include "../Engine/ITMLowLevelEngine.h"
@@ -25,8 +24,6 @@ namespace ITMLib
 			ITMTrackingState *trackingState; 
 			ITMLowLevelEngine *lowLevelEngine;
 
-			ITMFloatImage *tempImage1, *tempImage2;
-
 			const ITMView *view;
 
 			int *noIterationsPerLevel;
@@ -37,7 +34,9 @@ namespace ITMLib
 
 		protected:
 			ITMScene<TVoxel, TIndex> *scene;
-			ITMImageHierarchy<ITMTemplatedHierarchyLevel<ITMFloat4Image> > *viewHierarchy;
+			int noHierarchyLevels;
+			/// Depth pyramid of the current frame, shared with the other users of the low level engine.
+			const ITMDepthPyramid *depthPyramid;
 
 			int levelId;
 			bool rotationOnly;
@@ -48,7 +47,8 @@ namespace ITMLib
 			virtual void F_oneLevel(float *f, Matrix4f invM) = 0;
 			virtual void G_oneLevel(float *gradient, float *hessian, Matrix4f invM) const = 0;
 
-			virtual void UnprojectDepthToCam(ITMFloatImage *depth, ITMFloat4Image *upPtCloud, const Vector4f &intrinsic) = 0;
+			/// Called once per frame, after depthPyramid was set for it.
+			virtual void PrepareViewPoints(void) { }
 
 		public:
 
@@ -8,6 +8,7 @@
 
 #include "../Objects/ITMScene.h"
 #include "../Objects/ITMView.h"
+#include "../Objects/ITMDepthPyramid.h"
 #include "../Objects/ITMTrackingState.h"
 
 using namespace ITMLib::Objects;
@@ -31,8 +32,11 @@ namespace ITMLib
 			/** Given a view with a new depth image, compute the
 			    visible blocks, allocate them and update the hash
 			    table so that the new image data can be integrated.
+			    The back projected depths are read from the finest
+			    level of @p depthPyramid, built for the same view.
 			*/
-			virtual void AllocateSceneFromDepth(ITMScene<TVoxel,TIndex> *scene, const ITMView *view, const ITMPose *pose) = 0;
+			virtual void AllocateSceneFromDepth(ITMScene<TVoxel,TIndex> *scene, const ITMView *view, const ITMPose *pose,
+				const ITMDepthPyramid *depthPyramid) = 0;
 
 			/** Update the voxel blocks by integrating depth and
 			    possibly colour information from the given view.
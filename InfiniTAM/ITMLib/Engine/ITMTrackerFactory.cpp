@@ -10,6 +10,10 @@ using namespace ITMLib::Engine;
 
 ITMTracker *ITMTrackerFactory::MakePrimaryTracker(const ITMLibSettings& settings, const Vector2i& imgSize_rgb, const Vector2i& imgSize_d, ITMLowLevelEngine *lowLevelEngine)
 {
+  // the per level settings, such as depthTrackerNoIterationsPerLevel, only have maxNoHierarchyLevels entries
+  if(settings.noHierarchyLevels < 1 || settings.noHierarchyLevels > ITMLibSettings::maxNoHierarchyLevels)
+    throw std::runtime_error("Error: ITMTrackerFactory::MakePrimaryTracker: noHierarchyLevels must be between 1 and ITMLibSettings::maxNoHierarchyLevels");
+
   if(settings.useGPU)
   {
 #ifndef COMPILE_WITHOUT_CUDA
@@ -17,9 +21,11 @@ ITMTracker *ITMTrackerFactory::MakePrimaryTracker(const ITMLibSettings& settings
     {
     case ITMLibSettings::TRACKER_ICP:
     case ITMLibSettings::TRACKER_REN:
-      return new ITMDepthTracker_CUDA(imgSize_d, settings.noHierarchyLevels, settings.noRotationOnlyLevels, settings.noICPRunTillLevel, settings.depthTrackerICPThreshold, lowLevelEngine);
+      return new ITMDepthTracker_CUDA(imgSize_d, settings.noHierarchyLevels, settings.noRotationOnlyLevels, settings.noICPRunTillLevel, settings.depthTrackerICPThreshold,
+        settings.depthTrackerNoIterationsPerLevel, settings.depthTrackerStepThreshold, settings.depthTrackerResidualThreshold, settings.depthTrackerMinNoInliers, lowLevelEngine);
     case ITMLibSettings::TRACKER_COLOR:
-      return new ITMColorTracker_CUDA(imgSize_rgb, settings.noHierarchyLevels, settings.noRotationOnlyLevels, lowLevelEngine);
+      return new ITMColorTracker_CUDA(imgSize_rgb, settings.noHierarchyLevels, settings.noRotationOnlyLevels, lowLevelEngine,
+        settings.colorTrackerFixedJacobians, settings.colorTrackerUseLuminance);
     default:
       throw std::runtime_error("Error: ITMTrackerFactory::MakePrimaryTracker: Unknown tracker type");
     }
@@ -34,9 +40,12 @@ ITMTracker *ITMTrackerFactory::MakePrimaryTracker(const ITMLibSettings& settings
     {
     case ITMLibSettings::TRACKER_ICP:
     case ITMLibSettings::TRACKER_REN:
-      return new ITMDepthTracker_CPU(imgSize_d, settings.noHierarchyLevels, settings.noRotationOnlyLevels, settings.noICPRunTillLevel, settings.depthTrackerICPThreshold, lowLevelEngine);
+      return new ITMDepthTracker_CPU(imgSize_d, settings.noHierarchyLevels, settings.noRotationOnlyLevels, settings.noICPRunTillLevel, settings.depthTrackerICPThreshold,
+        settings.depthTrackerNoIterationsPerLevel, settings.depthTrackerStepThreshold, settings.depthTrackerResidualThreshold, settings.depthTrackerMinNoInliers, lowLevelEngine,
+        settings.depthTrackerPointBudget);
     case ITMLibSettings::TRACKER_COLOR:
-      return new ITMColorTracker_CPU(imgSize_rgb, settings.noHierarchyLevels, settings.noRotationOnlyLevels, lowLevelEngine);
+      return new ITMColorTracker_CPU(imgSize_rgb, settings.noHierarchyLevels, settings.noRotationOnlyLevels, lowLevelEngine,
+        settings.colorTrackerFixedJacobians, settings.colorTrackerUseLuminance);
     default:
       throw std::runtime_error("Error: ITMTrackerFactory::MakePrimaryTracker: Unknown tracker type");
     }
@@ -45,5 +54,5 @@ ITMTracker *ITMTrackerFactory::MakePrimaryTracker(const ITMLibSettings& settings
 
 ITMTrackingState *ITMTrackerFactory::MakeTrackingState(const ITMLibSettings& settings, const Vector2i& imgSize_rgb, const Vector2i& imgSize_d)
 {
-  return new ITMTrackingState(settings.trackerType == ITMLibSettings::TRACKER_COLOR ? imgSize_rgb : imgSize_d, settings.useGPU);
+  return new ITMTrackingState(settings.trackerType == ITMLibSettings::TRACKER_COLOR ? imgSize_rgb : imgSize_d, settings.noHierarchyLevels, settings.useGPU);
 }
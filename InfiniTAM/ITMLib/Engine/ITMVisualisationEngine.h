@@ -58,6 +58,30 @@ namespace ITMLib
 			/** This will render an image using raycasting. */
 			virtual void RenderImage(const ITMScene<TVoxel,TIndex> *scene, const ITMPose *pose, const ITMIntrinsics *intrinsics, const ITMVisualisationState *state, ITMUChar4Image *outputImage, bool useColour) = 0;
 
+			/** Render images of the scene from several views at
+			    once, each given by an entry of @p poses and
+			    @p intrinsics, into the host memory of the
+			    corresponding, correctly sized @p outputImages.
+			    Engines without a specialised implementation render
+			    one view after the other.
+			*/
+			virtual void RenderImages(const ITMScene<TVoxel,TIndex> *scene, int noViews, const ITMPose *poses, const ITMIntrinsics *intrinsics, ITMUChar4Image **outputImages, bool useColour)
+			{
+				for (int viewId = 0; viewId < noViews; viewId++)
+				{
+					ITMVisualisationState *state = allocateInternalState(outputImages[viewId]->noDims);
+
+					FindVisibleBlocks(scene, &(poses[viewId]), &(intrinsics[viewId]), state);
+					CreateExpectedDepths(scene, &(poses[viewId]), &(intrinsics[viewId]), state->minmaxImage, state);
+					RenderImage(scene, &(poses[viewId]), &(intrinsics[viewId]), state, state->outputImage, useColour);
+
+					state->outputImage->UpdateHostFromDevice();
+					outputImages[viewId]->SetFrom(state->outputImage);
+
+					delete state;
+				}
+			}
+
 			/** Create a point cloud as required by the
 			    ITMLib::Engine::ITMColorTracker classes.
 			*/
@@ -68,6 +92,37 @@ namespace ITMLib
 			    classes.
 			*/
 			virtual void CreateICPMaps(const ITMScene<TVoxel,TIndex> *scene, const ITMView *view, ITMTrackingState *trackingState) = 0;
+
+			/** Create the images of reference points and normals
+			    like CreateICPMaps(), but only raycast the points
+			    and compute the normals from neighbouring points
+			    in a second pass over the image instead of from
+			    the SDF gradient. Engines without support for this
+			    use the SDF gradient.
+			*/
+			virtual void CreateICPMapsWithPointNormals(const ITMScene<TVoxel,TIndex> *scene, const ITMView *view, ITMTrackingState *trackingState)
+			{ CreateICPMaps(scene, view, trackingState); }
+
+			/** Create the images of reference points and normals
+			    like CreateICPMaps(), but only raycast every
+			    @p subsample-th pixel in each direction. The pixels
+			    in between are interpolated where the surrounding
+			    samples lie on one smooth surface and raycast
+			    otherwise. Engines without support for this
+			    raycast every pixel.
+			*/
+			virtual void CreateICPMapsSubsampled(const ITMScene<TVoxel,TIndex> *scene, const ITMView *view, ITMTrackingState *trackingState, int subsample)
+			{ CreateICPMaps(scene, view, trackingState); }
+
+			/** Update the images of reference points and normals
+			    for the current pose by forward projecting the
+			    ones created at trackingState->pose_pointCloud.
+			    Only the pixels that cannot be filled this way are
+			    raycast. Engines without support for this create
+			    the maps from scratch.
+			*/
+			virtual void ForwardRenderICPMaps(const ITMScene<TVoxel,TIndex> *scene, const ITMView *view, ITMTrackingState *trackingState)
+			{ CreateICPMaps(scene, view, trackingState); }
 		};
 	}
 }
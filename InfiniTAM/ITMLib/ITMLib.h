@@ -52,6 +52,9 @@
 #include "Engine/DeviceSpecific/CUDA/ITMRenTracker_CUDA.h"
 #endif
 
+#include "Engine/ITMRelocaliser.h"
+#include "Engine/ITMPosePredictor.h"
+
 #include "Engine/ITMVisualisationEngine.h"
 #include "Engine/ITMMainEngine.h"
 
@@ -0,0 +1,87 @@
+// Copyright 2014 Isis Innovation Limited and the authors of InfiniTAM
+
+#pragma once
+
+#include "../Objects/ITMImage.h"
+#include "../Objects/ITMImageHierarchy.h"
+
+namespace ITMLib
+{
+	namespace Objects
+	{
+		/** \brief
+		    One resolution level of an ITMDepthPyramid.
+		*/
+		class ITMDepthPyramidLevel
+		{
+		public:
+			int levelId;
+
+			bool rotationOnly;
+
+			/// Depth in metres, zero where it is invalid
+			ITMFloatImage *depth;
+			/// Depths back projected to camera coordinates, w is 1 where the depth is valid and -1 where it is not
+			ITMFloat4Image *points;
+			Vector4f intrinsics;
+
+			/// Number of pixels with a valid depth
+			int noValidDepths;
+
+			/// @p imgSize is the size of the finest level, each level is allocated at its own size
+			ITMDepthPyramidLevel(Vector2i imgSize, int levelId, bool rotationOnly, bool useGPU)
+			{
+				this->levelId = levelId;
+				this->rotationOnly = rotationOnly;
+
+				Vector2i levelSize(imgSize.x >> levelId, imgSize.y >> levelId);
+				this->depth = new ITMFloatImage(levelSize, useGPU);
+				this->points = new ITMFloat4Image(levelSize, useGPU);
+
+				this->noValidDepths = 0;
+			}
+
+			void UpdateHostFromDevice()
+			{
+				this->depth->UpdateHostFromDevice();
+				this->points->UpdateHostFromDevice();
+			}
+
+			void UpdateDeviceFromHost()
+			{
+				this->depth->UpdateDeviceFromHost();
+				this->points->UpdateDeviceFromHost();
+			}
+
+			~ITMDepthPyramidLevel(void)
+			{
+				delete depth;
+				delete points;
+			}
+
+			// Suppress the default copy constructor and assignment operator
+			ITMDepthPyramidLevel(const ITMDepthPyramidLevel&);
+			ITMDepthPyramidLevel& operator=(const ITMDepthPyramidLevel&);
+		};
+
+		/** \brief
+		    The depth image of one frame at several resolutions,
+		    each level half the size of the previous one, with
+		    the back projected points and valid pixels of each
+		    level. It is built once per frame by the low level
+		    engine and shared by the trackers and the allocation.
+		*/
+		class ITMDepthPyramid : public ITMImageHierarchy<ITMDepthPyramidLevel>
+		{
+		public:
+			/// ID of the frame the pyramid was built for, see ITMView::frameId, -1 if it was not built yet
+			int frameId;
+
+			ITMDepthPyramid(Vector2i imgSize, int noLevels, bool useGPU)
+				: ITMImageHierarchy<ITMDepthPyramidLevel>(imgSize, noLevels, 0, useGPU)
+			{
+				frameId = -1;
+			}
+		};
+	}
+}
@@ -33,6 +33,13 @@ namespace ITMLib
 			    being processed by integration and tracker.
 			*/
 			int liveEntryIDs[SDF_LOCAL_BLOCK_NUM];
+			/** A compact list of all entries that currently
+			    own a block in the local voxel block array.
+			    It is kept up to date by allocation and
+			    swapping, so that visibility checks do not
+			    have to sweep the whole hash table.
+			*/
+			int allocatedEntryIDs[SDF_LOCAL_BLOCK_NUM];
 			/** A list of "visible entries", that are
 			    currently being processed by integration
 			    and tracker.
@@ -0,0 +1,62 @@
+// Copyright 2014 Isis Innovation Limited and the authors of InfiniTAM
+
+#pragma once
+
+#include "../Objects/ITMImage.h"
+
+namespace ITMLib
+{
+	namespace Objects
+	{
+		/** \brief
+		    One resolution level of the luminance of a colour image,
+		    with its gradients, for colour tracking on a single
+		    channel.
+		*/
+		class ITMIntensityHierarchyLevel
+		{
+		public:
+			int levelId;
+
+			bool rotationOnly;
+
+			/// Luminance of the colour image, see ITMLowLevelEngine::ConvertColourToIntensity
+			ITMUCharImage *intensity;
+			/// Horizontal and vertical gradients of the luminance in x and y
+			ITMShort2Image *gradients;
+
+			/// @p imgSize is the size of the finest level, each level is allocated at its own size
+			ITMIntensityHierarchyLevel(Vector2i imgSize, int levelId, bool rotationOnly, bool useGPU)
+			{
+				this->levelId = levelId;
+				this->rotationOnly = rotationOnly;
+
+				Vector2i levelSize(imgSize.x >> levelId, imgSize.y >> levelId);
+				this->intensity = new ITMUCharImage(levelSize, useGPU);
+				this->gradients = new ITMShort2Image(levelSize, useGPU);
+			}
+
+			void UpdateHostFromDevice()
+			{
+				this->intensity->UpdateHostFromDevice();
+				this->gradients->UpdateHostFromDevice();
+			}
+
+			void UpdateDeviceFromHost()
+			{
+				this->intensity->UpdateDeviceFromHost();
+				this->gradients->UpdateDeviceFromHost();
+			}
+
+			~ITMIntensityHierarchyLevel(void)
+			{
+				delete intensity;
+				delete gradients;
+			}
+
+			// Suppress the default copy constructor and assignment operator
+			ITMIntensityHierarchyLevel(const ITMIntensityHierarchyLevel&);
+			ITMIntensityHierarchyLevel& operator=(const ITMIntensityHierarchyLevel&);
+		};
+	}
+}
@@ -0,0 +1,71 @@
+// Copyright 2014 Isis Innovation Limited and the authors of InfiniTAM
+
+#pragma once
+
+#include <string.h>
+
+namespace ITMLib
+{
+	namespace Objects
+	{
+		/** \brief
+		    Per-frame statistics of the ICP depth tracker, one entry
+		    per resolution level with the finest level first. Levels
+		    that were not tracked keep zero iterations.
+		*/
+		class ITMTrackerStatistics
+		{
+		public:
+			/// Number of resolution levels the statistics are kept for
+			int noLevels;
+
+			/// Number of iterations run on each level
+			int *noIterationsPerLevel;
+			/// Number of inliers in the last iteration on each level
+			int *noInliersPerLevel;
+			/// Mean squared point-to-plane residual in the last iteration on each level
+			float *residualPerLevel;
+			/// Time spent on each level in milliseconds
+			float *timePerLevel;
+
+			/// Number of inliers in the last iteration on the finest level tracked
+			int noInliers;
+			/// Mean squared point-to-plane residual in the last iteration on the finest level tracked
+			float residual;
+
+			void Reset(void)
+			{
+				memset(noIterationsPerLevel, 0, sizeof(int) * noLevels);
+				memset(noInliersPerLevel, 0, sizeof(int) * noLevels);
+				memset(residualPerLevel, 0, sizeof(float) * noLevels);
+				memset(timePerLevel, 0, sizeof(float) * noLevels);
+
+				noInliers = 0; residual = 0.0f;
+			}
+
+			ITMTrackerStatistics(int noLevels)
+			{
+				this->noLevels = noLevels;
+
+				noIterationsPerLevel = new int[noLevels];
+				noInliersPerLevel = new int[noLevels];
+				residualPerLevel = new float[noLevels];
+				timePerLevel = new float[noLevels];
+
+				this->Reset();
+			}
+
+			~ITMTrackerStatistics(void)
+			{
+				delete[] noIterationsPerLevel;
+				delete[] noInliersPerLevel;
+				delete[] residualPerLevel;
+				delete[] timePerLevel;
+			}
+
+			// Suppress the default copy constructor and assignment operator
+			ITMTrackerStatistics(const ITMTrackerStatistics&);
+			ITMTrackerStatistics& operator=(const ITMTrackerStatistics&);
+		};
+	}
+}
@@ -0,0 +1,57 @@
+// Copyright 2014 Isis Innovation Limited and the authors of InfiniTAM
+
+#pragma once
+
+namespace ITMLib
+{
+	namespace Objects
+	{
+		/** \brief
+		    Per-frame summary of how well the trackers aligned the
+		    current frame. The trackers fill in the measures, the
+		    ITMLib::Engine::ITMMainEngine classifies the frame from
+		    them. Measures a tracker cannot provide keep the values
+		    set by @ref Reset().
+		*/
+		class ITMTrackingQuality
+		{
+		public:
+			/// Classification of the tracking result
+			typedef enum {
+				//! The frame was tracked well
+				TRACKING_GOOD,
+				//! The pose is probably usable, but should not be trusted for mapping
+				TRACKING_POOR,
+				//! Tracking failed, the pose is most likely wrong
+				TRACKING_FAILED
+			} TrackingResult;
+			TrackingResult result;
+
+			/// Fraction of the valid pixels (depth trackers) or scene points (colour tracker) that were inliers in the last iteration
+			float inlierRatio;
+			/// Mean squared residual of the inliers in the last iteration
+			float residual;
+			/** Estimated condition number of the Gauss-Newton
+			    Hessian in the last iteration, with its rotation and
+			    translation blocks scaled to unit mean diagonal (see
+			    ITMCholesky::PoseConditionEstimate()), so that it
+			    does not depend on the depth of the scene. Large
+			    values mean that the scene barely constrains some
+			    direction of motion, e.g. when looking at a single
+			    plane.
+			*/
+			float hessianCondition;
+			/// Total number of iterations of all trackers on all levels
+			int noIterations;
+
+			void Reset(void)
+			{
+				result = TRACKING_GOOD;
+				inlierRatio = 1.0f; residual = 0.0f; hessianCondition = 1.0f;
+				noIterations = 0;
+			}
+
+			ITMTrackingQuality(void) { this->Reset(); }
+		};
+	}
+}
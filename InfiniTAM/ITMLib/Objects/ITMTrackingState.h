@@ -8,6 +8,8 @@
 #include "ITMImage.h"
 #include "ITMPointCloud.h"
 #include "ITMScene.h"
+#include "ITMTrackerStatistics.h"
+#include "ITMTrackingQuality.h"
 
 namespace ITMLib
 {
@@ -51,12 +53,39 @@ namespace ITMLib
 			/// Current pose of the depth camera.
 			ITMPose *pose_d;
 
-			ITMTrackingState(Vector2i imgSize, bool useGPU)
+			/// Pose of the depth camera at which @ref pointCloud was created.
+			ITMPose *pose_pointCloud;
+			/** Number of frames since @ref pointCloud was last
+			    created by a full raycast, or -1 if it has not
+			    been created yet.
+			*/
+			int age_pointCloud;
+			/** Whether @ref pointCloud was built from the depth
+			    image of the last frame for frame-to-frame
+			    tracking, rather than raycast from the scene.
+			*/
+			bool pointCloudFromDepth;
+
+			/// Statistics of the last run of the ICP depth tracker.
+			ITMTrackerStatistics *trackerStats;
+
+			/** Quality of the tracking result of the current
+			    frame. Reset by the ITMLib::Engine::ITMMainEngine
+			    before the trackers run.
+			*/
+			ITMTrackingQuality *trackingQuality;
+
+			ITMTrackingState(Vector2i imgSize, int noHierarchyLevels, bool useGPU)
 			{
 				this->rendering = new ITMUChar4Image(imgSize, useGPU);
 				this->renderingRangeImage = new ITMImage<Vector2f>(imgSize, useGPU);
 				this->pointCloud = new ITMPointCloud(imgSize, useGPU);
 				this->pose_d = new ITMPose();
+				this->pose_pointCloud = new ITMPose();
+				this->age_pointCloud = -1;
+				this->pointCloudFromDepth = false;
+				this->trackerStats = new ITMTrackerStatistics(noHierarchyLevels);
+				this->trackingQuality = new ITMTrackingQuality();
 			}
 
 			~ITMTrackingState(void)
@@ -65,6 +94,9 @@ namespace ITMLib
 				delete renderingRangeImage;
 				delete rendering;
 				delete pose_d;
+				delete pose_pointCloud;
+				delete trackerStats;
+				delete trackingQuality;
 			}
 
 			// Suppress the default copy constructor and assignment operator
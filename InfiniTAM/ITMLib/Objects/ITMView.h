@@ -41,6 +41,9 @@ namespace ITMLib
 			/// Raw disparity image, if available according to @ref inputImageType.
 			ITMShortImage *rawDepth; 
 
+			/// Incremented for every new frame, so that data derived from the images can be cached per frame.
+			int frameId;
+
 			ITMView(const ITMRGBDCalib & calib, Vector2i imgSize_rgb, Vector2i imgSize_d, bool useGPU)
 			{
 				this->calib = new ITMRGBDCalib(calib);
@@ -50,6 +53,8 @@ namespace ITMLib
 
 				this->rawDepth = new ITMShortImage(imgSize_d, useGPU);
 				this->inputImageType = InfiniTAM_DISPARITY_IMAGE;
+
+				this->frameId = 0;
 			}
 
 			~ITMView(void)
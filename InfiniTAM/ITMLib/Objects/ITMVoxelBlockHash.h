@@ -42,6 +42,8 @@ namespace ITMLib
 			public:
 			/** Number of entries in the live list. */
 			int noLiveEntries;
+			/** Number of entries in the allocated list. */
+			int noAllocatedEntries;
 
 			int lastFreeExcessListId;
 
@@ -62,6 +64,7 @@ namespace ITMLib
 				}
 				else hashData = hashData_host;
 				lastFreeExcessListId = SDF_EXCESS_LIST_SIZE - 1;
+				noAllocatedEntries = 0;
 			}
 
 			~ITMVoxelBlockHash(void)	
@@ -86,6 +89,12 @@ namespace ITMLib
 			*/
 			const int *GetLiveEntryIDs(void) const { return hashData->liveEntryIDs; }
 			int *GetLiveEntryIDs(void) { return hashData->liveEntryIDs; }
+			/** Get the list of entries that currently own a
+			    block in the local voxel block array. This is
+			    only maintained by the CPU engines.
+			*/
+			const int *GetAllocatedEntryIDs(void) const { return hashData->allocatedEntryIDs; }
+			int *GetAllocatedEntryIDs(void) { return hashData->allocatedEntryIDs; }
 			/** Get the list of "visible entries", that are
 			    currently processed by integration and tracker.
 			*/
@@ -2,23 +2,32 @@
 
 #pragma once
 
-#include <vector>
+#include <float.h>
+#include <math.h>
 
 namespace ITMLib
 {
 	namespace Utils
 	{
+		/** Cholesky decomposition of a symmetric size x size matrix,
+		    using fixed storage for up to maxSize x maxSize entries so
+		    that the trackers can solve their normal equations without
+		    allocating memory.
+		*/
 		class ITMCholesky
 		{
+		public:
+			/// Largest supported matrix size, enough for a 6 DoF pose
+			static const int maxSize = 6;
+
 		private:
-			std::vector<float> cholesky;
+			float cholesky[maxSize * maxSize];
 			int size, rank;
 
 		public:
 			ITMCholesky(const float *mat, int size)
 			{
 				this->size = size;
-				this->cholesky.resize(size*size);
 
 				for (int i = 0; i < size * size; i++) cholesky[i] = mat[i];
 
@@ -50,7 +59,7 @@ namespace ITMLib
 
 			void Backsub(float *result, const float *v) const
 			{
-				std::vector<float> y(size);
+				float y[maxSize];
 				for (int i = 0; i < size; i++)
 				{
 					float val = v[i];
@@ -68,6 +77,54 @@ namespace ITMLib
 				}
 			}
 
+			/** Ratio of the largest to the smallest pivot of the
+			    decomposition, a cheap lower bound of the condition
+			    number of the matrix. FLT_MAX if the matrix is not
+			    positive definite.
+			*/
+			float ConditionEstimate(void) const
+			{
+				float minPivot = cholesky[0], maxPivot = cholesky[0];
+				for (int i = 1; i < size; i++)
+				{
+					float pivot = cholesky[i + i * size];
+					if (pivot < minPivot) minPivot = pivot;
+					if (pivot > maxPivot) maxPivot = pivot;
+				}
+
+				if (!(minPivot > 0.0f)) return FLT_MAX;
+				return maxPivot / minPivot;
+			}
+
+			/** ConditionEstimate() of the pose Hessian @p mat after
+			    Jacobi scaling by parameter blocks: D^-1/2 mat D^-1/2,
+			    where D holds the mean diagonal entry of each block of
+			    three parameters, i.e. the rotations and the
+			    translations. Unscaled, the rotation block grows with
+			    the squared depth of the points and the translation
+			    block does not. The blocks are not scaled per entry,
+			    as that would also scale up a direction the scene does
+			    not constrain and hide the degeneracy.
+			*/
+			static float PoseConditionEstimate(const float *mat, int size)
+			{
+				float scaled[maxSize * maxSize], scale[maxSize];
+
+				for (int b = 0; b < size; b += 3)
+				{
+					float meanDiag = 0.0f;
+					for (int i = b; i < b + 3 && i < size; i++) meanDiag += mat[i + i * size];
+					meanDiag /= (float)(size - b < 3 ? size - b : 3);
+
+					if (!(meanDiag > 0.0f)) return FLT_MAX;
+					for (int i = b; i < b + 3 && i < size; i++) scale[i] = 1.0f / sqrtf(meanDiag);
+				}
+
+				for (int r = 0; r < size; r++) for (int c = 0; c < size; c++) scaled[r + c * size] = mat[r + c * size] * scale[r] * scale[c];
+
+				return ITMCholesky(scaled, size).ConditionEstimate();
+			}
+
 			~ITMCholesky(void)
 			{
 			}
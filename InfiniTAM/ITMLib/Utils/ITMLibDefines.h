@@ -82,6 +82,7 @@ struct ITMVoxel_f_rgb
 	_CPU_AND_GPU_CODE_ static float SDF_floatToValue(float x) { return x; }
 
 	static const bool hasColorInformation = true;
+	static const bool hasIDInformation = false;
 
 	/** Value of the truncated signed distance transformation. */
 	float sdf;
@@ -111,6 +112,7 @@ struct ITMVoxel_s_rgb
 	_CPU_AND_GPU_CODE_ static short SDF_floatToValue(float x) { return (short)((x) * 32767.0f); }
 
 	static const bool hasColorInformation = true;
+	static const bool hasIDInformation = false;
 
 	/** Value of the truncated signed distance transformation. */
 	short sdf;
@@ -139,6 +141,7 @@ struct ITMVoxel_s
 	_CPU_AND_GPU_CODE_ static short SDF_floatToValue(float x) { return (short)((x) * 32767.0f); }
 
 	static const bool hasColorInformation = false;
+	static const bool hasIDInformation = false;
 
 	/** Value of the truncated signed distance transformation. */
 	short sdf;
@@ -162,6 +165,7 @@ struct ITMVoxel_f
 	_CPU_AND_GPU_CODE_ static float SDF_floatToValue(float x) { return x; }
 
 	static const bool hasColorInformation = false;
+	static const bool hasIDInformation = false;
 
 	/** Value of the truncated signed distance transformation. */
 	float sdf;
@@ -186,6 +190,7 @@ struct ITMVoxel_s_ID
 	_CPU_AND_GPU_CODE_ static short SDF_floatToValue(float x) { return (short)((x)* 32767.0f); }
 
 	static const bool hasColorInformation = false;
+	static const bool hasIDInformation = true;
 
 	/** Value of the truncated signed distance transformation. */
 	short sdf;
@@ -238,6 +243,10 @@ typedef ITMLib::Objects::ITMVoxelBlockHash ITMVoxelIndex;
 #define ITMShortImage ITMImage<short>
 #endif
 
+#ifndef ITMShort2Image
+#define ITMShort2Image ITMImage<Vector2s>
+#endif
+
 #ifndef ITMShort3Image
 #define ITMShort3Image ITMImage<Vector3s>
 #endif
@@ -15,9 +15,60 @@ ITMLibSettings::ITMLibSettings(void)
 	/// depth threashold for the ICP tracker
 	depthTrackerICPThreshold = 0.1f * 0.1f;
 
+	/// ICP schedule, more iterations on the coarser levels where they are cheap
+	for (int levelId = 0; levelId < maxNoHierarchyLevels; levelId++) depthTrackerNoIterationsPerLevel[levelId] = 2 + 2 * levelId;
+	depthTrackerStepThreshold = 1e-3f;
+	depthTrackerResidualThreshold = 0.0f;
+	depthTrackerMinNoInliers = 1;
+
+	/// uses every valid pixel, a budget of a few thousand points keeps most of the accuracy at a fraction of the cost
+	depthTrackerPointBudget = 0;
+
+	/// normals from the SDF gradient are more accurate, those from neighbouring points cheaper
+	icpNormalsType = NORMALS_FROM_SDF;
+
+	/// raycasts the ICP maps at full resolution, larger values trade tracking accuracy for speed
+	icpMapsRaycastSubsample = 1;
+
+	/// reuses the previous ICP maps by forward projection for slow camera motion
+	useICPMapsForwardProjection = false;
+	icpMapsFullRaycastInterval = 10;
+	icpMapsMaxTranslation = 0.05f;
+	icpMapsMaxRotation = 0.1f;
+
+	/// tracks against the scene model, frame-to-frame tracking saves most raycasts at the expense of drift
+	useFrameToFrameTracking = false;
+	frameToFrameRaycastInterval = 5;
+	frameToFrameMaxNormalDist = 0.05f;
+
+	/// starts tracking from the previous pose, constant velocity prediction helps with fast camera motion
+	posePredictorType = POSE_PREDICTOR_NONE;
+
+	/// frames with few inliers or a nearly degenerate scene geometry are tracked poorly
+	trackingPoorMinInlierRatio = 0.3f;
+	/// three orthogonal planes give about 15, a floor and a wall with a few objects about 100,
+	/// a single plane or two planes from several hundred with very noisy normals to thousands
+	trackingPoorMaxHessianCondition = 500.0f;
+	trackingFailedMinInlierRatio = 0.1f;
+
+	/// keeps frames with a failed tracking out of the scene
+	integrationPolicy = INTEGRATE_UNLESS_FAILED;
+
+	/// off by default, so tracking behaves as before unless relocalisation is asked for
+	useRelocalisation = false;
+	relocaliserKeyframeThreshold = 0.1f;
+	relocaliserMaxDistance = 0.3f;
+	relocaliserMaxNoKeyframes = 1000;
+
 	/// skips every other point when using the colour tracker
 	skipPoints = true;
 
+	/// recomputes the Jacobians of the colour tracker at every step
+	colorTrackerFixedJacobians = false;
+
+	/// tracks all three colour channels with the colour tracker
+	colorTrackerUseLuminance = false;
+
 #ifndef COMPILE_WITHOUT_CUDA
 	useGPU = true;
 #else
@@ -29,6 +29,9 @@ namespace ITMLib
 			/// Select the type of tracker to use
 			TrackerType trackerType;
 
+			/// Maximum number of resolution levels for the tracker.
+			static const int maxNoHierarchyLevels = 8;
+
 			/// Number of resolution levels for the tracker.
 			int noHierarchyLevels;
 
@@ -40,10 +43,99 @@ namespace ITMLib
 
 			/// For ITMColorTracker: skip every other point in energy function evaluation.
 			bool skipPoints;
+			/// For ITMColorTracker: Gauss-Newton with Jacobians frozen at the level's initial pose. The Jacobians and
+			/// Hessian are computed once per resolution level and each step only warps the points, instead of
+			/// Levenberg-Marquardt with Jacobians recomputed at every step.
+			bool colorTrackerFixedJacobians;
+			/// For ITMColorTracker: track an 8-bit luminance image with a single gradient image per level
+			/// instead of the RGB image and its per-channel gradients.
+			bool colorTrackerUseLuminance;
 
 			/// For ITMDepthTracker: ICP distance threshold
 			float depthTrackerICPThreshold;
 
+			/// For ITMDepthTracker: maximum number of iterations on each resolution level, finest level first.
+			int depthTrackerNoIterationsPerLevel[maxNoHierarchyLevels];
+			/// For ITMDepthTracker: a level has converged once the step length drops below this ...
+			float depthTrackerStepThreshold;
+			/// ... or the mean squared residual improves by less than this fraction, 0 disables the test.
+			float depthTrackerResidualThreshold;
+			/// For ITMDepthTracker: stop iterating on a level if fewer points than this are inliers.
+			int depthTrackerMinNoInliers;
+			/// For ITMDepthTracker on the CPU: maximum number of pixels per level, spread over the normal directions, 0 uses all.
+			int depthTrackerPointBudget;
+
+			/// Normal types for the ICP maps
+			typedef enum {
+				//! Normals from the gradient of the SDF at each raycast point
+				NORMALS_FROM_SDF,
+				//! Normals from neighbouring points of the raycast image
+				NORMALS_FROM_POINTS
+			} ICPNormalsType;
+			/// Select how the normals of the ICP maps are computed
+			ICPNormalsType icpNormalsType;
+
+			/// Raycast the ICP maps at 1/2 or 1/4 resolution by setting this to 2 or 4 and upsample
+			/// them to full resolution, 1 raycasts every pixel. Takes precedence over icpNormalsType.
+			int icpMapsRaycastSubsample;
+
+			/// Forward project the previous ICP maps and only raycast the pixels that could not be filled.
+			bool useICPMapsForwardProjection;
+			/// Force a full raycast of the ICP maps after this number of forward projected frames.
+			int icpMapsFullRaycastInterval;
+			/// Force a full raycast of the ICP maps if the camera moved further than this (in metres) ...
+			float icpMapsMaxTranslation;
+			/// ... or rotated by more than this (in radians) since the last ICP maps were created.
+			float icpMapsMaxRotation;
+
+			/// Track against ICP maps built from the depth image of the previous frame instead of a raycast of
+			/// the scene, except after a raycast interval or if tracking of the previous frame was not good.
+			bool useFrameToFrameTracking;
+			/// Raycast the ICP maps from the scene after this number of frames tracked frame-to-frame.
+			int frameToFrameRaycastInterval;
+			/// Neighbouring points of the depth image further apart than this (in metres) lie across a discontinuity and give no normal.
+			float frameToFrameMaxNormalDist;
+
+			/// Pose predictor types
+			typedef enum {
+				//! Tracking starts from the pose of the previous frame
+				POSE_PREDICTOR_NONE,
+				//! Tracking starts from the pose extrapolated from the motion between the last two frames
+				POSE_PREDICTOR_CONSTANT_VELOCITY
+			} PosePredictorType;
+			/// Select how the pose of a new frame is predicted before tracking. External odometry
+			/// can be used instead with ITMMainEngine::SetPosePredictor().
+			PosePredictorType posePredictorType;
+
+			/// Tracking of a frame is poor if the inlier ratio reported by the trackers is below this ...
+			float trackingPoorMinInlierRatio;
+			/// ... or the estimated condition number of the Hessian, scaled as described for
+			/// ITMTrackingQuality::hessianCondition, exceeds this.
+			float trackingPoorMaxHessianCondition;
+			/// Tracking of a frame has failed if the inlier ratio is below this.
+			float trackingFailedMinInlierRatio;
+
+			/// Integration policies
+			typedef enum {
+				//! Integrate every frame
+				INTEGRATE_ALWAYS,
+				//! Integrate every frame unless tracking failed
+				INTEGRATE_UNLESS_FAILED,
+				//! Only integrate frames that were tracked well
+				INTEGRATE_ONLY_GOOD
+			} IntegrationPolicy;
+			/// Select which frames are integrated into the scene, depending on the quality of their tracking
+			IntegrationPolicy integrationPolicy;
+
+			/// Store keyframes while tracking and restart from the most similar one when tracking failed.
+			bool useRelocalisation;
+			/// A frame becomes a keyframe if its code differs from those of all keyframes by more than this ...
+			float relocaliserKeyframeThreshold;
+			/// ... and a keyframe is only used for relocalisation if its code differs by less than this.
+			float relocaliserMaxDistance;
+			/// Maximum number of keyframes stored by the relocaliser.
+			int relocaliserMaxNoKeyframes;
+
 			/// Further, scene specific parameters such as voxel size
 			ITMLib::Objects::ITMSceneParams sceneParams;
 
@@ -0,0 +1,69 @@
+// Copyright 2014 Isis Innovation Limited and the authors of InfiniTAM
+
+#pragma once
+
+#ifdef WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/time.h>
+#endif
+
+namespace ITMLib
+{
+	namespace Utils
+	{
+		/** Wall clock timer for measuring the time spent in parts of
+		    the library, without depending on the application's timers.
+		    Uses the same clocks as the application's StopWatch:
+		    QueryPerformanceCounter on Windows, gettimeofday elsewhere.
+		*/
+		class ITMTimer
+		{
+		private:
+#ifdef WIN32
+			LARGE_INTEGER startTime, frequency;
+#else
+			struct timeval startTime;
+#endif
+
+		public:
+			/// Starts measuring from now
+			void Start(void)
+			{
+#ifdef WIN32
+				QueryPerformanceCounter(&startTime);
+#else
+				gettimeofday(&startTime, 0);
+#endif
+			}
+
+			/// Time since the last call to Start() in milliseconds
+			float GetElapsedMilliseconds(void) const
+			{
+#ifdef WIN32
+				LARGE_INTEGER currentTime;
+				QueryPerformanceCounter(&currentTime);
+				return (float)((double)(currentTime.QuadPart - startTime.QuadPart) * 1000.0 / (double)frequency.QuadPart);
+#else
+				struct timeval currentTime;
+				gettimeofday(&currentTime, 0);
+				return (float)((double)(currentTime.tv_sec - startTime.tv_sec) * 1000.0 + (double)(currentTime.tv_usec - startTime.tv_usec) / 1000.0);
+#endif
+			}
+
+			ITMTimer(void)
+			{
+#ifdef WIN32
+				QueryPerformanceFrequency(&frequency);
+#endif
+				Start();
+			}
+		};
+	}
+}